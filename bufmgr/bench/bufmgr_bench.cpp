@@ -0,0 +1,368 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Drives the buffer manager with a synthetic page reference stream and
+ * reports throughput, hit ratio, per-operation latency percentiles and disk
+ * I/O counts.  Every run is seeded, so two runs with the same options issue
+ * the same references; only the interleaving of threads varies.
+ *
+ * Each operation is either a point access to one page, chosen from a Zipfian
+ * distribution over all pages of all files (theta = 0 is uniform), or a scan
+ * of consecutive pages of one file.  Point accesses dirty the page with the
+ * given probability.  The page ranks of the Zipfian distribution are shuffled
+ * so hot pages are spread over the files.
+ *
+ * Threads share one pool and call it directly; the buffer manager does its
+ * own latching.  Pinning a fraction of the pool for the whole run shows how
+ * the clock sweep copes when most frames cannot be evicted; the sweep rows
+ * give the mean and longest number of frames one sweep examined.  A background
+ * checkpoint shows what writing dirty pages back at a limited rate costs the
+ * foreground latencies and how many dirty evictions it saves.
+ *
+ * Usage: bufmgr_bench [--option=value ...]
+ *   --workload=NAME  preset: uniform, zipf, scan or mixed (default zipf)
+ *   --frames=N       frames in the pool (default 512)
+ *   --files=N        number of files (default 2)
+ *   --pages=N        pages per file (default 2048)
+ *   --theta=X        Zipfian skew, 0 for uniform
+ *   --write=X        fraction of point accesses that dirty the page
+ *   --scan=X         fraction of operations that are scans
+ *   --scan-length=N  pages per scan (default 64)
+ *   --pinned=X       fraction of frames kept pinned during the run (default 0)
+ *   --checkpoint=N   run a background fuzzy checkpoint every 100 ms, writing at
+ *                    most N dirty pages per second (default 0, off)
+ *   --threads=N      threads issuing operations (default 1)
+ *   --ops=N          operations per thread (default 200000; 5000 for scan and
+ *                    50000 for mixed)
+ *   --seed=N         random seed (default 42)
+ *   --trace=FILE     record a page access trace for bench/trace_replay
+ *   --stats=FILE     write the buffer manager's statistics to FILE as JSON
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+struct Options
+{
+	std::string workload;
+	std::uint32_t frames;
+	std::uint32_t files;
+	std::uint32_t pages;
+	double theta;
+	double write;
+	double scan;
+	std::uint32_t scanLength;
+	double pinned;
+	double checkpoint;
+	std::uint32_t threads;
+	std::uint64_t ops;
+	std::uint64_t seed;
+	std::string trace;
+	std::string stats;
+};
+
+static void usage()
+{
+	std::cerr << "usage: bufmgr_bench [--workload=uniform|zipf|scan|mixed] [--frames=N] [--files=N]\n"
+	          << "                    [--pages=N] [--theta=X] [--write=X] [--scan=X] [--scan-length=N]\n"
+	          << "                    [--pinned=X] [--checkpoint=N] [--threads=N] [--ops=N] [--seed=N]\n"
+	          << "                    [--trace=FILE] [--stats=FILE]\n";
+	exit(1);
+}
+
+static Options parseOptions(int argc, char* argv[])
+{
+	Options options;
+	options.workload = "zipf";
+	options.frames = 512;
+	options.files = 2;
+	options.pages = 2048;
+	options.scanLength = 64;
+	options.pinned = 0;
+	options.checkpoint = 0;
+	options.threads = 1;
+	options.ops = 200000;
+	options.seed = 42;
+
+	// The preset is applied first so individual options can override it.
+	for (int i = 1; i < argc; i++)
+		if (strncmp(argv[i], "--workload=", 11) == 0)
+			options.workload = argv[i] + 11;
+	if (options.workload == "uniform")
+	{
+		options.theta = 0; options.write = 0.1; options.scan = 0;
+	}
+	else if (options.workload == "zipf")
+	{
+		options.theta = 0.99; options.write = 0.1; options.scan = 0;
+	}
+	else if (options.workload == "scan")
+	{
+		options.theta = 0; options.write = 0; options.scan = 1; options.ops = 5000;
+	}
+	else if (options.workload == "mixed")
+	{
+		options.theta = 0.9; options.write = 0.2; options.scan = 0.02; options.ops = 50000;
+	}
+	else
+		usage();
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = strchr(arg, '=');
+		if (strncmp(arg, "--", 2) != 0 || value == NULL)
+			usage();
+		const std::string name(arg + 2, value - arg - 2);
+		value++;
+		if (name == "workload") continue;
+		else if (name == "frames") options.frames = atoi(value);
+		else if (name == "files") options.files = atoi(value);
+		else if (name == "pages") options.pages = atoi(value);
+		else if (name == "theta") options.theta = atof(value);
+		else if (name == "write") options.write = atof(value);
+		else if (name == "scan") options.scan = atof(value);
+		else if (name == "scan-length") options.scanLength = atoi(value);
+		else if (name == "pinned") options.pinned = atof(value);
+		else if (name == "checkpoint") options.checkpoint = atof(value);
+		else if (name == "threads") options.threads = atoi(value);
+		else if (name == "ops") options.ops = strtoull(value, NULL, 10);
+		else if (name == "seed") options.seed = strtoull(value, NULL, 10);
+		else if (name == "trace") options.trace = value;
+		else if (name == "stats") options.stats = value;
+		else usage();
+	}
+	if (options.frames == 0 || options.files == 0 || options.pages == 0 ||
+	    options.threads == 0 || options.scanLength == 0 || options.theta < 0 || options.theta == 1 ||
+	    options.pinned < 0 || options.pinned >= 1 || options.checkpoint < 0)
+		usage();
+	return options;
+}
+
+/*
+ * Zipfian generator over [0, n) after Gray et al., "Quickly Generating
+ * Billion-Record Synthetic Databases".  Rank 0 is the most popular.
+ */
+class ZipfianGenerator
+{
+ public:
+	ZipfianGenerator(const std::uint64_t n, const double theta)
+		: n_(n), theta_(theta)
+	{
+		double zetan = 0;
+		for (std::uint64_t i = 1; i <= n; i++)
+			zetan += 1.0 / std::pow((double) i, theta);
+		const double zeta2 = 1.0 + 1.0 / std::pow(2.0, theta);
+		alpha_ = 1.0 / (1.0 - theta);
+		zetan_ = zetan;
+		eta_ = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+	}
+
+	template <typename Rng>
+	std::uint64_t next(Rng& rng) const
+	{
+		if (theta_ == 0)
+			return std::uniform_int_distribution<std::uint64_t>(0, n_ - 1)(rng);
+		const double u = std::uniform_real_distribution<double>(0, 1)(rng);
+		const double uz = u * zetan_;
+		if (uz < 1.0)
+			return 0;
+		if (uz < 1.0 + std::pow(0.5, theta_))
+			return 1;
+		const std::uint64_t rank = (std::uint64_t) (n_ * std::pow(eta_ * u - eta_ + 1, alpha_));
+		return rank < n_ ? rank : n_ - 1;
+	}
+
+ private:
+	std::uint64_t n_;
+	double theta_;
+	double alpha_;
+	double zetan_;
+	double eta_;
+};
+
+struct ThreadResult
+{
+	std::vector<std::uint32_t> latencies;
+	std::uint64_t pageAccesses;
+};
+
+int main(int argc, char* argv[])
+{
+	const Options options = parseOptions(argc, argv);
+	const std::uint64_t totalPages = (std::uint64_t) options.files * options.pages;
+
+	std::vector<File> files;
+	for (std::uint32_t f = 0; f < options.files; f++)
+	{
+		char name[64];
+		sprintf(name, "bufmgr_bench.%u.db", f);
+		try
+		{
+			File::remove(name);
+		}
+		catch(FileNotFoundException&)
+		{
+		}
+		files.push_back(File::create(name));
+		for (std::uint32_t p = 0; p < options.pages; p++)
+		{
+			Page page = files.back().allocatePage();
+			page.insertRecord(std::string(64, 'a' + p % 26));
+			files.back().writePage(page);
+		}
+	}
+
+	// Rank r of the Zipfian distribution is page permutation[r].
+	std::vector<std::uint32_t> permutation(totalPages);
+	for (std::uint64_t i = 0; i < totalPages; i++)
+		permutation[i] = (std::uint32_t) i;
+	std::mt19937_64 shuffleRng(options.seed);
+	std::shuffle(permutation.begin(), permutation.end(), shuffleRng);
+	const ZipfianGenerator zipf(totalPages, options.theta);
+
+	BufMgr* bufMgr = new BufMgr(options.frames);
+	if (!options.trace.empty())
+		bufMgr->startTrace(options.trace);
+	// Pin the first pages of the first file, spread over files if it is too short.
+	std::vector<PageHandle> pins;
+	const std::uint32_t pinCount = (std::uint32_t) (options.frames * options.pinned);
+	for (std::uint32_t i = 0; i < pinCount && i < totalPages; i++)
+		pins.push_back(bufMgr->readPage(&files[i / options.pages], 1 + i % options.pages));
+	std::vector<ThreadResult> results(options.threads);
+
+	Clock::time_point start = Clock::now();
+	if (options.checkpoint > 0)
+		bufMgr->startCheckpointer(options.checkpoint, std::chrono::milliseconds(100));
+	std::vector<std::thread> threads;
+	for (std::uint32_t t = 0; t < options.threads; t++)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			std::seed_seq seed = {(std::uint32_t) options.seed, (std::uint32_t) (options.seed >> 32), t};
+			std::mt19937_64 rng(seed);
+			std::uniform_real_distribution<double> coin(0, 1);
+			ThreadResult& result = results[t];
+			result.latencies.reserve(options.ops);
+			result.pageAccesses = 0;
+			for (std::uint64_t op = 0; op < options.ops; op++)
+			{
+				const bool isScan = coin(rng) < options.scan;
+				std::uint32_t file;
+				PageId first;
+				std::uint32_t length;
+				bool dirty;
+				if (isScan)
+				{
+					file = rng() % options.files;
+					first = 1 + rng() % options.pages;
+					length = std::min(options.scanLength, options.pages - first + 1);
+					dirty = false;
+				}
+				else
+				{
+					const std::uint32_t page = permutation[zipf.next(rng)];
+					file = page / options.pages;
+					first = 1 + page % options.pages;
+					length = 1;
+					dirty = coin(rng) < options.write;
+				}
+
+				Clock::time_point opStart = Clock::now();
+				for (PageId pageNo = first; pageNo < first + length; pageNo++)
+				{
+					Page* page;
+					bufMgr->readPage(&files[file], pageNo, page);
+					bufMgr->unPinPage(&files[file], pageNo, dirty);
+				}
+				result.latencies.push_back((std::uint32_t) std::min(elapsedNs(opStart), 4e9));
+				result.pageAccesses += length;
+			}
+		}));
+	}
+	for (std::size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	const double ns = elapsedNs(start);
+	bufMgr->stopCheckpointer();
+	pins.clear();
+
+	std::vector<std::uint32_t> latencies;
+	std::uint64_t pageAccesses = 0;
+	for (std::size_t t = 0; t < results.size(); t++)
+	{
+		latencies.insert(latencies.end(), results[t].latencies.begin(), results[t].latencies.end());
+		pageAccesses += results[t].pageAccesses;
+	}
+	std::sort(latencies.begin(), latencies.end());
+	const BufStats stats = bufMgr->getBufStats();
+	const std::uint64_t ops = latencies.size();
+
+	std::printf("workload=%s frames=%u files=%u pages=%u theta=%.2f write=%.2f scan=%.2f scan-length=%u pinned=%.2f checkpoint=%.0f threads=%u ops=%llu seed=%llu\n",
+	            options.workload.c_str(), options.frames, options.files, options.pages, options.theta,
+	            options.write, options.scan, options.scanLength, options.pinned, options.checkpoint, options.threads,
+	            (unsigned long long) options.ops, (unsigned long long) options.seed);
+	std::printf("%-16s %14.0f\n", "ops/s", ops / ns * 1e9);
+	std::printf("%-16s %14.0f\n", "pages/s", pageAccesses / ns * 1e9);
+	std::printf("%-16s %14.4f\n", "hit ratio", 1.0 - (double) stats.diskreads / pageAccesses);
+	std::printf("%-16s %14u\n", "p50 ns", latencies[ops / 2]);
+	std::printf("%-16s %14u\n", "p99 ns", latencies[ops * 99 / 100]);
+	std::printf("%-16s %14u\n", "p999 ns", latencies[ops * 999 / 1000]);
+	std::printf("%-16s %14llu\n", "page accesses", (unsigned long long) pageAccesses);
+	std::printf("%-16s %14llu\n", "disk reads", (unsigned long long) stats.diskreads);
+	std::printf("%-16s %14llu\n", "disk writes", (unsigned long long) stats.diskwrites);
+	std::printf("%-16s %14llu\n", "evictions", (unsigned long long) stats.evictions);
+	std::printf("%-16s %14llu\n", "dirty evictions", (unsigned long long) stats.dirtyEvictions);
+	std::printf("%-16s %14.2f\n", "sweep/eviction",
+	            stats.evictions == 0 ? 0.0 : (double) stats.sweepSteps / stats.evictions);
+	std::printf("%-16s %14llu\n", "sweeps", (unsigned long long) stats.sweeps);
+	std::printf("%-16s %14.1f\n", "sweep mean", stats.sweepLength.mean());
+	std::printf("%-16s %14llu\n", "sweep max", (unsigned long long) stats.sweepLength.max());
+	std::printf("%-16s %14llu\n", "checkpoint wr", (unsigned long long) stats.checkpointWrites);
+	for (std::size_t w = 0; w < stats.workingSet.size(); w++)
+	{
+		char label[32];
+		sprintf(label, "ws %llu", (unsigned long long) stats.workingSet[w].window);
+		std::printf("%-16s %14.0f\n", label, stats.workingSet[w].pages);
+	}
+	if (!options.stats.empty())
+	{
+		std::ofstream out(options.stats.c_str());
+		stats.dump(out);
+	}
+
+	delete bufMgr;
+	std::vector<std::string> names;
+	for (std::uint32_t f = 0; f < options.files; f++)
+		names.push_back(files[f].filename());
+	files.clear();
+	for (std::size_t f = 0; f < names.size(); f++)
+		File::remove(names[f]);
+	return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures the cost of page checksums: raw CRC32C speed over one 8 KB page
+ * with the crc32 instruction and with the portable tables, and the cost of
+ * File::readPage with each checksum mode on a file that fits in the OS cache.
+ *
+ * Usage: checksum_bench [pages] [rounds]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "checksum.h"
+#include "file.h"
+#include "page.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+typedef std::uint32_t (*Crc32cFunction)(const void*, const std::size_t, const std::uint32_t);
+
+static double crcNsPerPage(Crc32cFunction crc, const std::string& page, const int iterations)
+{
+	std::uint32_t sink = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < iterations; i++)
+		sink ^= crc(page.data(), page.size(), sink);
+	const double ns = elapsedNs(start) / iterations;
+	if (sink == 0x12345678)
+		std::cout << "";
+	return ns;
+}
+
+static double readNsPerPage(File& file, const ChecksumMode mode, const PageId pages, const int rounds)
+{
+	file.setChecksumMode(mode);
+	std::size_t records = 0;
+	Clock::time_point start = Clock::now();
+	for (int round = 0; round < rounds; round++)
+	{
+		for (PageId pageNo = 1; pageNo <= pages; pageNo++)
+		{
+			Page page = file.readPage(pageNo);
+			records += page.getRecord({pageNo, 1}).size();
+		}
+	}
+	const double ns = elapsedNs(start) / ((double) pages * rounds);
+	if (records == 0)
+		exit(1);
+	return ns;
+}
+
+int main(int argc, char* argv[])
+{
+	const PageId pages = argc > 1 ? atoi(argv[1]) : 256;
+	const int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+	std::string page(Page::SIZE, '\0');
+	std::mt19937 rng(42);
+	for (std::size_t i = 0; i < page.size(); i++)
+		page[i] = (char) rng();
+
+	if (crc32c(page.data(), page.size()) != crc32cPortable(page.data(), page.size()))
+	{
+		std::cerr << "hardware and portable CRC32C disagree\n";
+		exit(1);
+	}
+
+	std::printf("CRC32C over one %zu byte page\n", Page::SIZE);
+	std::printf("%-12s %12s %10s\n", "impl", "ns/page", "GB/s");
+	const double portableNs = crcNsPerPage(crc32cPortable, page, 20000);
+	std::printf("%-12s %12.0f %10.2f\n", "portable", portableNs, page.size() / portableNs);
+	if (crc32cHardwareAvailable())
+	{
+		const double hardwareNs = crcNsPerPage(crc32c, page, 200000);
+		std::printf("%-12s %12.0f %10.2f\n", "sse4.2", hardwareNs, page.size() / hardwareNs);
+	}
+	else
+	{
+		std::printf("%-12s %12s\n", "sse4.2", "n/a");
+	}
+
+	const std::string filename = "checksum_bench.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+	{
+		File file = File::create(filename);
+		const std::string record(Page::DATA_SIZE / 2, 'c');
+		for (PageId i = 0; i < pages; i++)
+		{
+			Page newPage = file.allocatePage();
+			newPage.insertRecord(record);
+			file.writePage(newPage);
+		}
+	}
+
+	std::printf("\nFile::readPage + getRecord, %u pages x %d rounds\n", pages, rounds);
+	std::printf("%-12s %12s %12s\n", "mode", "ns/page", "overhead");
+	{
+		File file = File::open(filename);
+		// Warm the OS cache before timing.
+		readNsPerPage(file, CHECKSUM_VERIFY_NEVER, pages, 1);
+		const double neverNs = readNsPerPage(file, CHECKSUM_VERIFY_NEVER, pages, rounds);
+		const double eagerNs = readNsPerPage(file, CHECKSUM_VERIFY_ON_READ, pages, rounds);
+		const double lazyNs = readNsPerPage(file, CHECKSUM_VERIFY_LAZILY, pages, rounds);
+		std::printf("%-12s %12.0f %12s\n", "never", neverNs, "-");
+		std::printf("%-12s %12.0f %12.0f\n", "on read", eagerNs, eagerNs - neverNs);
+		std::printf("%-12s %12.0f %12.0f\n", "lazily", lazyNs, lazyNs - neverNs);
+	}
+	File::remove(filename);
+
+	return 0;
+}
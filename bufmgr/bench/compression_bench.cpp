@@ -0,0 +1,183 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Compares the plain and compressed file formats on a text dataset: disk
+ * footprint, and scan throughput through a buffer pool holding a tenth of the
+ * file, with and without the compressed page cache.  Files are read through
+ * the OS page cache, so the plain format's reads are memory copies and the
+ * compressed numbers show the CPU cost of decompression.
+ *
+ * Usage: compression_bench [data MB] [scans]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer.h"
+#include "page_iterator.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+/*
+ * Builds a pipe-separated order record with a free-text comment, in the style
+ * of the TPC-H orders table.
+ */
+static std::string makeRecord(std::mt19937& rng, const int key)
+{
+	static const char* words[] = {
+		"furiously", "carefully", "quickly", "blithely", "regular", "express",
+		"final", "pending", "special", "ironic", "deposits", "requests",
+		"packages", "accounts", "instructions", "theodolites", "sleep", "wake",
+		"haggle", "nag", "boost", "among", "above", "the"};
+	static const char* priorities[] = {"1-URGENT", "2-HIGH", "3-MEDIUM", "4-NOT SPECIFIED", "5-LOW"};
+	char fields[128];
+	sprintf(fields, "%d|Customer#%09u|%c|%u.%02u|199%u-%02u-%02u|%s|Clerk#%09u|0|",
+	        key, (unsigned) (rng() % 150000), "OFP"[rng() % 3],
+	        (unsigned) (rng() % 500000), (unsigned) (rng() % 100),
+	        (unsigned) (2 + rng() % 7), (unsigned) (1 + rng() % 12), (unsigned) (1 + rng() % 28),
+	        priorities[rng() % 5], (unsigned) (rng() % 1000));
+	std::string record(fields);
+	const int numWords = 4 + rng() % 8;
+	for (int i = 0; i < numWords; i++)
+	{
+		if (i > 0)
+			record += ' ';
+		record += words[rng() % (sizeof(words) / sizeof(words[0]))];
+	}
+	return record;
+}
+
+static std::uint32_t load(const std::string& filename, const FileFormat format, const std::size_t dataBytes)
+{
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+	File file = File::create(filename, format);
+	std::mt19937 rng(42);
+	std::uint32_t numPages = 1;
+	Page page = file.allocatePage();
+	std::size_t loaded = 0;
+	for (int key = 1; loaded < dataBytes; key++)
+	{
+		const std::string record = makeRecord(rng, key);
+		if (!page.hasSpaceForRecord(record))
+		{
+			file.writePage(page);
+			page = file.allocatePage();
+			numPages++;
+		}
+		page.insertRecord(record);
+		loaded += record.size();
+	}
+	file.writePage(page);
+	return numPages;
+}
+
+static std::size_t fileSize(const std::string& filename)
+{
+	std::ifstream file(filename, std::ifstream::binary | std::ifstream::ate);
+	return file.tellg();
+}
+
+/*
+ * Scans every record of the file through a buffer pool and returns the
+ * nanoseconds per scan.
+ */
+static double scan(File& file, const std::uint32_t numPages, const int scans, std::size_t& bytes)
+{
+	BufMgr bufMgr(numPages / 10 > 0 ? numPages / 10 : 1);
+	bytes = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < scans; i++)
+	{
+		for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+		{
+			Page* page;
+			bufMgr.readPage(&file, pageNo, page);
+			for (PageIterator iter = page->begin(); iter != page->end(); ++iter)
+				bytes += (*iter).size();
+			bufMgr.unPinPage(&file, pageNo, false);
+		}
+	}
+	return elapsedNs(start) / scans;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t dataMb = argc > 1 ? atoi(argv[1]) : 4;
+	const int scans = argc > 2 ? atoi(argv[2]) : 5;
+	const std::string plainName = "compression_bench_plain.db";
+	const std::string compressedName = "compression_bench_compressed.db";
+
+	const std::uint32_t numPages = load(plainName, FILE_FORMAT_PLAIN, dataMb * 1024 * 1024);
+	if (load(compressedName, FILE_FORMAT_COMPRESSED, dataMb * 1024 * 1024) != numPages)
+		exit(1);
+
+	const std::size_t plainSize = fileSize(plainName);
+	const std::size_t compressedSize = fileSize(compressedName);
+	std::printf("%u pages of %zu bytes, %zu MB of records\n\n", numPages, Page::SIZE, dataMb);
+	std::printf("%-26s %12s %8s\n", "format", "bytes", "ratio");
+	std::printf("%-26s %12zu %8.2f\n", "plain", plainSize, 1.0);
+	std::printf("%-26s %12zu %8.2f\n", "compressed", compressedSize, (double) plainSize / compressedSize);
+
+	std::printf("\nscan through a pool of %u frames, %d scans\n", numPages / 10 > 0 ? numPages / 10 : 1, scans);
+	std::printf("%-26s %12s %12s %10s\n", "format", "ms/scan", "MB/s", "cache hit");
+	std::size_t expectedBytes;
+	{
+		File file = File::open(plainName);
+		scan(file, numPages, 1, expectedBytes);
+		std::size_t bytes;
+		const double ns = scan(file, numPages, scans, bytes);
+		std::printf("%-26s %12.2f %12.1f %10s\n", "plain", ns / 1e6,
+		            (double) numPages * Page::SIZE / ns * 1e3, "-");
+	}
+	const std::size_t cacheSizes[] = {0, compressedSize};
+	for (int c = 0; c < 2; c++)
+	{
+		File file = File::open(compressedName);
+		file.setCompressedCacheSize(cacheSizes[c]);
+		std::size_t bytes;
+		scan(file, numPages, 1, bytes);
+		const CompressedCacheStats before = file.compressedCacheStats();
+		const double ns = scan(file, numPages, scans, bytes);
+		if (bytes != expectedBytes * scans)
+		{
+			std::cerr << "compressed scan read " << bytes << " bytes, expected " << expectedBytes * scans << "\n";
+			exit(1);
+		}
+		const CompressedCacheStats after = file.compressedCacheStats();
+		const double lookups = (double) (after.hits - before.hits) + (after.misses - before.misses);
+		char label[64];
+		sprintf(label, "compressed, cache %zu KB", cacheSizes[c] / 1024);
+		std::printf("%-26s %12.2f %12.1f %9.0f%%\n", label, ns / 1e6,
+		            (double) numPages * Page::SIZE / ns * 1e3,
+		            lookups > 0 ? 100.0 * (after.hits - before.hits) / lookups : 0.0);
+	}
+
+	File::remove(plainName);
+	File::remove(compressedName);
+	return 0;
+}
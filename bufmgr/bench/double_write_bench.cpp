@@ -0,0 +1,159 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures the cost of writing pages through a double-write buffer.  Two
+ * workloads write dirty pages back to a file:
+ *
+ *   flush   <pages> pages are changed and written with flushFile().
+ *   evict   random pages of a file four times the pool are changed, so
+ *           dirty pages are written as they are evicted.
+ *
+ * Each runs with pages written directly, directly followed by one sync of the
+ * file (the durability the double-write buffer gives, without the torn-page
+ * protection), and through double-write buffers of several capacities.
+ *
+ * Usage: double_write_bench [pages]   (default 4096)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "buffer.h"
+#include "double_write_buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static const std::string fileName = "double_write_bench.db";
+static const std::string dwbName = "double_write_bench.dwb";
+
+static void syncFile()
+{
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0 || fdatasync(fd) != 0)
+	{
+		std::cerr << "cannot sync " << fileName << "\n";
+		exit(1);
+	}
+	close(fd);
+}
+
+struct Result
+{
+	double flushRate;
+	double evictRate;
+	std::uint64_t written;
+	std::uint64_t batches;
+};
+
+//pages/s of flushFile and of the eviction workload; capacity 0 writes directly
+static Result measure(File& file, const PageId pages, const std::uint32_t capacity, const bool sync)
+{
+	Result result;
+	std::vector<PageId> pageNos(pages);
+	{
+		BufMgr pool(pages);
+		for (PageId p = 0; p < pages; p++)
+			pool.allocPage(&file, pageNos[p]);
+		pool.flushFile(&file);
+	}
+	syncFile();
+
+	DoubleWriteBuffer dwb(dwbName, capacity > 0 ? capacity : 1);
+	{
+		BufMgr pool(pages);
+		if (capacity > 0)
+			pool.setDoubleWrite(&dwb);
+		for (PageId p = 0; p < pages; p++)
+		{
+			PageHandle handle = pool.readPage(&file, pageNos[p]);
+			handle->insertRecord("flushed");
+			handle.markDirty();
+		}
+		const Clock::time_point start = Clock::now();
+		pool.flushFile(&file);
+		if (sync)
+			syncFile();
+		result.flushRate = pages / (elapsedNs(start) / 1e9);
+	}
+
+	{
+		BufMgr pool(pages / 4);
+		if (capacity > 0)
+			pool.setDoubleWrite(&dwb);
+		std::mt19937 rng(7);
+		const Clock::time_point start = Clock::now();
+		for (PageId u = 0; u < pages; u++)
+		{
+			PageHandle handle = pool.readPage(&file, pageNos[rng() % pages]);
+			handle->insertRecord("evicted");
+			handle.markDirty();
+		}
+		pool.flushFile(&file);
+		if (sync)
+			syncFile();
+		result.written = pool.getBufStats().diskwrites;
+		result.evictRate = result.written / (elapsedNs(start) / 1e9);
+	}
+	result.batches = dwb.numBatches();
+	return result;
+}
+
+static void run(const char* mode, const PageId pages, const std::uint32_t capacity, const bool sync)
+{
+	try
+	{
+		File::remove(fileName);
+	}
+	catch (FileNotFoundException&)
+	{
+	}
+	std::remove(dwbName.c_str());
+
+	Result result;
+	{
+		File file = File::create(fileName);
+		result = measure(file, pages, capacity, sync);
+	}
+	printf("%-16s %14.0f %14.0f %10lu %10lu\n", mode, result.flushRate, result.evictRate,
+	       (unsigned long) result.written, (unsigned long) result.batches);
+	File::remove(fileName);
+	std::remove(dwbName.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+	const PageId pages = argc > 1 ? atoi(argv[1]) : 4096;
+
+	printf("%u pages\n", pages);
+	printf("%-16s %14s %14s %10s %10s\n", "mode", "flush pages/s", "evict pages/s", "written", "batches");
+	run("direct", pages, 0, false);
+	run("direct + sync", pages, 0, true);
+	const std::uint32_t capacities[] = {8, 32, 64, 128};
+	for (std::uint32_t capacity : capacities)
+	{
+		char mode[32];
+		snprintf(mode, sizeof(mode), "double-write %u", capacity);
+		run(mode, pages, capacity, false);
+	}
+	return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Compares slotted pages with fixed-length record pages for small rows:
+ * records per page and the cost of scanning every record of a set of
+ * in-memory pages.
+ *
+ * Usage: fixed_page_bench [pages]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "fixed_record_page.h"
+#include "page.h"
+#include "page_iterator.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+template <std::size_t RecordSize>
+static void runBench(const int numPages)
+{
+	typedef FixedRecordPage<RecordSize> FixedPage;
+
+	std::string record(RecordSize, '\0');
+	std::vector<Page> slotted(numPages);
+	std::vector<Page> fixed(numPages);
+	std::size_t slottedRecords = 0;
+	std::size_t fixedRecords = 0;
+	for (int i = 0; i < numPages; i++)
+	{
+		std::uint64_t key = 0;
+		while (slotted[i].hasSpaceForRecord(record))
+		{
+			memcpy(&record[0], &key, sizeof(key) < RecordSize ? sizeof(key) : RecordSize);
+			slotted[i].insertRecord(record);
+			slottedRecords++;
+			key++;
+		}
+		FixedPage page = FixedPage::format(&fixed[i]);
+		key = 0;
+		while (!page.isFull())
+		{
+			memcpy(&record[0], &key, sizeof(key) < RecordSize ? sizeof(key) : RecordSize);
+			page.insertRecord(record);
+			fixedRecords++;
+			key++;
+		}
+	}
+
+	// Both scans add up the first byte of every record.
+	std::uint64_t slottedSum = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < numPages; i++)
+	{
+		for (PageIterator iter = slotted[i].begin(); iter != slotted[i].end(); ++iter)
+			slottedSum += (unsigned char) (*iter)[0];
+	}
+	const double slottedNs = elapsedNs(start);
+
+	std::uint64_t fixedSum = 0;
+	start = Clock::now();
+	for (int i = 0; i < numPages; i++)
+	{
+		FixedPage page(&fixed[i]);
+		for (SlotId slot = page.getNextUsedSlot(Page::INVALID_SLOT);
+		     slot != Page::INVALID_SLOT;
+		     slot = page.getNextUsedSlot(slot))
+		{
+			const RecordId rid = {page.page_number(), slot};
+			fixedSum += (unsigned char) page.getRecordData(rid)[0];
+		}
+	}
+	const double fixedNs = elapsedNs(start);
+
+	if (slottedSum == 0 || fixedSum == 0)
+		exit(1);
+	printf("%7zu %12zu %12zu %8.2f %14.2f %14.2f\n", RecordSize,
+	       slottedRecords / numPages, fixedRecords / numPages,
+	       (double) fixedRecords / slottedRecords,
+	       slottedNs / slottedRecords, fixedNs / fixedRecords);
+}
+
+int main(int argc, char* argv[])
+{
+	const int numPages = argc > 1 ? atoi(argv[1]) : 2000;
+
+	printf("%7s %12s %12s %8s %14s %14s\n", "record", "slotted/page",
+	       "fixed/page", "density", "slotted ns/rec", "fixed ns/rec");
+	runBench<4>(numPages);
+	runBench<8>(numPages);
+	runBench<16>(numPages);
+	runBench<32>(numPages);
+	runBench<64>(numPages);
+	return 0;
+}
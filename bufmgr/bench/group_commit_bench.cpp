@@ -0,0 +1,97 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures group commit in the write-ahead log.  Each thread commits in a
+ * loop: it appends a small record and flushes the log up to that record, as a
+ * transaction does at commit.  Flushes that wait while another thread syncs
+ * the log are covered by the next sync, so with more threads the syncs per
+ * second should stay near what the device sustains while commits per second
+ * grow.  A group commit delay makes each sync wait for more commits, trading
+ * commit latency for fewer syncs.
+ *
+ * Usage: group_commit_bench [seconds] [delay-us]   (default 0.5 0)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "write_ahead_log.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	const double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+	const int delayUs = argc > 2 ? atoi(argv[2]) : 0;
+	const int threadCounts[] = {1, 2, 4, 8, 16, 32, 64};
+
+	const std::string logName = "group_commit_bench.wal";
+
+	printf("group commit delay %d us\n", delayUs);
+	printf("%8s %12s %12s %12s %12s\n", "threads", "commits/s", "syncs/s", "commits/sync", "us/commit");
+	for (int threads : threadCounts)
+	{
+		std::remove(logName.c_str());
+		WriteAheadLog log(logName);
+		log.setGroupCommitDelay(std::chrono::microseconds(delayUs));
+
+		std::atomic<bool> stop(false);
+		std::atomic<std::uint64_t> commits(0);
+		std::atomic<std::uint64_t> commitNs(0);
+		std::vector<std::thread> workers;
+		const Clock::time_point start = Clock::now();
+		for (int t = 0; t < threads; t++)
+		{
+			workers.push_back(std::thread([&log, &stop, &commits, &commitNs, t]()
+			{
+				const std::string payload(100, (char) ('a' + t % 26));
+				std::uint64_t done = 0;
+				double ns = 0;
+				while (!stop.load())
+				{
+					const Clock::time_point begin = Clock::now();
+					log.flush(log.append(LOG_PAGE_IMAGE, payload));
+					ns += elapsedNs(begin);
+					done++;
+				}
+				commits += done;
+				commitNs += (std::uint64_t) ns;
+			}));
+		}
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+		stop = true;
+		for (std::size_t t = 0; t < workers.size(); t++)
+			workers[t].join();
+		const double elapsed = elapsedNs(start) / 1e9;
+
+		if (log.durableLsn() != log.endLsn() || log.numRecords() != commits.load())
+		{
+			std::cerr << "commits were lost or not made durable\n";
+			exit(1);
+		}
+		const double syncs = log.numSyncs();
+		printf("%8d %12.0f %12.0f %12.1f %12.1f\n", threads, commits / elapsed, syncs / elapsed,
+		       commits / syncs, commitNs / 1e3 / commits);
+	}
+
+	std::remove(logName.c_str());
+	return 0;
+}
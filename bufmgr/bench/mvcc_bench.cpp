@@ -0,0 +1,250 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures scans running alongside updates.  Scanner threads read every page
+ * of a file, over and over; updater threads add one to the counter held by a
+ * random page.  Every page fits in the pool.  Each scan checks that the
+ * counters it read add up to a state the file was really in.
+ *
+ *   locked     scans hold a shared lock for the whole scan and updates an
+ *              exclusive one, so a scan sees no update in progress.
+ *   snapshot   scans read through a snapshot and updates go through
+ *              updatePage, so neither waits for the other; an update of a
+ *              page a scan may still read keeps its old image.
+ *
+ * Usage: mvcc_bench [pages] [seconds]   (default 1024 1)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+//readers-writer lock for the locked mode; writers wait for readers to drain, and new readers for
+//waiting writers
+class ScanLock
+{
+ public:
+	ScanLock() : readers(0), writing(false), writersWaiting(0) {}
+
+	void lockShared()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		changed.wait(lock, [this]() { return !writing && writersWaiting == 0; });
+		readers++;
+	}
+
+	void unlockShared()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--readers == 0)
+			changed.notify_all();
+	}
+
+	void lock()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		writersWaiting++;
+		changed.wait(lock, [this]() { return !writing && readers == 0; });
+		writersWaiting--;
+		writing = true;
+	}
+
+	void unlock()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		writing = false;
+		changed.notify_all();
+	}
+
+ private:
+	std::mutex mutex;
+	std::condition_variable changed;
+	int readers;
+	bool writing;
+	int writersWaiting;
+};
+
+struct Result
+{
+	double scanRate;
+	double updateRate;
+	std::uint64_t versions;
+};
+
+static int counter(const std::string& record)
+{
+	return atoi(record.c_str() + 2);
+}
+
+static Result measure(File& file, const std::vector<PageId>& pages, const std::vector<RecordId>& rids,
+                      const bool snapshots, const int scanners, const int updaters, const double seconds)
+{
+	BufMgr pool(pages.size() + 16);
+	ScanLock scanLock;
+	std::atomic<std::uint64_t> updates(0);
+	std::atomic<std::uint64_t> scans(0);
+	std::atomic<bool> failed(false);
+	std::atomic<bool> done(false);
+	const std::uint64_t base = pool.beginSnapshot().timestamp();
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < updaters; t++)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			std::mt19937 rng(t + 1);
+			char record[16];
+			while (!done)
+			{
+				const std::size_t k = rng() % pages.size();
+				if (snapshots)
+				{
+					PageHandle handle = pool.updatePage(&file, pages[k]);
+					snprintf(record, sizeof(record), "v %010d", counter(handle->getRecord(rids[k])) + 1);
+					handle->updateRecord(rids[k], record);
+					handle.markDirty();
+				}
+				else
+				{
+					scanLock.lock();
+					{
+						PageHandle handle = pool.readPage(&file, pages[k]);
+						snprintf(record, sizeof(record), "v %010d", counter(handle->getRecord(rids[k])) + 1);
+						handle->updateRecord(rids[k], record);
+						handle.markDirty();
+					}
+					updates++;
+					scanLock.unlock();
+					continue;
+				}
+				updates++;
+			}
+		}));
+	}
+	for (int t = 0; t < scanners; t++)
+	{
+		threads.push_back(std::thread([&]()
+		{
+			while (!done)
+			{
+				std::uint64_t sum = 0;
+				std::uint64_t expected;
+				if (snapshots)
+				{
+					Snapshot snapshot = pool.beginSnapshot();
+					for (std::size_t k = 0; k < pages.size(); k++)
+						sum += counter(pool.readPage(&file, pages[k], snapshot)->getRecord(rids[k]));
+					expected = snapshot.timestamp() - base;
+				}
+				else
+				{
+					scanLock.lockShared();
+					for (std::size_t k = 0; k < pages.size(); k++)
+						sum += counter(pool.readPage(&file, pages[k])->getRecord(rids[k]));
+					expected = updates;
+					scanLock.unlockShared();
+				}
+				if (sum != expected)
+					failed = true;
+				scans++;
+			}
+		}));
+	}
+
+	const Clock::time_point start = Clock::now();
+	std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	done = true;
+	for (std::size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	const double elapsed = elapsedNs(start) / 1e9;
+	if (failed)
+	{
+		std::cerr << "a scan saw a state the file was never in\n";
+		exit(1);
+	}
+
+	Result result;
+	result.scanRate = scans / elapsed;
+	result.updateRate = updates / elapsed;
+	result.versions = pool.getBufStats().versionsCreated;
+	// Leave the counters at zero for the next run.
+	for (std::size_t k = 0; k < pages.size(); k++)
+	{
+		PageHandle handle = pool.readPage(&file, pages[k]);
+		handle->updateRecord(rids[k], "v 0000000000");
+		handle.markDirty();
+	}
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 1024;
+	const double seconds = argc > 2 ? atof(argv[2]) : 1;
+
+	const std::string filename = "mvcc_bench.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		std::vector<PageId> pages(numPages);
+		std::vector<RecordId> rids(numPages);
+		{
+			BufMgr pool(numPages);
+			for (std::uint32_t k = 0; k < numPages; k++)
+			{
+				PageHandle handle = pool.allocPage(&file, pages[k]);
+				rids[k] = handle->insertRecord("v 0000000000");
+				handle.markDirty();
+			}
+		}
+
+		printf("%u pages, %.1f s per run\n", numPages, seconds);
+		printf("%-10s %9s %9s %12s %14s %12s\n", "mode", "scanners", "updaters", "scans/s", "updates/s",
+		       "versions");
+		const int mixes[][2] = {{1, 1}, {1, 4}, {4, 1}, {4, 4}};
+		for (const auto& mix : mixes)
+		{
+			for (int snapshots = 0; snapshots < 2; snapshots++)
+			{
+				const Result result = measure(file, pages, rids, snapshots != 0, mix[0], mix[1], seconds);
+				printf("%-10s %9d %9d %12.1f %14.0f %12lu\n", snapshots ? "snapshot" : "locked", mix[0], mix[1],
+				       result.scanRate, result.updateRate, (unsigned long) result.versions);
+			}
+		}
+	}
+
+	File::remove(filename);
+	return 0;
+}
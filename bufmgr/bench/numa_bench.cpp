@@ -0,0 +1,170 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures how many page accesses cross NUMA nodes.  Threads are bound to
+ * the nodes in turn; each reads a record of a random page, nine times in ten
+ * one of the pages that belong to its node (page k belongs to node
+ * k % nodes) and otherwise any page.  The pool holds half the pages, so
+ * misses keep placing pages.
+ *
+ *   single       one partition, as if one thread allocated the whole pool:
+ *                every frame is on node 0.
+ *   partitioned  setNumaTopology: frames interleaved across the nodes, each
+ *                node's pages allocated on it, and misses preferring frames
+ *                of the missing thread's node.
+ *
+ * Local and remote accesses are counted by the pool from the node of the
+ * accessing thread and of the frame it reads.  On a machine with one node
+ * the nodes are simulated: the counts show where pages would be placed, but
+ * no memory is placed and the rates show only the cost of the bookkeeping.
+ *
+ * Usage: numa_bench [nodes] [threads] [pages] [lookups per thread]
+ *        (default 2 8 4096 100000; 0 nodes uses the machine's nodes)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer.h"
+#include "numa_topology.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+//length of the record on each page
+static const std::uint32_t RECORD_LENGTH = 20;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+struct Result
+{
+	double rate;
+	std::uint64_t local;
+	std::uint64_t remote;
+	std::uint64_t misses;
+};
+
+static Result measure(const NumaTopology& topology, File& file, const std::vector<PageId>& pages,
+                      const std::vector<RecordId>& rids, const bool partitioned, const int threads,
+                      const std::uint32_t lookups)
+{
+	const std::uint32_t nodes = topology.numNodes();
+	BufMgr pool(pages.size() / 2);
+	pool.setNumaTopology(&topology, partitioned);
+
+	// Pages of each node, for the lookups that stay on it.
+	std::vector<std::vector<std::size_t> > nodePages(nodes);
+	for (std::size_t k = 0; k < pages.size(); k++)
+		nodePages[k % nodes].push_back(k);
+
+	std::vector<std::thread> workers;
+	std::vector<std::uint64_t> sums(threads, 0);
+	const Clock::time_point start = Clock::now();
+	for (int t = 0; t < threads; t++)
+	{
+		workers.push_back(std::thread([&, t]()
+		{
+			const std::uint32_t node = t % nodes;
+			topology.bindThread(node);
+			std::mt19937 rng(t + 1);
+			std::uint64_t sum = 0;
+			for (std::uint32_t n = 0; n < lookups; n++)
+			{
+				std::size_t k;
+				if (rng() % 10 != 0)
+					k = nodePages[node][rng() % nodePages[node].size()];
+				else
+					k = rng() % pages.size();
+				sum += pool.readPage(&file, pages[k])->getRecord(rids[k]).size();
+			}
+			sums[t] = sum;
+		}));
+	}
+	for (int t = 0; t < threads; t++)
+		workers[t].join();
+
+	for (int t = 0; t < threads; t++)
+	{
+		if (sums[t] != (std::uint64_t) lookups * RECORD_LENGTH)
+		{
+			std::cerr << "a lookup read the wrong record\n";
+			exit(1);
+		}
+	}
+	const BufStats stats = pool.getBufStats();
+	Result result;
+	result.rate = (double) threads * lookups / (elapsedNs(start) / 1e9);
+	result.local = stats.localAccesses;
+	result.remote = stats.remoteAccesses;
+	result.misses = stats.misses;
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::uint32_t numNodes = argc > 1 ? atoi(argv[1]) : 2;
+	const int threads = argc > 2 ? atoi(argv[2]) : 8;
+	const std::uint32_t numPages = argc > 3 ? atoi(argv[3]) : 4096;
+	const std::uint32_t lookups = argc > 4 ? atoi(argv[4]) : 100000;
+
+	const NumaTopology machine;
+	const NumaTopology topology = numNodes == 0 ? machine : NumaTopology::simulated(numNodes);
+
+	const std::string filename = "numa_bench.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		std::vector<PageId> pages(numPages);
+		std::vector<RecordId> rids(numPages);
+		{
+			BufMgr pool(numPages);
+			for (std::uint32_t k = 0; k < numPages; k++)
+			{
+				PageHandle handle = pool.allocPage(&file, pages[k]);
+				// Ten digits hold any page index, so every record is RECORD_LENGTH long.
+				char record[RECORD_LENGTH + 1];
+				snprintf(record, sizeof(record), "numa page %010u", k);
+				rids[k] = handle->insertRecord(record);
+				handle.markDirty();
+			}
+		}
+
+		printf("nodes: %u %s (machine has %u), %d threads, %u pages, %u frames, %u lookups per thread\n",
+		       topology.numNodes(), topology.isSimulated() ? "simulated" : "real", machine.numNodes(), threads,
+		       numPages, numPages / 2, lookups);
+		printf("%-12s %14s %12s %12s %9s %10s\n", "mode", "lookups/s", "local", "remote", "remote%", "misses");
+		for (int partitioned = 0; partitioned < 2; partitioned++)
+		{
+			const Result result = measure(topology, file, pages, rids, partitioned != 0, threads, lookups);
+			printf("%-12s %14.0f %12lu %12lu %8.1f%% %10lu\n", partitioned ? "partitioned" : "single", result.rate,
+			       (unsigned long) result.local, (unsigned long) result.remote,
+			       100.0 * result.remote / (result.local + result.remote), (unsigned long) result.misses);
+		}
+	}
+
+	File::remove(filename);
+	return 0;
+}
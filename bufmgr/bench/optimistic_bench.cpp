@@ -0,0 +1,141 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures read-only lookups on a hot set of pages from 1 to 64 threads.
+ * Every page fits in the pool; each lookup reads one record of a random page.
+ *
+ *   pinned      readPage and a PageHandle: the latch is taken and the pin
+ *               count written, so threads contend for both.
+ *   optimistic  readOptimistic with a frame hint per page per thread: no
+ *               latch and no writes to memory other threads use.
+ *
+ * Scaling needs as many cores as threads; the number the machine has is
+ * printed with the results.
+ *
+ * Usage: optimistic_bench [pages] [lookups per thread]   (default 256 200000)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+//length of the record on each page
+static const std::uint32_t RECORD_LENGTH = 19;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+//lookups/s of <threads> threads each doing <lookups> lookups
+static double measure(BufMgr& pool, File& file, const std::vector<PageId>& pages,
+                      const std::vector<RecordId>& rids, const int threads, const std::uint32_t lookups,
+                      const bool optimistic)
+{
+	std::vector<std::thread> workers;
+	std::vector<std::uint64_t> sums(threads, 0);
+	const Clock::time_point start = Clock::now();
+	for (int t = 0; t < threads; t++)
+	{
+		workers.push_back(std::thread([&, t]()
+		{
+			std::mt19937 rng(t + 1);
+			std::vector<FrameId> hints(pages.size(), 0);
+			std::uint64_t sum = 0;
+			for (std::uint32_t n = 0; n < lookups; n++)
+			{
+				const std::size_t k = rng() % pages.size();
+				if (optimistic)
+				{
+					std::uint32_t length = 0;
+					pool.readOptimistic(&file, pages[k], hints[k], [&rids, &length, k](const Page& page)
+					{
+						length = page.getRecord(rids[k]).size();
+					});
+					sum += length;
+				}
+				else
+					sum += pool.readPage(&file, pages[k])->getRecord(rids[k]).size();
+			}
+			sums[t] = sum;
+		}));
+	}
+	for (int t = 0; t < threads; t++)
+		workers[t].join();
+	const double rate = (double) threads * lookups / (elapsedNs(start) / 1e9);
+
+	for (int t = 0; t < threads; t++)
+	{
+		if (sums[t] != (std::uint64_t) lookups * RECORD_LENGTH)
+		{
+			std::cerr << "a lookup read the wrong record\n";
+			exit(1);
+		}
+	}
+	return rate;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::uint32_t numPages = argc > 1 ? atoi(argv[1]) : 256;
+	const std::uint32_t lookups = argc > 2 ? atoi(argv[2]) : 200000;
+
+	const std::string filename = "optimistic_bench.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		BufMgr pool(numPages);
+		std::vector<PageId> pages(numPages);
+		std::vector<RecordId> rids(numPages);
+		for (std::uint32_t k = 0; k < numPages; k++)
+		{
+			PageHandle handle = pool.allocPage(&file, pages[k]);
+			// Ten digits hold any page index, so every record is RECORD_LENGTH long.
+			char record[RECORD_LENGTH + 1];
+			snprintf(record, sizeof(record), "hot page %010u", k);
+			rids[k] = handle->insertRecord(record);
+			handle.markDirty();
+		}
+
+		printf("%u pages, %u lookups per thread, %u hardware threads\n", numPages, lookups,
+		       std::thread::hardware_concurrency());
+		printf("%8s %16s %16s %9s %10s %10s\n", "threads", "pinned/s", "optimistic/s", "speedup", "retries",
+		       "fallbacks");
+		for (int threads = 1; threads <= 64; threads *= 2)
+		{
+			const double pinned = measure(pool, file, pages, rids, threads, lookups, false);
+			pool.clearBufStats();
+			const double optimistic = measure(pool, file, pages, rids, threads, lookups, true);
+			const BufStats stats = pool.getBufStats();
+			printf("%8d %16.0f %16.0f %8.2fx %10lu %10lu\n", threads, pinned, optimistic, optimistic / pinned,
+			       (unsigned long) stats.optimisticRetries, (unsigned long) stats.optimisticFallbacks);
+		}
+	}
+
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Compares full scans and random point reads through the buffer manager for
+ * every supported page size.  The same amount of record data is loaded for
+ * each size and the buffer pool always holds a quarter of the file.
+ *
+ * Usage: page_size_bench [data MB] [point reads]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer.h"
+#include "file_iterator.h"
+#include "page_iterator.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+template <std::size_t PageSize>
+static void runBench(const std::size_t dataBytes, const int pointReads)
+{
+	typedef BasicFile<PageSize> File;
+	typedef BasicPage<PageSize> Page;
+	typedef BasicPageIterator<PageSize> PageIterator;
+
+	const std::string filename = "page_size_bench.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+
+	const std::string record(64, 'r');
+	std::vector<RecordId> rids;
+	std::uint32_t numPages = 0;
+	{
+		File file = File::create(filename);
+		Page page = file.allocatePage();
+		numPages = 1;
+		for (std::size_t loaded = 0; loaded < dataBytes; loaded += record.size())
+		{
+			if (!page.hasSpaceForRecord(record))
+			{
+				file.writePage(page);
+				page = file.allocatePage();
+				numPages++;
+			}
+			rids.push_back(page.insertRecord(record));
+		}
+		file.writePage(page);
+	}
+
+	File file = File::open(filename);
+	std::uint32_t poolFrames = numPages / 4 > 0 ? numPages / 4 : 1;
+
+	// Full scan: every page is read through the pool and every record touched.
+	double scanNs;
+	{
+		BasicBufMgr<PageSize> bufMgr(poolFrames);
+		std::size_t records = 0;
+		Clock::time_point start = Clock::now();
+		for (PageId pageNo = 1; pageNo <= numPages; pageNo++)
+		{
+			Page* page;
+			bufMgr.readPage(&file, pageNo, page);
+			for (PageIterator iter = page->begin(); iter != page->end(); ++iter)
+				records++;
+			bufMgr.unPinPage(&file, pageNo, false);
+		}
+		scanNs = elapsedNs(start);
+		if (records != rids.size())
+		{
+			std::cerr << "scan found " << records << " of " << rids.size() << " records\n";
+			exit(1);
+		}
+	}
+
+	// Point reads: uniformly random records, a quarter of which are resident.
+	double pointNs;
+	std::uint64_t diskreads;
+	{
+		BasicBufMgr<PageSize> bufMgr(poolFrames);
+		std::mt19937 rng(42);
+		std::uniform_int_distribution<std::size_t> pick(0, rids.size() - 1);
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < pointReads; i++)
+		{
+			const RecordId& rid = rids[pick(rng)];
+			Page* page;
+			bufMgr.readPage(&file, rid.page_number, page);
+			if (page->getRecord(rid).size() != record.size())
+				exit(1);
+			bufMgr.unPinPage(&file, rid.page_number, false);
+		}
+		pointNs = elapsedNs(start);
+		diskreads = bufMgr.getBufStats().diskreads;
+	}
+
+	const double mb = (double) numPages * PageSize / (1024 * 1024);
+	printf("%6zu %8u %8u %12.1f %12.0f %10.3f\n", PageSize, numPages, poolFrames,
+	       mb / (scanNs / 1e9), pointNs / pointReads,
+	       (double) diskreads / pointReads);
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t dataMb = argc > 1 ? atoi(argv[1]) : 4;
+	const int pointReads = argc > 2 ? atoi(argv[2]) : 200000;
+
+	printf("%6s %8s %8s %12s %12s %10s\n", "page", "pages", "frames",
+	       "scan MB/s", "point ns/op", "miss/op");
+#define RUN_BENCH(size) runBench<size>(dataMb * 1024 * 1024, pointReads);
+	BADGERDB_FOR_EACH_PAGE_SIZE(RUN_BENCH)
+#undef RUN_BENCH
+
+	BasicFile<DEFAULT_PAGE_SIZE>::remove("page_size_bench.db");
+	return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Scans one column of a wide table (32 int64 columns) stored as slotted row
+ * pages and as PAX pages, both on in-memory pages and from a file.
+ *
+ * Usage: pax_bench [pages]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "file_iterator.h"
+#include "page_iterator.h"
+#include "pax_page.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static const std::size_t NUM_COLUMNS = 32;
+static const std::size_t SCAN_COLUMN = 7;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static std::string makeRow(std::int64_t key)
+{
+	std::string row(NUM_COLUMNS * sizeof(std::int64_t), '\0');
+	for (std::size_t i = 0; i < NUM_COLUMNS; i++)
+	{
+		std::int64_t value = key * NUM_COLUMNS + i;
+		memcpy(&row[i * sizeof(value)], &value, sizeof(value));
+	}
+	return row;
+}
+
+static void removeIfExists(const std::string& filename)
+{
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const int numPages = argc > 1 ? atoi(argv[1]) : 400;
+
+	PaxSchema schema(std::vector<std::size_t>(NUM_COLUMNS, sizeof(std::int64_t)));
+	const std::string rowFile = "pax_bench_rows.db";
+	const std::string paxFile = "pax_bench_pax.db";
+	removeIfExists(rowFile);
+	removeIfExists(paxFile);
+
+	std::vector<Page> rowPages(numPages);
+	std::vector<Page> paxPages(numPages);
+	std::int64_t rowKeys = 0;
+	std::int64_t paxKeys = 0;
+	std::int64_t expected = 0;
+	{
+		File rows = File::create(rowFile);
+		File pax = File::create(paxFile);
+		for (int i = 0; i < numPages; i++)
+		{
+			rowPages[i] = rows.allocatePage();
+			while (rowPages[i].hasSpaceForRecord(makeRow(rowKeys)))
+				rowPages[i].insertRecord(makeRow(rowKeys++));
+			rows.writePage(rowPages[i]);
+
+			paxPages[i] = pax.allocatePage();
+			PaxPage<> page = PaxPage<>::format(&paxPages[i], schema);
+			while (!page.isFull())
+				page.insertRecord(makeRow(paxKeys++));
+			pax.writePage(paxPages[i]);
+		}
+	}
+	for (std::int64_t key = 0; key < paxKeys; key++)
+		expected += key * NUM_COLUMNS + SCAN_COLUMN;
+
+	printf("%d pages: %lld rows slotted, %lld rows PAX\n", numPages,
+	       (long long) rowKeys, (long long) paxKeys);
+	printf("%-28s %12s\n", "scan of one column", "ns/row");
+
+	// In-memory slotted pages: each row is copied out whole.
+	std::int64_t sum = 0;
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < numPages; i++)
+	{
+		for (PageIterator iter = rowPages[i].begin(); iter != rowPages[i].end(); ++iter)
+		{
+			std::int64_t value;
+			memcpy(&value, (*iter).data() + SCAN_COLUMN * sizeof(value), sizeof(value));
+			sum += value;
+		}
+	}
+	printf("%-28s %12.2f\n", "slotted, memory", elapsedNs(start) / rowKeys);
+
+	// In-memory PAX pages: only the column's minipage is read.
+	std::int64_t paxSum = 0;
+	start = Clock::now();
+	for (int i = 0; i < numPages; i++)
+	{
+		PaxPage<> page(&paxPages[i], schema);
+		const char* column = page.getColumnData(SCAN_COLUMN);
+		for (SlotId slot = page.getNextUsedSlot(Page::INVALID_SLOT);
+		     slot != Page::INVALID_SLOT;
+		     slot = page.getNextUsedSlot(slot))
+		{
+			std::int64_t value;
+			memcpy(&value, column + (slot - 1) * sizeof(value), sizeof(value));
+			paxSum += value;
+		}
+	}
+	printf("%-28s %12.2f\n", "PAX, memory", elapsedNs(start) / paxKeys);
+	if (paxSum != expected)
+	{
+		fprintf(stderr, "PAX scan returned the wrong sum\n");
+		return 1;
+	}
+
+	// Whole-file scans through FileIterator.
+	{
+		File rows = File::open(rowFile);
+		File pax = File::open(paxFile);
+		sum = 0;
+		start = Clock::now();
+		for (FileIterator iter = rows.begin(); iter != rows.end(); ++iter)
+		{
+			Page page = *iter;
+			for (PageIterator rec = page.begin(); rec != page.end(); ++rec)
+			{
+				std::int64_t value;
+				memcpy(&value, (*rec).data() + SCAN_COLUMN * sizeof(value), sizeof(value));
+				sum += value;
+			}
+		}
+		printf("%-28s %12.2f\n", "slotted, file", elapsedNs(start) / rowKeys);
+
+		paxSum = 0;
+		std::vector<std::size_t> columns(1, SCAN_COLUMN);
+		start = Clock::now();
+		scanColumns(pax, schema, columns,
+		            [&paxSum](const RecordId&, const char* const* values) {
+			std::int64_t value;
+			memcpy(&value, values[0], sizeof(value));
+			paxSum += value;
+		});
+		printf("%-28s %12.2f\n", "PAX scanColumns, file", elapsedNs(start) / paxKeys);
+		if (paxSum != expected)
+		{
+			fprintf(stderr, "PAX file scan returned the wrong sum\n");
+			return 1;
+		}
+	}
+
+	File::remove(rowFile);
+	File::remove(paxFile);
+	return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures the cost of pinning and unpinning a page that is already in the
+ * buffer pool, the common case for a hot working set.  Every page of the file
+ * fits in the pool, so every access is a hit; pages are visited in a shuffled
+ * order so hash buckets and frames are not touched in sequence.
+ *
+ * "unPinPage" pairs readPage with unPinPage, which looks the page up in the
+ * hash table a second time.  "PageHandle" takes the handle returned by
+ * readPage and lets its destructor unpin the frame it remembers.
+ *
+ * Usage: pin_bench [pages] [passes]   (default 4096 200)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static void report(const char* label, const double ns, const std::uint64_t pairs, const BufStats& stats)
+{
+	printf("%-12s %12.1f %12llu %12llu\n", label, ns / pairs,
+	       (unsigned long long) stats.hits, (unsigned long long) stats.misses);
+}
+
+int main(int argc, char* argv[])
+{
+	const std::uint32_t pages = argc > 1 ? atoi(argv[1]) : 4096;
+	const std::uint32_t passes = argc > 2 ? atoi(argv[2]) : 200;
+	const std::uint64_t pairs = (std::uint64_t) pages * passes;
+
+	const std::string filename = "pin_bench.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+
+	{
+		File file = File::create(filename);
+		BufMgr bufMgr(pages);
+		std::vector<PageId> order(pages);
+		for (std::uint32_t i = 0; i < pages; i++)
+		{
+			PageHandle handle = bufMgr.allocPage(&file, order[i]);
+			handle.markDirty();
+		}
+		std::mt19937_64 rng(42);
+		std::shuffle(order.begin(), order.end(), rng);
+
+		printf("%-12s %12s %12s %12s\n", "unpin", "ns/pair", "hits", "misses");
+
+		Page* page;
+		std::uint64_t checksum = 0;
+		bufMgr.clearBufStats();
+		Clock::time_point start = Clock::now();
+		for (std::uint32_t pass = 0; pass < passes; pass++)
+		{
+			for (std::uint32_t i = 0; i < pages; i++)
+			{
+				bufMgr.readPage(&file, order[i], page);
+				checksum += page->page_number();
+				bufMgr.unPinPage(&file, order[i], false);
+			}
+		}
+		report("unPinPage", elapsedNs(start), pairs, bufMgr.getBufStats());
+
+		bufMgr.clearBufStats();
+		start = Clock::now();
+		for (std::uint32_t pass = 0; pass < passes; pass++)
+		{
+			for (std::uint32_t i = 0; i < pages; i++)
+			{
+				PageHandle handle = bufMgr.readPage(&file, order[i]);
+				checksum -= handle->page_number();
+			}
+		}
+		const BufStats stats = bufMgr.getBufStats();
+		report("PageHandle", elapsedNs(start), pairs, stats);
+
+		if (checksum != 0 || stats.misses != 0 || bufMgr.getFileBufStats(&file).resident != pages)
+		{
+			std::cerr << "pages were missed or read wrongly\n";
+			exit(1);
+		}
+	}
+
+	File::remove(filename);
+	return 0;
+}
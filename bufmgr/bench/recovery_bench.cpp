@@ -0,0 +1,160 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures redo recovery after a crash.  A child process fills a file with
+ * <data> pages through a buffer pool that logs to a write-ahead log, takes a
+ * checkpoint, changes <updates> random pages, commits and exits without
+ * writing the pool back.  The parent then recovers copies of the crashed file
+ * with 1, 2 and 4 threads.  With the updates fixed, recovery time should stay
+ * flat as the file (and the log before the checkpoint) grows; with the file
+ * fixed it should grow with the updates.  The files are in the page cache, so
+ * the times exclude device reads.
+ *
+ * Usage: recovery_bench [scale]   (default 1)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "buffer.h"
+#include "file_iterator.h"
+#include "page_iterator.h"
+#include "recovery.h"
+#include "write_ahead_log.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static const std::string fileName = "recovery_bench.db";
+static const std::string copyName = "recovery_bench.db.crashed";
+static const std::string logName = "recovery_bench.wal";
+
+static void copyFile(const std::string& from, const std::string& to)
+{
+	std::ifstream in(from.c_str(), std::ios::binary);
+	std::ofstream out(to.c_str(), std::ios::binary | std::ios::trunc);
+	out << in.rdbuf();
+}
+
+//fills the file, checkpoints, changes random pages and "crashes"
+static void crashingRun(const PageId dataPages, const int updates)
+{
+	File file = File::create(fileName);
+	WriteAheadLog log(logName);
+	file.setLog(&log);
+	BufMgr pool(256);
+	pool.setLog(&log);
+	std::vector<PageId> pages(dataPages);
+	for (PageId p = 0; p < dataPages; p++)
+	{
+		PageHandle handle = pool.allocPage(&file, pages[p]);
+		handle->insertRecord("data");
+		handle.markDirty();
+	}
+	pool.checkpoint();
+
+	std::mt19937 rng(42);
+	for (int u = 0; u < updates; u++)
+	{
+		PageHandle handle = pool.readPage(&file, pages[rng() % dataPages]);
+		handle->insertRecord("update");
+		handle.markDirty();
+		if (u % 100 == 99)
+			log.flush();
+	}
+	log.flush();
+	_exit(0);
+}
+
+static std::uint64_t countRecords()
+{
+	std::uint64_t records = 0;
+	File file = File::open(fileName);
+	for (FileIterator iter = file.begin(); iter != file.end(); ++iter)
+	{
+		Page page = *iter;
+		for (PageIterator pageIter = page.begin(); pageIter != page.end(); ++pageIter)
+			records++;
+	}
+	return records;
+}
+
+static void run(const PageId dataPages, const int updates)
+{
+	try
+	{
+		File::remove(fileName);
+	}
+	catch (FileNotFoundException&)
+	{
+	}
+	std::remove(logName.c_str());
+
+	const pid_t child = fork();
+	if (child == 0)
+		crashingRun(dataPages, updates);
+	int status;
+	if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	{
+		std::cerr << "crashing process failed\n";
+		exit(1);
+	}
+	copyFile(fileName, copyName);
+
+	const std::uint32_t threadCounts[] = {1, 2, 4};
+	double ms[3];
+	RecoveryStats stats = RecoveryStats();
+	for (int t = 0; t < 3; t++)
+	{
+		copyFile(copyName, fileName);
+		const Clock::time_point start = Clock::now();
+		stats = Recovery::run(logName, threadCounts[t]);
+		ms[t] = elapsedNs(start) / 1e6;
+	}
+	if (countRecords() != dataPages + (std::uint64_t) updates)
+	{
+		std::cerr << "recovery lost updates\n";
+		exit(1);
+	}
+	printf("%10u %8d %10.1f %9lu %9lu %9.1f %9.1f %9.1f\n", dataPages, updates,
+	       (stats.end_lsn - stats.redo_lsn) / 1048576.0, (unsigned long) stats.records,
+	       (unsigned long) stats.pages, ms[0], ms[1], ms[2]);
+
+	File::remove(fileName);
+	std::remove(copyName.c_str());
+	std::remove(logName.c_str());
+}
+
+int main(int argc, char* argv[])
+{
+	const int scale = argc > 1 ? atoi(argv[1]) : 1;
+
+	printf("%10s %8s %10s %9s %9s %9s %9s %9s\n", "data pages", "updates", "redo MB", "records", "pages",
+	       "1 thr ms", "2 thr ms", "4 thr ms");
+	const PageId dataSizes[] = {500, 2000, 8000};
+	for (PageId dataPages : dataSizes)
+		run(dataPages * scale, 1000 * scale);
+	const int updateCounts[] = {250, 1000, 4000};
+	for (int updates : updateCounts)
+		run(2000 * scale, updates * scale);
+	return 0;
+}
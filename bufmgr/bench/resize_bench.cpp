@@ -0,0 +1,106 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Measures how long BufMgr::resize() stalls the pool.  A pool is filled with
+ * a file of its own size, grown, checked to still hold every page, then shrunk
+ * back to its original size (the removed frames are unused) and to a quarter
+ * of it (evicting pages, half of them dirty).
+ *
+ * Usage: resize_bench [from MB] [to MB]   (default 1024 4096)
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "buffer.h"
+#include "exceptions/file_not_found_exception.h"
+
+using namespace badgerdb;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedNs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static void timeResize(BufMgr& bufMgr, const char* label, const std::uint32_t frames)
+{
+	const BufStats before = bufMgr.getBufStats();
+	const std::uint32_t oldFrames = bufMgr.numFrames();
+	Clock::time_point start = Clock::now();
+	bufMgr.resize(frames);
+	const double ns = elapsedNs(start);
+	const BufStats after = bufMgr.getBufStats();
+	printf("%-22s %10u %10u %12.3f %10llu %10llu\n", label, oldFrames, frames, ns / 1e6,
+	       (unsigned long long) (after.evictions - before.evictions),
+	       (unsigned long long) (after.diskwrites - before.diskwrites));
+}
+
+int main(int argc, char* argv[])
+{
+	const std::uint64_t fromMb = argc > 1 ? atoi(argv[1]) : 1024;
+	const std::uint64_t toMb = argc > 2 ? atoi(argv[2]) : 4096;
+	const std::uint32_t fromFrames = (std::uint32_t) (fromMb * 1024 * 1024 / Page::SIZE);
+	const std::uint32_t toFrames = (std::uint32_t) (toMb * 1024 * 1024 / Page::SIZE);
+
+	const std::string filename = "resize_bench.db";
+	try
+	{
+		File::remove(filename);
+	}
+	catch(FileNotFoundException&)
+	{
+	}
+	{
+		File file = File::create(filename);
+		for (std::uint32_t i = 0; i < fromFrames; i++)
+		{
+			Page page = file.allocatePage();
+			page.insertRecord(std::string(64, 'a' + i % 26));
+			file.writePage(page);
+		}
+	}
+
+	{
+		File file = File::open(filename);
+		BufMgr bufMgr(fromFrames);
+		Page* page;
+		for (PageId pageNo = 1; pageNo <= fromFrames; pageNo++)
+		{
+			bufMgr.readPage(&file, pageNo, page);
+			bufMgr.unPinPage(&file, pageNo, false);
+		}
+
+		printf("%-22s %10s %10s %12s %10s %10s\n", "resize", "frames", "new frames", "pause ms",
+		       "evicted", "written");
+		timeResize(bufMgr, "grow", toFrames);
+
+		// Every page must still be resident; dirty half of them for the shrinks.
+		bufMgr.clearBufStats();
+		for (PageId pageNo = 1; pageNo <= fromFrames; pageNo++)
+		{
+			bufMgr.readPage(&file, pageNo, page);
+			bufMgr.unPinPage(&file, pageNo, pageNo % 2 == 0);
+		}
+		if (bufMgr.getBufStats().misses != 0)
+		{
+			std::cerr << "grow lost " << bufMgr.getBufStats().misses << " pages\n";
+			exit(1);
+		}
+
+		timeResize(bufMgr, "shrink unused frames", fromFrames);
+		timeResize(bufMgr, "shrink evicting pages", fromFrames / 4);
+	}
+
+	File::remove(filename);
+	return 0;
+}
@@ -0,0 +1,440 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+/*
+ * Replays a page access trace recorded with BufMgr::startTrace() and prints
+ * the miss ratio curve: the fraction of page reads that would miss in a pool
+ * of each size under several replacement policies.
+ *
+ * LRU is a stack algorithm, so its whole curve comes from one pass computing
+ * the stack distance of every reference.  Other policies are simulated once
+ * per pool size:
+ *   clock  the second-chance clock BufMgr uses, frame for frame
+ *   fifo   first in, first out
+ *   opt    Belady's optimal policy, a lower bound for any policy
+ *
+ * Reads are the references counted as hits or misses.  Allocations take a
+ * frame but are not counted, since they do not read from disk; disposed
+ * pages leave the pool.  Pins are not modelled: every page is assumed
+ * unpinned by the time a frame is needed.
+ *
+ * Usage: trace_replay TRACE [--sizes=N,N,...] [--policies=lru,clock,fifo,opt]
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "page_trace.h"
+#include "exceptions/trace_file_exception.h"
+
+using namespace badgerdb;
+
+typedef std::uint64_t PageKey;
+
+struct Reference
+{
+	PageKey key;
+	std::uint8_t op;
+};
+
+static void usage()
+{
+	std::cerr << "usage: trace_replay TRACE [--sizes=N,N,...] [--policies=lru,clock,fifo,opt]\n";
+	exit(1);
+}
+
+static std::vector<std::string> split(const std::string& list)
+{
+	std::vector<std::string> items;
+	std::size_t start = 0;
+	while (start <= list.size())
+	{
+		std::size_t comma = list.find(',', start);
+		if (comma == std::string::npos)
+			comma = list.size();
+		if (comma > start)
+			items.push_back(list.substr(start, comma - start));
+		start = comma + 1;
+	}
+	return items;
+}
+
+/*
+ * Fenwick tree over reference times, marking the last reference of every
+ * resident page.  The number of marks after a page's previous reference is
+ * the number of distinct pages touched since.
+ */
+class Fenwick
+{
+ public:
+	explicit Fenwick(const std::size_t n) : tree_(n + 1, 0) {}
+
+	void add(std::size_t i, const int delta)
+	{
+		for (i++; i < tree_.size(); i += i & (~i + 1))
+			tree_[i] += delta;
+	}
+
+	/* Sum of marks in [0, i). */
+	std::int64_t prefix(std::size_t i) const
+	{
+		std::int64_t sum = 0;
+		for (; i > 0; i -= i & (~i + 1))
+			sum += tree_[i];
+		return sum;
+	}
+
+ private:
+	std::vector<std::int32_t> tree_;
+};
+
+/*
+ * Returns, for every pool size, the number of LRU read misses, using one pass
+ * over the trace.
+ */
+static std::vector<std::uint64_t> lruMisses(const std::vector<Reference>& refs, const std::vector<std::uint64_t>& sizes)
+{
+	Fenwick marks(refs.size());
+	std::unordered_map<PageKey, std::size_t> lastRef;
+	// distances[d] counts reads with stack distance d; cold reads are infinite.
+	std::vector<std::uint64_t> distances;
+	std::uint64_t coldReads = 0;
+	for (std::size_t t = 0; t < refs.size(); t++)
+	{
+		const Reference& ref = refs[t];
+		std::unordered_map<PageKey, std::size_t>::iterator last = lastRef.find(ref.key);
+		if (ref.op == TRACE_DISPOSE)
+		{
+			if (last != lastRef.end())
+			{
+				marks.add(last->second, -1);
+				lastRef.erase(last);
+			}
+			continue;
+		}
+		std::uint64_t distance = 0;
+		if (last != lastRef.end())
+		{
+			distance = marks.prefix(t) - marks.prefix(last->second + 1) + 1;
+			marks.add(last->second, -1);
+		}
+		marks.add(t, 1);
+		lastRef[ref.key] = t;
+		if (ref.op != TRACE_READ)
+			continue;
+		if (distance == 0)
+		{
+			coldReads++;
+		}
+		else
+		{
+			if (distances.size() <= distance)
+				distances.resize(distance + 1, 0);
+			distances[distance]++;
+		}
+	}
+
+	// A read hits in a pool of C frames if its stack distance is at most C.
+	std::vector<std::uint64_t> misses;
+	for (std::size_t s = 0; s < sizes.size(); s++)
+	{
+		std::uint64_t count = coldReads;
+		for (std::size_t d = sizes[s] + 1; d < distances.size(); d++)
+			count += distances[d];
+		misses.push_back(count);
+	}
+	return misses;
+}
+
+/*
+ * A replacement policy simulated at one pool size.
+ */
+class Policy
+{
+ public:
+	virtual ~Policy() {}
+
+	/* References the page at time t; returns true on a hit. */
+	virtual bool access(const PageKey key, const std::size_t t) = 0;
+
+	/* Drops the page from the pool if it is resident. */
+	virtual void remove(const PageKey key) = 0;
+};
+
+/*
+ * The clock algorithm as implemented by BufMgr::allocBuf: the hand advances
+ * before looking at a frame, a referenced frame gets a second chance, and a
+ * newly loaded page starts with its reference bit set.
+ */
+class ClockPolicy : public Policy
+{
+ public:
+	explicit ClockPolicy(const std::size_t frames)
+		: keys_(frames), valid_(frames, false), refbit_(frames, false), hand_(frames - 1) {}
+
+	bool access(const PageKey key, const std::size_t)
+	{
+		std::unordered_map<PageKey, std::size_t>::iterator frame = frames_.find(key);
+		if (frame != frames_.end())
+		{
+			refbit_[frame->second] = true;
+			return true;
+		}
+		for (;;)
+		{
+			hand_ = hand_ + 1 == keys_.size() ? 0 : hand_ + 1;
+			if (!valid_[hand_])
+				break;
+			if (!refbit_[hand_])
+			{
+				frames_.erase(keys_[hand_]);
+				break;
+			}
+			refbit_[hand_] = false;
+		}
+		keys_[hand_] = key;
+		valid_[hand_] = true;
+		refbit_[hand_] = true;
+		frames_[key] = hand_;
+		return false;
+	}
+
+	void remove(const PageKey key)
+	{
+		std::unordered_map<PageKey, std::size_t>::iterator frame = frames_.find(key);
+		if (frame != frames_.end())
+		{
+			valid_[frame->second] = false;
+			frames_.erase(frame);
+		}
+	}
+
+ private:
+	std::vector<PageKey> keys_;
+	std::vector<bool> valid_;
+	std::vector<bool> refbit_;
+	std::size_t hand_;
+	std::unordered_map<PageKey, std::size_t> frames_;
+};
+
+class FifoPolicy : public Policy
+{
+ public:
+	explicit FifoPolicy(const std::size_t frames) : frames_(frames), clock_(0) {}
+
+	bool access(const PageKey key, const std::size_t)
+	{
+		if (loaded_.count(key))
+			return true;
+		if (loaded_.size() == frames_)
+		{
+			std::set<std::pair<std::uint64_t, PageKey> >::iterator oldest = order_.begin();
+			loaded_.erase(oldest->second);
+			order_.erase(oldest);
+		}
+		loaded_[key] = clock_;
+		order_.insert(std::make_pair(clock_++, key));
+		return false;
+	}
+
+	void remove(const PageKey key)
+	{
+		std::unordered_map<PageKey, std::uint64_t>::iterator page = loaded_.find(key);
+		if (page != loaded_.end())
+		{
+			order_.erase(std::make_pair(page->second, key));
+			loaded_.erase(page);
+		}
+	}
+
+ private:
+	std::size_t frames_;
+	std::uint64_t clock_;
+	std::unordered_map<PageKey, std::uint64_t> loaded_;
+	std::set<std::pair<std::uint64_t, PageKey> > order_;
+};
+
+/*
+ * Belady's policy: evict the page whose next reference is furthest away.
+ */
+class OptPolicy : public Policy
+{
+ public:
+	OptPolicy(const std::size_t frames, const std::vector<std::size_t>& nextRef)
+		: frames_(frames), nextRef_(nextRef) {}
+
+	bool access(const PageKey key, const std::size_t t)
+	{
+		std::unordered_map<PageKey, std::size_t>::iterator page = resident_.find(key);
+		const bool hit = page != resident_.end();
+		if (hit)
+		{
+			order_.erase(std::make_pair(page->second, key));
+		}
+		else if (resident_.size() == frames_)
+		{
+			std::set<std::pair<std::size_t, PageKey> >::iterator furthest = --order_.end();
+			resident_.erase(furthest->second);
+			order_.erase(furthest);
+		}
+		resident_[key] = nextRef_[t];
+		order_.insert(std::make_pair(nextRef_[t], key));
+		return hit;
+	}
+
+	void remove(const PageKey key)
+	{
+		std::unordered_map<PageKey, std::size_t>::iterator page = resident_.find(key);
+		if (page != resident_.end())
+		{
+			order_.erase(std::make_pair(page->second, key));
+			resident_.erase(page);
+		}
+	}
+
+ private:
+	std::size_t frames_;
+	const std::vector<std::size_t>& nextRef_;
+	std::unordered_map<PageKey, std::size_t> resident_;
+	std::set<std::pair<std::size_t, PageKey> > order_;
+};
+
+static std::uint64_t simulate(Policy& policy, const std::vector<Reference>& refs)
+{
+	std::uint64_t misses = 0;
+	for (std::size_t t = 0; t < refs.size(); t++)
+	{
+		if (refs[t].op == TRACE_DISPOSE)
+		{
+			policy.remove(refs[t].key);
+			continue;
+		}
+		if (!policy.access(refs[t].key, t) && refs[t].op == TRACE_READ)
+			misses++;
+	}
+	return misses;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+		usage();
+	const std::string traceName = argv[1];
+	std::vector<std::uint64_t> sizes;
+	std::vector<std::string> policies = split("lru,clock,fifo,opt");
+	for (int i = 2; i < argc; i++)
+	{
+		if (strncmp(argv[i], "--sizes=", 8) == 0)
+		{
+			const std::vector<std::string> items = split(argv[i] + 8);
+			for (std::size_t j = 0; j < items.size(); j++)
+				sizes.push_back(strtoull(items[j].c_str(), NULL, 10));
+		}
+		else if (strncmp(argv[i], "--policies=", 11) == 0)
+			policies = split(argv[i] + 11);
+		else
+			usage();
+	}
+
+	// Pinned references only; unpins carry no replacement information.
+	std::vector<Reference> refs;
+	std::unordered_map<PageKey, bool> distinct;
+	std::uint64_t reads = 0;
+	try
+	{
+		PageTraceReader reader(traceName);
+		PageTraceRecord record;
+		while (reader.next(record))
+		{
+			if (record.op == TRACE_UNPIN)
+				continue;
+			const Reference ref = {((PageKey) record.file_id << 32) | record.page_number, record.op};
+			refs.push_back(ref);
+			if (record.op != TRACE_DISPOSE)
+				distinct[ref.key] = true;
+			if (record.op == TRACE_READ)
+				reads++;
+		}
+	}
+	catch(TraceFileException& e)
+	{
+		std::cerr << e.message() << "\n";
+		return 1;
+	}
+	if (reads == 0)
+	{
+		std::cerr << "trace has no page reads\n";
+		return 1;
+	}
+
+	if (sizes.empty())
+	{
+		for (std::uint64_t size = 8; size < 2 * distinct.size(); size *= 2)
+			sizes.push_back(size);
+	}
+	for (std::size_t s = 0; s < sizes.size(); s++)
+		if (sizes[s] == 0)
+			usage();
+
+	std::vector<std::size_t> nextRef(refs.size());
+	{
+		std::unordered_map<PageKey, std::size_t> upcoming;
+		for (std::size_t t = refs.size(); t-- > 0;)
+		{
+			std::unordered_map<PageKey, std::size_t>::iterator next = upcoming.find(refs[t].key);
+			nextRef[t] = next == upcoming.end() ? refs.size() : next->second;
+			upcoming[refs[t].key] = t;
+		}
+	}
+
+	std::printf("%s: %zu references, %llu reads, %zu distinct pages\n", traceName.c_str(),
+	            refs.size(), (unsigned long long) reads, distinct.size());
+	std::printf("%10s", "frames");
+	for (std::size_t p = 0; p < policies.size(); p++)
+		std::printf(" %10s", policies[p].c_str());
+	std::printf("\n");
+
+	std::vector<std::vector<std::uint64_t> > misses(policies.size());
+	for (std::size_t p = 0; p < policies.size(); p++)
+	{
+		if (policies[p] == "lru")
+		{
+			misses[p] = lruMisses(refs, sizes);
+			continue;
+		}
+		for (std::size_t s = 0; s < sizes.size(); s++)
+		{
+			Policy* policy;
+			if (policies[p] == "clock")
+				policy = new ClockPolicy(sizes[s]);
+			else if (policies[p] == "fifo")
+				policy = new FifoPolicy(sizes[s]);
+			else if (policies[p] == "opt")
+				policy = new OptPolicy(sizes[s], nextRef);
+			else
+				usage();
+			misses[p].push_back(simulate(*policy, refs));
+			delete policy;
+		}
+	}
+
+	for (std::size_t s = 0; s < sizes.size(); s++)
+	{
+		std::printf("%10llu", (unsigned long long) sizes[s]);
+		for (std::size_t p = 0; p < policies.size(); p++)
+			std::printf(" %10.4f", (double) misses[p][s] / reads);
+		std::printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,290 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "block_compression.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * Shortest match worth encoding.
+ */
+const std::size_t MIN_MATCH = 4;
+
+/**
+ * Number of bits in the match finder's hash.
+ */
+const int HASH_BITS = 12;
+
+/**
+ * Largest back reference offset the format can express.
+ */
+const std::size_t MAX_OFFSET = 65535;
+
+inline std::uint32_t load32(const unsigned char* p) {
+  std::uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+inline std::uint64_t load64(const unsigned char* p) {
+  std::uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/**
+ * Copies <length> bytes in 8-byte steps.  May write up to 7 bytes past
+ * dst + length, and requires src to be at least 8 bytes behind dst if they
+ * overlap.
+ */
+inline void wildCopy(unsigned char* dst, const unsigned char* src,
+                     const std::size_t length) {
+  unsigned char* const end = dst + length;
+  do {
+    std::memcpy(dst, src, 8);
+    dst += 8;
+    src += 8;
+  } while (dst < end);
+}
+
+/**
+ * Returns the number of leading bytes at <a> and <b> that are equal, looking
+ * no further than <limit>.
+ */
+inline std::size_t commonLength(const unsigned char* a, const unsigned char* b,
+                                const unsigned char* limit) {
+  const unsigned char* const start = a;
+  while (limit - a >= 8) {
+    const std::uint64_t diff = load64(a) ^ load64(b);
+    if (diff != 0) {
+      return (a - start) + (__builtin_ctzll(diff) >> 3);
+    }
+    a += 8;
+    b += 8;
+  }
+  while (a < limit && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return a - start;
+}
+
+inline std::uint32_t hash32(const std::uint32_t value) {
+  return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/**
+ * Writes a length that did not fit in its token nibble as a run of 255s and
+ * a final byte below 255.
+ */
+inline bool putLength(std::size_t length, unsigned char*& op,
+                      const unsigned char* end) {
+  while (length >= 255) {
+    if (op >= end) {
+      return false;
+    }
+    *op++ = 255;
+    length -= 255;
+  }
+  if (op >= end) {
+    return false;
+  }
+  *op++ = static_cast<unsigned char>(length);
+  return true;
+}
+
+/**
+ * Emits one sequence: <literal_length> literals from <literals> followed by a
+ * match of <match_length> bytes at <offset>.  A match length of zero ends the
+ * block with literals only.
+ */
+bool putSequence(const unsigned char* literals, const std::size_t literal_length,
+                 const std::size_t offset, const std::size_t match_length,
+                 unsigned char*& op, const unsigned char* end) {
+  if (op >= end) {
+    return false;
+  }
+  unsigned char* token = op++;
+  *token = static_cast<unsigned char>(
+      (literal_length < 15 ? literal_length : 15) << 4);
+  if (literal_length >= 15 && !putLength(literal_length - 15, op, end)) {
+    return false;
+  }
+  if (static_cast<std::size_t>(end - op) < literal_length) {
+    return false;
+  }
+  std::memcpy(op, literals, literal_length);
+  op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+  if (end - op < 2) {
+    return false;
+  }
+  *op++ = static_cast<unsigned char>(offset);
+  *op++ = static_cast<unsigned char>(offset >> 8);
+  const std::size_t code = match_length - MIN_MATCH;
+  *token |= static_cast<unsigned char>(code < 15 ? code : 15);
+  return code < 15 || putLength(code - 15, op, end);
+}
+
+/**
+ * Reads the continuation bytes of a length whose nibble was 15.
+ */
+inline bool getLength(std::size_t& length, const unsigned char*& ip,
+                      const unsigned char* end) {
+  unsigned char byte;
+  do {
+    if (ip >= end) {
+      return false;
+    }
+    byte = *ip++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}
+
+std::size_t compressBlock(const char* src, const std::size_t length,
+                          char* dst, const std::size_t capacity) {
+  assert(length <= MAX_OFFSET + 1);
+  const unsigned char* const base = reinterpret_cast<const unsigned char*>(src);
+  const unsigned char* const end = base + length;
+  unsigned char* op = reinterpret_cast<unsigned char*>(dst);
+  const unsigned char* const op_end = op + capacity;
+
+  // Positions are stored plus one so that zero means "no candidate".
+  std::uint32_t table[1 << HASH_BITS];
+  std::memset(table, 0, sizeof(table));
+
+  const unsigned char* ip = base;
+  const unsigned char* anchor = base;
+  while (end - ip >= static_cast<std::ptrdiff_t>(MIN_MATCH)) {
+    const std::uint32_t sequence = load32(ip);
+    const std::uint32_t h = hash32(sequence);
+    const std::uint32_t candidate = table[h];
+    table[h] = static_cast<std::uint32_t>(ip - base) + 1;
+    if (candidate == 0 ||
+        static_cast<std::size_t>(ip - base) - (candidate - 1) > MAX_OFFSET ||
+        load32(base + candidate - 1) != sequence) {
+      // Step further the longer we go without a match, so incompressible
+      // data is skipped quickly.
+      ip += 1 + ((ip - anchor) >> 6);
+      continue;
+    }
+    const unsigned char* match = base + candidate - 1;
+    std::size_t match_length =
+        MIN_MATCH + commonLength(ip + MIN_MATCH, match + MIN_MATCH, end);
+    // Extend backwards over literals that also match.
+    while (ip > anchor && match > base && ip[-1] == match[-1]) {
+      --ip;
+      --match;
+      ++match_length;
+    }
+    if (!putSequence(anchor, ip - anchor, ip - match, match_length, op,
+                     op_end)) {
+      return 0;
+    }
+    ip += match_length;
+    anchor = ip;
+    if (end - ip >= static_cast<std::ptrdiff_t>(MIN_MATCH) + 2) {
+      // Index a position inside the match so runs keep chaining.
+      table[hash32(load32(ip - 2))] = static_cast<std::uint32_t>(ip - 2 - base) + 1;
+    }
+  }
+  if (!putSequence(anchor, end - anchor, 0, 0, op, op_end)) {
+    return 0;
+  }
+  return op - reinterpret_cast<unsigned char*>(dst);
+}
+
+bool decompressBlock(const char* src, const std::size_t length,
+                     char* dst, const std::size_t dst_length) {
+  const unsigned char* ip = reinterpret_cast<const unsigned char*>(src);
+  const unsigned char* const end = ip + length;
+  unsigned char* const base = reinterpret_cast<unsigned char*>(dst);
+  unsigned char* op = base;
+  unsigned char* const op_end = base + dst_length;
+
+  while (ip < end) {
+    const unsigned char token = *ip++;
+    std::size_t literal_length = token >> 4;
+    if (literal_length == 15 && !getLength(literal_length, ip, end)) {
+      return false;
+    }
+    if (static_cast<std::size_t>(end - ip) < literal_length ||
+        static_cast<std::size_t>(op_end - op) < literal_length) {
+      return false;
+    }
+    if (end - ip >= static_cast<std::ptrdiff_t>(literal_length) + 8 &&
+        op_end - op >= static_cast<std::ptrdiff_t>(literal_length) + 8) {
+      wildCopy(op, ip, literal_length);
+    } else {
+      std::memcpy(op, ip, literal_length);
+    }
+    ip += literal_length;
+    op += literal_length;
+    if (ip == end) {
+      // The last sequence has literals only.
+      break;
+    }
+
+    if (end - ip < 2) {
+      return false;
+    }
+    const std::size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    std::size_t match_length = token & 15;
+    if (match_length == 15 && !getLength(match_length, ip, end)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<std::size_t>(op - base) ||
+        static_cast<std::size_t>(op_end - op) < match_length) {
+      return false;
+    }
+    const unsigned char* match = op - offset;
+    if (offset >= 8 &&
+        op_end - op >= static_cast<std::ptrdiff_t>(match_length) + 8) {
+      wildCopy(op, match, match_length);
+      op += match_length;
+    } else if (op_end - op >= static_cast<std::ptrdiff_t>(match_length) + 8) {
+      // The match overlaps the bytes it produces and repeats with period
+      // <offset>.  Lay down the first eight bytes one at a time, then copy
+      // from a multiple of the period at least eight bytes back.
+      std::size_t period = offset;
+      while (period < 8) {
+        period += offset;
+      }
+      for (int i = 0; i < 8; ++i) {
+        op[i] = match[i];
+      }
+      if (match_length > 8) {
+        wildCopy(op + 8, op + 8 - period, match_length - 8);
+      }
+      op += match_length;
+    } else if (offset >= match_length) {
+      std::memcpy(op, match, match_length);
+      op += match_length;
+    } else {
+      // Overlapping copy repeats the last <offset> bytes.
+      for (std::size_t i = 0; i < match_length; ++i) {
+        *op++ = *match++;
+      }
+    }
+  }
+  return op == op_end;
+}
+
+}
@@ -0,0 +1,45 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace badgerdb {
+
+/**
+ * Compresses a block of at most 64 KB with a fast LZ77 compressor.
+ *
+ * The output is a sequence of (literal run, back reference) pairs in the LZ4
+ * block layout: a token byte holding the literal and match lengths, extra
+ * length bytes, the literals and a 16-bit match offset.  It favours speed over
+ * ratio and does well on text and on the zero-filled free space of pages.
+ *
+ * @param src       Bytes to compress.
+ * @param length    Number of bytes; at most 65536.
+ * @param dst       Buffer receiving the compressed bytes.
+ * @param capacity  Size of <dst>.
+ * @return  Number of compressed bytes, or 0 if the output does not fit in
+ *          <capacity> bytes.
+ */
+std::size_t compressBlock(const char* src, const std::size_t length,
+                          char* dst, const std::size_t capacity);
+
+/**
+ * Decompresses a block produced by compressBlock().
+ *
+ * @param src         Compressed bytes.
+ * @param length      Number of compressed bytes.
+ * @param dst         Buffer receiving the decompressed bytes.
+ * @param dst_length  Exact length of the decompressed block.
+ * @return  True if the block decompressed to exactly <dst_length> bytes;
+ *          false if it is malformed.  <dst> is undefined on failure.
+ */
+bool decompressBlock(const char* src, const std::size_t length,
+                     char* dst, const std::size_t dst_length);
+
+}
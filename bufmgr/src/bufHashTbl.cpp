@@ -15,90 +15,120 @@
 
 namespace badgerdb {
 
-int BufHashTbl::hash(const File* file, const PageId pageNo)
+template <std::size_t PageSize>
+int BasicBufHashTbl<PageSize>::hash(const int htSize, const File* file, const PageId pageNo)
 {
-  int tmp, value;
-  tmp = (long)file;  // cast of pointer to the file object to an integer
-  value = (tmp + pageNo) % HTSIZE;
+  std::uintptr_t tmp;
+  int value;
+  tmp = (std::uintptr_t)file;  // cast of pointer to the file object to an integer
+  value = (int)((tmp + pageNo) % htSize);
   return value;
 }
 
-BufHashTbl::BufHashTbl(int htSize)
-	: HTSIZE(htSize)
+template <std::size_t PageSize>
+typename BasicBufHashTbl<PageSize>::Buckets* BasicBufHashTbl<PageSize>::newBuckets(const int htSize)
 {
   // allocate an array of pointers to hashBuckets
-  ht = new hashBucket* [htSize];
-  for(int i=0; i < HTSIZE; i++)
-    ht[i] = NULL;
+  Buckets* table = new Buckets();
+  table->HTSIZE = htSize;
+  table->ht = new std::atomic<hashBucket<PageSize>*> [htSize];
+  for(int i=0; i < htSize; i++)
+    table->ht[i].store(NULL, std::memory_order_relaxed);
+  return table;
 }
 
-BufHashTbl::~BufHashTbl()
+template <std::size_t PageSize>
+BasicBufHashTbl<PageSize>::BasicBufHashTbl(int htSize, EpochManager* epochs)
+	: buckets(newBuckets(htSize)), epochs(epochs)
 {
-  for(int i = 0; i < HTSIZE; i++) {
-    hashBucket* tmpBuf = ht[i];
-    while (ht[i]) {
-      tmpBuf = ht[i];
-      ht[i] = ht[i]->next;
+}
+
+template <std::size_t PageSize>
+BasicBufHashTbl<PageSize>::~BasicBufHashTbl()
+{
+  Buckets* table = buckets.load(std::memory_order_relaxed);
+  for(int i = 0; i < table->HTSIZE; i++) {
+    hashBucket<PageSize>* tmpBuf = table->ht[i];
+    while (tmpBuf) {
+      hashBucket<PageSize>* next = tmpBuf->next;
       delete tmpBuf;
+      tmpBuf = next;
     }
   }
-  delete [] ht;
+  delete table;
 }
 
-void BufHashTbl::insert(const File* file, const PageId pageNo, const FrameId frameNo)
+template <std::size_t PageSize>
+void BasicBufHashTbl<PageSize>::insert(const File* file, const PageId pageNo, const FrameId frameNo)
 {
-  int index = hash(file, pageNo);
+  Buckets* table = buckets.load(std::memory_order_relaxed);
+  int index = hash(table->HTSIZE, file, pageNo);
 
-  hashBucket* tmpBuc = ht[index];
+  hashBucket<PageSize>* tmpBuc = table->ht[index];
   while (tmpBuc) {
     if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
   		throw HashAlreadyPresentException(tmpBuc->file->filename(), tmpBuc->pageNo, tmpBuc->frameNo);
     tmpBuc = tmpBuc->next;
   }
 
-  tmpBuc = new hashBucket;
+  tmpBuc = new hashBucket<PageSize>;
   if (!tmpBuc)
   	throw HashTableException();
 
   tmpBuc->file = (File*) file;
   tmpBuc->pageNo = pageNo;
   tmpBuc->frameNo = frameNo;
-  tmpBuc->next = ht[index];
-  ht[index] = tmpBuc;
+  tmpBuc->next.store(table->ht[index], std::memory_order_relaxed);
+  // Published complete to readers in find().
+  table->ht[index].store(tmpBuc, std::memory_order_release);
 }
 
-void BufHashTbl::lookup(const File* file, const PageId pageNo, FrameId &frameNo) 
+template <std::size_t PageSize>
+void BasicBufHashTbl<PageSize>::lookup(const File* file, const PageId pageNo, FrameId &frameNo) 
 {
-  int index = hash(file, pageNo);
-  hashBucket* tmpBuc = ht[index];
+  if (!find(file, pageNo, frameNo))
+    throw HashNotFoundException(file->filename(), pageNo);
+}
+
+template <std::size_t PageSize>
+bool BasicBufHashTbl<PageSize>::find(const File* file, const PageId pageNo, FrameId &frameNo) const
+{
+  const Buckets* table = buckets.load(std::memory_order_acquire);
+  int index = hash(table->HTSIZE, file, pageNo);
+  hashBucket<PageSize>* tmpBuc = table->ht[index].load(std::memory_order_acquire);
   while (tmpBuc) {
     if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
     {
       frameNo = tmpBuc->frameNo; // return frameNo by reference
-      return;
+      return true;
     }
-    tmpBuc = tmpBuc->next;
+    tmpBuc = tmpBuc->next.load(std::memory_order_acquire);
   }
-
-  throw HashNotFoundException(file->filename(), pageNo);
+  return false;
 }
 
-void BufHashTbl::remove(const File* file, const PageId pageNo) {
+template <std::size_t PageSize>
+void BasicBufHashTbl<PageSize>::remove(const File* file, const PageId pageNo) {
 
-  int index = hash(file, pageNo);
-  hashBucket* tmpBuc = ht[index];
-  hashBucket* prevBuc = NULL;
+  Buckets* table = buckets.load(std::memory_order_relaxed);
+  int index = hash(table->HTSIZE, file, pageNo);
+  hashBucket<PageSize>* tmpBuc = table->ht[index];
+  hashBucket<PageSize>* prevBuc = NULL;
 
   while (tmpBuc)
 	{
     if (tmpBuc->file == file && tmpBuc->pageNo == pageNo)
 		{
+      // The entry keeps its link, so a reader standing on it still reaches the rest of the chain.
       if(prevBuc) 
-				prevBuc->next = tmpBuc->next;
+				prevBuc->next.store(tmpBuc->next, std::memory_order_release);
       else
-				ht[index] = tmpBuc->next;
+				table->ht[index].store(tmpBuc->next, std::memory_order_release);
 
-      delete tmpBuc;
+      if (epochs)
+        epochs->retire(tmpBuc);
+      else
+        delete tmpBuc;
       return;
     }
 		else
@@ -111,4 +141,33 @@ void BufHashTbl::remove(const File* file, const PageId pageNo) {
   throw HashNotFoundException(file->filename(), pageNo);
 }
 
+template <std::size_t PageSize>
+void BasicBufHashTbl<PageSize>::resize(const int htSize)
+{
+  Buckets* oldTable = buckets.load(std::memory_order_relaxed);
+  Buckets* table = newBuckets(htSize);
+
+  // relink the existing buckets; no entry is copied or reallocated.  A reader following a moved
+  // entry ends up in its new chain, which only leads to entries moved before it.
+  for(int i = 0; i < oldTable->HTSIZE; i++) {
+    while (oldTable->ht[i]) {
+      hashBucket<PageSize>* tmpBuc = oldTable->ht[i];
+      oldTable->ht[i].store(tmpBuc->next, std::memory_order_relaxed);
+      const int index = hash(htSize, tmpBuc->file, tmpBuc->pageNo);
+      tmpBuc->next.store(table->ht[index], std::memory_order_release);
+      table->ht[index].store(tmpBuc, std::memory_order_relaxed);
+    }
+  }
+  buckets.store(table, std::memory_order_release);
+  if (epochs)
+    epochs->retire(oldTable);
+  else
+    delete oldTable;
+}
+
+#define BADGERDB_INSTANTIATE_BUF_HASH_TBL(size) \
+  template class BasicBufHashTbl<size>;
+BADGERDB_FOR_EACH_PAGE_SIZE(BADGERDB_INSTANTIATE_BUF_HASH_TBL)
+#undef BADGERDB_INSTANTIATE_BUF_HASH_TBL
+
 }
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <atomic>
+
+#include "epoch_manager.h"
 #include "file.h"
 
 namespace badgerdb {
@@ -14,11 +17,12 @@ namespace badgerdb {
 /**
 * @brief Declarations for buffer pool hash table
 */
+template <std::size_t PageSize>
 struct hashBucket {
 	/**
 	 * pointer a file object (more on this below)
 	 */
-	File *file;
+	BasicFile<PageSize> *file;
 
 	/**
 	 * page number within a file
@@ -31,48 +35,91 @@ struct hashBucket {
 	FrameId frameNo;
 
 	/**
-	 * Next node in the hash table
+	 * Next node in the hash table; read without the latch by find()
 	 */
-	hashBucket*   next;
+	std::atomic<hashBucket<PageSize>*>   next;
 };
 
 
 /**
 * @brief Hash table class to keep track of pages in the buffer pool
 *
+* Changes must be made under a lock.  With an EpochManager, find() may run without it inside an
+* epoch: removed entries and replaced bucket arrays are retired to the manager instead of deleted,
+* so a reader never follows a link into freed memory.
+*
 * @warning This class is not threadsafe.
 */
-class BufHashTbl
+template <std::size_t PageSize>
+class BasicBufHashTbl
 {
+ public:
+	/**
+	 * Type of the files whose pages are tracked by this table
+	 */
+	typedef BasicFile<PageSize> File;
+
  private:
 	/**
-	 *	Size of Hash Table
+	 * Bucket heads and their number, replaced together by resize()
 	 */
-  int HTSIZE;
+  struct Buckets
+  {
+		/**
+		 *	Size of Hash Table
+		 */
+		int HTSIZE;
+
+		/**
+		 * Head of each bucket's chain
+		 */
+		std::atomic<hashBucket<PageSize>*>* ht;
+
+		~Buckets()
+		{
+			delete [] ht;
+		}
+  };
+
 	/**
 	 * Actual Hash table object
 	 */
-  hashBucket**  ht;
+  std::atomic<Buckets*> buckets;
+
+	/**
+	 * Manager removed entries are retired to, or NULL to delete them at once
+	 */
+  EpochManager* epochs;
+
+	/**
+	 * Allocate a table of empty buckets
+	 */
+  static Buckets* newBuckets(const int htSize);
 
 	/**
-	 * returns hash value between 0 and HTSIZE-1 computed using file and pageNo
+	 * returns hash value between 0 and htSize-1 computed using file and pageNo
 	 *
+	 * @param htSize	Number of buckets
 	 * @param file   	File object
 	 * @param pageNo  Page number in the file
 	 * @return  			Hash value.
 	 */
-  int	 hash(const File* file, const PageId pageNo);
+  static int hash(const int htSize, const File* file, const PageId pageNo);
 
  public:
 	/**
    * Constructor of BufHashTbl class
+	 *
+	 * @param htSize	Number of buckets
+	 * @param epochs	Manager to retire removed entries to, for readers using find(); NULL if there
+	 * 					are none
 	 */
-	BufHashTbl(const int htSize);  // constructor
+	BasicBufHashTbl(const int htSize, EpochManager* epochs = NULL);  // constructor
 
 	/**
    * Destructor of BufHashTbl class
 	 */
-  ~BufHashTbl(); // destructor
+  ~BasicBufHashTbl(); // destructor
 	
 	/**
    * Insert entry into hash table mapping (file, pageNo) to frameNo.
@@ -96,6 +143,17 @@ class BufHashTbl
 	 */
   void lookup(const File* file, const PageId pageNo, FrameId &frameNo);
 
+	/**
+   * lookup() for readers that do not hold the lock, called inside an epoch of the table's
+   * EpochManager.  May miss an entry while resize() is moving it.
+	 *
+	 * @param file  	File object
+	 * @param pageNo	Page number in the file
+	 * @param frameNo Frame number reference
+	 * @return False if the page entry was not found
+	 */
+  bool find(const File* file, const PageId pageNo, FrameId &frameNo) const;
+
 	/**
    * Delete entry (file,pageNo) from hash table.
 	 *
@@ -104,6 +162,18 @@ class BufHashTbl
    * @throws HashNotFoundException if the page entry is not found in the hash table 
 	 */
   void remove(const File* file, const PageId pageNo);  
+
+	/**
+   * Change the number of buckets, moving every entry to its bucket in the new table.
+	 *
+	 * @param htSize	New number of buckets
+	 */
+  void resize(const int htSize);
 };
 
+/**
+* @brief Hash table for pages of the default page size
+*/
+typedef BasicBufHashTbl<DEFAULT_PAGE_SIZE> BufHashTbl;
+
 }
@@ -0,0 +1,122 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "buf_pool_registry.h"
+#include "exceptions/buffer_pool_exists_exception.h"
+#include "exceptions/buffer_pool_not_found_exception.h"
+
+namespace badgerdb {
+
+template <std::size_t PageSize>
+const char* const BasicBufPoolRegistry<PageSize>::DEFAULT_POOL = "default";
+
+template <std::size_t PageSize>
+BasicBufPoolRegistry<PageSize>::BasicBufPoolRegistry(const std::uint32_t defaultFrames,
+                                                     const BufPoolPolicy defaultPolicy)
+{
+	createPool(DEFAULT_POOL, defaultFrames, defaultPolicy);
+	defaultPool = pools[DEFAULT_POOL];
+}
+
+template <std::size_t PageSize>
+BasicBufPoolRegistry<PageSize>::~BasicBufPoolRegistry()
+{
+	for (typename std::map<std::string, BufMgr*>::iterator it = pools.begin(); it != pools.end(); ++it)
+		delete it->second;
+}
+
+template <std::size_t PageSize>
+void BasicBufPoolRegistry<PageSize>::createPool(const std::string& name, const std::uint32_t frames,
+                                                const BufPoolPolicy policy)
+{
+	if (pools.find(name) != pools.end())
+		throw BufferPoolExistsException(name);
+	BufMgr* bufMgr = new BufMgr(frames);
+	bufMgr->setPolicy(policy);
+	pools[name] = bufMgr;
+}
+
+template <std::size_t PageSize>
+typename BasicBufPoolRegistry<PageSize>::BufMgr& BasicBufPoolRegistry<PageSize>::pool(const std::string& name)
+{
+	const typename std::map<std::string, BufMgr*>::iterator it = pools.find(name);
+	if (it == pools.end())
+		throw BufferPoolNotFoundException(name);
+	return *it->second;
+}
+
+template <std::size_t PageSize>
+std::vector<std::string> BasicBufPoolRegistry<PageSize>::poolNames() const
+{
+	std::vector<std::string> names;
+	for (typename std::map<std::string, BufMgr*>::const_iterator it = pools.begin(); it != pools.end(); ++it)
+		names.push_back(it->first);
+	return names;
+}
+
+template <std::size_t PageSize>
+void BasicBufPoolRegistry<PageSize>::bindFile(File* file, const std::string& name)
+{
+	BufMgr& newPool = pool(name);
+	BufMgr& oldPool = poolFor(file);
+	if (&newPool == &oldPool)
+		return;
+	// Move the file's pages out of the old pool so the two pools never cache the same page.
+	oldPool.flushFile(file);
+	if (&newPool == defaultPool)
+		bindings.erase(file->filename());
+	else
+		bindings[file->filename()] = &newPool;
+}
+
+template <std::size_t PageSize>
+const std::string& BasicBufPoolRegistry<PageSize>::poolNameFor(const File* file) const
+{
+	const typename std::unordered_map<std::string, BufMgr*>::const_iterator binding = bindings.find(file->filename());
+	const BufMgr* bufMgr = binding == bindings.end() ? defaultPool : binding->second;
+	typename std::map<std::string, BufMgr*>::const_iterator it = pools.begin();
+	while (it->second != bufMgr)
+		++it;
+	return it->first;
+}
+
+template <std::size_t PageSize>
+std::map<std::string, BufStats> BasicBufPoolRegistry<PageSize>::getBufStats() const
+{
+	std::map<std::string, BufStats> stats;
+	for (typename std::map<std::string, BufMgr*>::const_iterator it = pools.begin(); it != pools.end(); ++it)
+		stats[it->first] = it->second->getBufStats();
+	return stats;
+}
+
+template <std::size_t PageSize>
+void BasicBufPoolRegistry<PageSize>::clearBufStats()
+{
+	for (typename std::map<std::string, BufMgr*>::iterator it = pools.begin(); it != pools.end(); ++it)
+		it->second->clearBufStats();
+}
+
+template <std::size_t PageSize>
+void BasicBufPoolRegistry<PageSize>::dumpStats(std::ostream& out) const
+{
+	out << "{\n";
+	for (typename std::map<std::string, BufMgr*>::const_iterator it = pools.begin(); it != pools.end(); ++it)
+	{
+		if (it != pools.begin())
+			out << ",\n";
+		writeJsonString(out, it->first);
+		out << ": ";
+		it->second->getBufStats().dump(out);
+	}
+	out << "}\n";
+}
+
+#define BADGERDB_INSTANTIATE_BUF_POOL_REGISTRY(size) template class BasicBufPoolRegistry<size>;
+BADGERDB_FOR_EACH_PAGE_SIZE(BADGERDB_INSTANTIATE_BUF_POOL_REGISTRY)
+#undef BADGERDB_INSTANTIATE_BUF_POOL_REGISTRY
+
+}
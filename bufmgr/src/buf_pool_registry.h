@@ -0,0 +1,228 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer.h"
+
+namespace badgerdb {
+
+/**
+* @brief A set of named buffer pools, with each file bound to one of them
+*
+* Giving a small, latency-critical file its own pool keeps a large file that is scanned or
+* appended to from evicting its pages.  The registry starts with one pool, named
+* DEFAULT_POOL, which serves every file not bound to another pool.  readPage, allocPage and
+* the other buffer manager calls are routed to the pool the file is bound to.  Bindings are by
+* file name, so every File object open on a file uses the same pool.
+*
+* A typical setup is a "keep" pool with the BUF_POOL_KEEP policy for lookup tables and a
+* "recycle" pool with the BUF_POOL_RECYCLE policy for files that are mostly scanned.
+*/
+template <std::size_t PageSize>
+class BasicBufPoolRegistry
+{
+ public:
+	/**
+	 * Type of the buffer pools
+	 */
+	typedef BasicBufMgr<PageSize> BufMgr;
+
+	/**
+	 * Type of the pages held in the buffer pools
+	 */
+	typedef BasicPage<PageSize> Page;
+
+	/**
+	 * Type of the files whose pages are cached
+	 */
+	typedef BasicFile<PageSize> File;
+
+	/**
+	 * Type of the handles returned by readPage and allocPage
+	 */
+	typedef BasicPageHandle<PageSize> PageHandle;
+
+	/**
+	 * Name of the pool serving files that are not bound to a pool
+	 */
+	static const char* const DEFAULT_POOL;
+
+	/**
+	 * Constructor of BufPoolRegistry class.  Creates the default pool.
+	 *
+	 * @param defaultFrames	Number of frames in the default pool
+	 * @param defaultPolicy	Replacement policy of the default pool
+	 */
+  BasicBufPoolRegistry(const std::uint32_t defaultFrames,
+                       const BufPoolPolicy defaultPolicy = BUF_POOL_DEFAULT);
+
+	/**
+	 * Destructor of BufPoolRegistry class.  Destroys every pool, writing back dirty pages.
+	 */
+  ~BasicBufPoolRegistry();
+
+	/**
+	 * Create a pool.
+	 *
+	 * @param name		Name of the pool
+	 * @param frames	Number of frames in the pool
+	 * @param policy	Replacement policy of the pool
+	 * @throws BufferPoolExistsException If a pool with this name exists
+	 */
+  void createPool(const std::string& name, const std::uint32_t frames, const BufPoolPolicy policy);
+
+	/**
+	 * Get a pool by name, e.g. to resize it or read its statistics.
+	 *
+	 * @param name		Name of the pool
+	 * @throws BufferPoolNotFoundException If there is no pool with this name
+	 */
+  BufMgr& pool(const std::string& name);
+
+	/**
+	 * Get the names of all pools, in alphabetical order.
+	 */
+  std::vector<std::string> poolNames() const;
+
+	/**
+	 * Bind a file to a pool, so that its pages are cached there from now on.  Pages of the file
+	 * cached through this File object in its previous pool are written back and evicted from it.
+	 *
+	 * @param file		File object
+	 * @param name		Name of the pool
+	 * @throws BufferPoolNotFoundException If there is no pool with this name
+	 * @throws PagePinnedException If a page of the file is pinned in its previous pool
+	 */
+  void bindFile(File* file, const std::string& name);
+
+	/**
+	 * Get the pool a file's pages are cached in.
+	 *
+	 * @param file		File object
+	 */
+  BufMgr& poolFor(const File* file)
+  {
+		if (bindings.empty())
+			return *defaultPool;
+		const typename std::unordered_map<std::string, BufMgr*>::const_iterator it = bindings.find(file->filename());
+		return it == bindings.end() ? *defaultPool : *it->second;
+  }
+
+	/**
+	 * Get the name of the pool a file's pages are cached in.
+	 *
+	 * @param file		File object
+	 */
+  const std::string& poolNameFor(const File* file) const;
+
+	/**
+	 * BufMgr::readPage on the file's pool.
+	 */
+  void readPage(File* file, const PageId pageNo, Page*& page)
+  {
+		poolFor(file).readPage(file, pageNo, page);
+  }
+
+	/**
+	 * BufMgr::readPage returning a PageHandle, on the file's pool.
+	 */
+  PageHandle readPage(File* file, const PageId pageNo)
+  {
+		return poolFor(file).readPage(file, pageNo);
+  }
+
+	/**
+	 * BufMgr::unPinPage on the file's pool.
+	 */
+  void unPinPage(File* file, const PageId pageNo, const bool dirty)
+  {
+		poolFor(file).unPinPage(file, pageNo, dirty);
+  }
+
+	/**
+	 * BufMgr::allocPage on the file's pool.
+	 */
+  void allocPage(File* file, PageId& pageNo, Page*& page)
+  {
+		poolFor(file).allocPage(file, pageNo, page);
+  }
+
+	/**
+	 * BufMgr::allocPage returning a PageHandle, on the file's pool.
+	 */
+  PageHandle allocPage(File* file, PageId& pageNo)
+  {
+		return poolFor(file).allocPage(file, pageNo);
+  }
+
+	/**
+	 * BufMgr::flushFile on the file's pool.
+	 */
+  void flushFile(const File* file)
+  {
+		poolFor(file).flushFile(file);
+  }
+
+	/**
+	 * BufMgr::disposePage on the file's pool.
+	 */
+  void disposePage(File* file, const PageId pageNo)
+  {
+		poolFor(file).disposePage(file, pageNo);
+  }
+
+	/**
+	 * Get the usage statistics of every pool, by pool name.
+	 */
+  std::map<std::string, BufStats> getBufStats() const;
+
+	/**
+	 * Clear the usage statistics of every pool.
+	 */
+  void clearBufStats();
+
+	/**
+	 * Write the usage statistics of every pool as a JSON object keyed by pool name, each value
+	 * as written by BufStats::dump().
+	 *
+	 * @param out	Stream to write to
+	 */
+  void dumpStats(std::ostream& out) const;
+
+ private:
+  BasicBufPoolRegistry(const BasicBufPoolRegistry&);
+  BasicBufPoolRegistry& operator=(const BasicBufPoolRegistry&);
+
+	/**
+	 * Pools by name
+	 */
+  std::map<std::string, BufMgr*> pools;
+
+	/**
+	 * Pool of each bound file, by file name
+	 */
+  std::unordered_map<std::string, BufMgr*> bindings;
+
+	/**
+	 * Pool serving files that are not bound
+	 */
+  BufMgr* defaultPool;
+};
+
+/**
+* @brief Buffer pool registry for pages of the default page size
+*/
+typedef BasicBufPoolRegistry<DEFAULT_PAGE_SIZE> BufPoolRegistry;
+
+}
@@ -0,0 +1,247 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "buf_stats.h"
+
+namespace badgerdb {
+
+void writeJsonString(std::ostream& out, const std::string& value)
+{
+	out << '"';
+	for (std::size_t i = 0; i < value.size(); i++) {
+		const unsigned char c = value[i];
+		if (c == '"' || c == '\\') {
+			out << '\\' << c;
+		} else if (c < 0x20) {
+			static const char hex[] = "0123456789abcdef";
+			out << "\\u00" << hex[c >> 4] << hex[c & 15];
+		} else {
+			out << c;
+		}
+	}
+	out << '"';
+}
+
+namespace {
+
+std::atomic<std::uint64_t> nextCollectorId(1);
+
+void dumpHistogram(std::ostream& out, const char* name,
+                   const LatencyHistogram& histogram, const char* indent = "    ")
+{
+	out << indent << "\"" << name << "\": {\"count\": " << histogram.count()
+	    << ", \"mean\": " << histogram.mean()
+	    << ", \"min\": " << histogram.min()
+	    << ", \"p50\": " << histogram.percentile(0.5)
+	    << ", \"p90\": " << histogram.percentile(0.9)
+	    << ", \"p99\": " << histogram.percentile(0.99)
+	    << ", \"p999\": " << histogram.percentile(0.999)
+	    << ", \"max\": " << histogram.max()
+	    << ", \"buckets\": [";
+	bool first = true;
+	for (std::size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+		const std::uint64_t n = histogram.bucketCount(i);
+		if (n != 0) {
+			out << (first ? "" : ", ") << "[" << LatencyHistogram::bucketLowerBound(i) << ", " << n << "]";
+			first = false;
+		}
+	}
+	out << "]}";
+}
+
+}
+
+void BufStats::clear()
+{
+	accesses = hits = misses = diskreads = diskwrites = 0;
+	evictions = dirtyEvictions = sweepSteps = sweeps = 0;
+	checkpoints = checkpointWrites = 0;
+	versionsCreated = versionReads = versionsReclaimed = 0;
+	optimisticReads = optimisticRetries = optimisticFallbacks = 0;
+	localAccesses = remoteAccesses = 0;
+	readPageLatency.clear();
+	allocPageLatency.clear();
+	unPinPageLatency.clear();
+	flushFileLatency.clear();
+	sweepLength.clear();
+	files.clear();
+	heat.clear();
+	workingSet.clear();
+}
+
+void BufStats::dump(std::ostream& out) const
+{
+	out << "{\n"
+	    << "  \"accesses\": " << accesses << ",\n"
+	    << "  \"hits\": " << hits << ",\n"
+	    << "  \"misses\": " << misses << ",\n"
+	    << "  \"diskreads\": " << diskreads << ",\n"
+	    << "  \"diskwrites\": " << diskwrites << ",\n"
+	    << "  \"evictions\": " << evictions << ",\n"
+	    << "  \"dirty_evictions\": " << dirtyEvictions << ",\n"
+	    << "  \"sweep_steps\": " << sweepSteps << ",\n"
+	    << "  \"sweeps\": " << sweeps << ",\n"
+	    << "  \"checkpoints\": " << checkpoints << ",\n"
+	    << "  \"checkpoint_writes\": " << checkpointWrites << ",\n"
+	    << "  \"versions_created\": " << versionsCreated << ",\n"
+	    << "  \"version_reads\": " << versionReads << ",\n"
+	    << "  \"versions_reclaimed\": " << versionsReclaimed << ",\n"
+	    << "  \"optimistic_reads\": " << optimisticReads << ",\n"
+	    << "  \"optimistic_retries\": " << optimisticRetries << ",\n"
+	    << "  \"optimistic_fallbacks\": " << optimisticFallbacks << ",\n"
+	    << "  \"local_accesses\": " << localAccesses << ",\n"
+	    << "  \"remote_accesses\": " << remoteAccesses << ",\n";
+	dumpHistogram(out, "sweep_length", sweepLength, "  ");
+	out << ",\n"
+	    << "  \"latency_ns\": {\n";
+	dumpHistogram(out, "read_page", readPageLatency);
+	out << ",\n";
+	dumpHistogram(out, "alloc_page", allocPageLatency);
+	out << ",\n";
+	dumpHistogram(out, "unpin_page", unPinPageLatency);
+	out << ",\n";
+	dumpHistogram(out, "flush_file", flushFileLatency);
+	out << "\n  },\n"
+	    << "  \"files\": {";
+	for (std::map<std::string, FileBufStats>::const_iterator it = files.begin(); it != files.end(); ++it) {
+		out << (it == files.begin() ? "\n    " : ",\n    ");
+		writeJsonString(out, it->first);
+		out << ": {\"resident\": " << it->second.resident
+		    << ", \"dirty\": " << it->second.dirty
+		    << ", \"hits\": " << it->second.hits
+		    << ", \"misses\": " << it->second.misses
+		    << ", \"writes\": " << it->second.writes << "}";
+	}
+	out << (files.empty() ? "},\n" : "\n  },\n")
+	    << "  \"heat\": [";
+	for (std::size_t i = 0; i < heat.size(); i++) {
+		out << (i == 0 ? "" : ", ") << heat[i];
+	}
+	out << "],\n"
+	    << "  \"working_set\": [";
+	for (std::size_t i = 0; i < workingSet.size(); i++) {
+		out << (i == 0 ? "" : ", ") << "{\"window\": " << workingSet[i].window
+		    << ", \"pages\": " << workingSet[i].pages << "}";
+	}
+	out << "]\n}\n";
+}
+
+BufStatsShard::BufStatsShard()
+: nanosPerTick(latencyClockNanosPerTick())
+{
+	clear();
+}
+
+void BufStatsShard::clear()
+{
+	std::atomic<std::uint64_t>* counters[] = {&accesses, &hits, &misses, &diskreads, &diskwrites,
+	                                          &evictions, &dirtyEvictions, &sweepSteps, &sweeps,
+	                                          &checkpoints, &checkpointWrites, &versionsCreated,
+	                                          &versionReads, &versionsReclaimed, &optimisticReads,
+	                                          &optimisticRetries, &optimisticFallbacks, &localAccesses,
+	                                          &remoteAccesses};
+	for (std::size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++) {
+		counters[i]->store(0, std::memory_order_relaxed);
+	}
+	readPageLatency.clear();
+	allocPageLatency.clear();
+	unPinPageLatency.clear();
+	flushFileLatency.clear();
+	sweepLength.clear();
+	std::lock_guard<std::mutex> lock(filesMutex);
+	files.clear();
+}
+
+void BufStatsShard::addTo(BufStats& stats) const
+{
+	stats.accesses += accesses.load(std::memory_order_relaxed);
+	stats.hits += hits.load(std::memory_order_relaxed);
+	stats.misses += misses.load(std::memory_order_relaxed);
+	stats.diskreads += diskreads.load(std::memory_order_relaxed);
+	stats.diskwrites += diskwrites.load(std::memory_order_relaxed);
+	stats.evictions += evictions.load(std::memory_order_relaxed);
+	stats.dirtyEvictions += dirtyEvictions.load(std::memory_order_relaxed);
+	stats.sweepSteps += sweepSteps.load(std::memory_order_relaxed);
+	stats.sweeps += sweeps.load(std::memory_order_relaxed);
+	stats.checkpoints += checkpoints.load(std::memory_order_relaxed);
+	stats.checkpointWrites += checkpointWrites.load(std::memory_order_relaxed);
+	stats.versionsCreated += versionsCreated.load(std::memory_order_relaxed);
+	stats.versionReads += versionReads.load(std::memory_order_relaxed);
+	stats.versionsReclaimed += versionsReclaimed.load(std::memory_order_relaxed);
+	stats.optimisticReads += optimisticReads.load(std::memory_order_relaxed);
+	stats.optimisticRetries += optimisticRetries.load(std::memory_order_relaxed);
+	stats.optimisticFallbacks += optimisticFallbacks.load(std::memory_order_relaxed);
+	stats.localAccesses += localAccesses.load(std::memory_order_relaxed);
+	stats.remoteAccesses += remoteAccesses.load(std::memory_order_relaxed);
+	stats.readPageLatency.add(readPageLatency);
+	stats.allocPageLatency.add(allocPageLatency);
+	stats.unPinPageLatency.add(unPinPageLatency);
+	stats.flushFileLatency.add(flushFileLatency);
+	stats.sweepLength.add(sweepLength);
+	std::lock_guard<std::mutex> lock(filesMutex);
+	for (std::unordered_map<std::string, FileBufStats>::const_iterator it = files.begin(); it != files.end(); ++it) {
+		FileBufStats& file = stats.files[it->first];
+		file.hits += it->second.hits;
+		file.misses += it->second.misses;
+		file.writes += it->second.writes;
+	}
+}
+
+const int BufStatsCollector::CACHE_SIZE;
+thread_local BufStatsCollector::CacheEntry BufStatsCollector::cache[BufStatsCollector::CACHE_SIZE];
+thread_local int BufStatsCollector::cacheNext;
+
+BufStatsCollector::BufStatsCollector()
+: id(nextCollectorId.fetch_add(1))
+{
+	// Calibrate the clock now rather than on the first statistic recorded.
+	latencyClockNanosPerTick();
+}
+
+BufStatsCollector::~BufStatsCollector()
+{
+	for (std::map<std::thread::id, BufStatsShard*>::iterator it = shards.begin(); it != shards.end(); ++it) {
+		delete it->second;
+	}
+}
+
+BufStatsShard& BufStatsCollector::localSlow()
+{
+	BufStatsShard* shard;
+	{
+		std::lock_guard<std::mutex> lock(shardsMutex);
+		BufStatsShard*& slot = shards[std::this_thread::get_id()];
+		if (slot == NULL) {
+			slot = new BufStatsShard();
+		}
+		shard = slot;
+	}
+	cache[cacheNext].owner = id;
+	cache[cacheNext].shard = shard;
+	cacheNext = (cacheNext + 1) % CACHE_SIZE;
+	return *shard;
+}
+
+BufStats BufStatsCollector::snapshot() const
+{
+	BufStats stats;
+	std::lock_guard<std::mutex> lock(shardsMutex);
+	for (std::map<std::thread::id, BufStatsShard*>::const_iterator it = shards.begin(); it != shards.end(); ++it) {
+		it->second->addTo(stats);
+	}
+	return stats;
+}
+
+void BufStatsCollector::clear()
+{
+	std::lock_guard<std::mutex> lock(shardsMutex);
+	for (std::map<std::thread::id, BufStatsShard*>::iterator it = shards.begin(); it != shards.end(); ++it) {
+		it->second->clear();
+	}
+}
+
+}
@@ -0,0 +1,428 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "latency_histogram.h"
+
+namespace badgerdb {
+
+/**
+* Writes a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+*
+* @param out	Stream to write to
+* @param value	String to write
+*/
+void writeJsonString(std::ostream& out, const std::string& value);
+
+/**
+* @brief Buffer usage of one file
+*/
+struct FileBufStats
+{
+	/**
+   * Number of frames holding a page of the file
+	 */
+  std::uint64_t resident;
+
+	/**
+   * Number of those frames that are dirty
+	 */
+  std::uint64_t dirty;
+
+	/**
+   * Number of readPage requests for a resident page of the file
+	 */
+  std::uint64_t hits;
+
+	/**
+   * Number of readPage requests that read a page of the file from disk
+	 */
+  std::uint64_t misses;
+
+	/**
+   * Number of pages of the file written back to disk
+	 */
+  std::uint64_t writes;
+
+	/**
+   * Clear all values
+	 */
+  void clear()
+  {
+		resident = dirty = hits = misses = writes = 0;
+  }
+
+	/**
+   * Constructor of FileBufStats class
+	 */
+  FileBufStats()
+  {
+		clear();
+  }
+};
+
+/**
+* @brief Estimated working set over one window of recent accesses
+*/
+struct WorkingSetPoint
+{
+	/**
+   * Number of most recent accesses
+	 */
+  std::uint64_t window;
+
+	/**
+   * Estimated number of distinct pages referenced in them
+	 */
+  double pages;
+};
+
+/**
+* @brief Class to maintain statistics of buffer usage
+*/
+struct BufStats
+{
+	/**
+   * Total number of readPage and allocPage requests
+	 */
+  std::uint64_t accesses;
+
+	/**
+   * Number of readPage requests for a page already in the buffer pool
+	 */
+  std::uint64_t hits;
+
+	/**
+   * Number of readPage requests that had to read the page from disk
+	 */
+  std::uint64_t misses;
+
+	/**
+   * Number of pages read from disk
+	 */
+  std::uint64_t diskreads;
+
+	/**
+   * Number of pages written back to disk, by eviction or flushFile
+	 */
+  std::uint64_t diskwrites;
+
+	/**
+   * Number of valid pages replaced to make room for another page
+	 */
+  std::uint64_t evictions;
+
+	/**
+   * Number of evicted pages that were dirty and had to be written first
+	 */
+  std::uint64_t dirtyEvictions;
+
+	/**
+   * Number of frames the clock hand examined while looking for a victim
+	 */
+  std::uint64_t sweepSteps;
+
+	/**
+   * Number of sweeps of the clock hand, each looking for a batch of victims
+	 */
+  std::uint64_t sweeps;
+
+	/**
+   * Number of fuzzy checkpoints completed
+	 */
+  std::uint64_t checkpoints;
+
+	/**
+   * Number of dirty pages written back by fuzzy checkpoints; also counted in diskwrites
+	 */
+  std::uint64_t checkpointWrites;
+
+	/**
+   * Number of page images kept for snapshots when an update superseded them
+	 */
+  std::uint64_t versionsCreated;
+
+	/**
+   * Number of snapshot reads served from a kept image rather than the page in its frame
+	 */
+  std::uint64_t versionReads;
+
+	/**
+   * Number of kept images no snapshot needed any more
+	 */
+  std::uint64_t versionsReclaimed;
+
+	/**
+   * Number of optimistic reads that validated
+	 */
+  std::uint64_t optimisticReads;
+
+	/**
+   * Number of optimistic reads retried because the frame changed while they ran
+	 */
+  std::uint64_t optimisticRetries;
+
+	/**
+   * Number of optimistic reads that read the page under the latch instead
+	 */
+  std::uint64_t optimisticFallbacks;
+
+	/**
+   * Number of accesses by a thread on a known NUMA node to a frame of its own node
+	 */
+  std::uint64_t localAccesses;
+
+	/**
+   * Number of accesses by a thread on a known NUMA node to a frame of another node
+	 */
+  std::uint64_t remoteAccesses;
+
+	/**
+   * Latency of readPage calls in nanoseconds
+	 */
+  LatencyHistogram readPageLatency;
+
+	/**
+   * Latency of allocPage calls in nanoseconds
+	 */
+  LatencyHistogram allocPageLatency;
+
+	/**
+   * Latency of unPinPage calls in nanoseconds
+	 */
+  LatencyHistogram unPinPageLatency;
+
+	/**
+   * Latency of flushFile calls in nanoseconds
+	 */
+  LatencyHistogram flushFileLatency;
+
+	/**
+   * Number of frames examined by each sweep of the clock hand (a count, not a latency)
+	 */
+  LatencyHistogram sweepLength;
+
+	/**
+   * Usage of each file that has been used since the statistics were cleared or
+   * has pages in the buffer pool, by file name
+	 */
+  std::map<std::string, FileBufStats> files;
+
+	/**
+   * Resident frames by number of hits since their page was read in: heat[0] counts frames with no
+   * hits and heat[k] frames with 2^(k-1) to 2^k - 1 hits
+	 */
+  std::vector<std::uint64_t> heat;
+
+	/**
+   * Estimated working set over windows of 1, 4, 16 and 64 times the number of frames and over all
+   * accesses since the statistics were cleared
+	 */
+  std::vector<WorkingSetPoint> workingSet;
+
+	/**
+   * Clear all values
+	 */
+  void clear();
+
+	/**
+	 * Writes the counters, sweep length and latency histograms, per-file usage, heat and
+	 * working set estimates as a JSON object.  Each histogram gives its count, mean, min, max, selected
+	 * percentiles and the non-empty buckets as [lower bound, count] pairs.
+	 *
+	 * @param out	Stream to write to
+	 */
+  void dump(std::ostream& out) const;
+
+	/**
+   * Constructor of BufStats class
+	 */
+  BufStats()
+  {
+		clear();
+  }
+};
+
+/**
+* @brief Statistics recorded by one thread
+*
+* Counters are only written by the owning thread, so they are bumped with a
+* plain relaxed load and store instead of a locked add.
+*/
+struct BufStatsShard
+{
+  std::atomic<std::uint64_t> accesses;
+  std::atomic<std::uint64_t> hits;
+  std::atomic<std::uint64_t> misses;
+  std::atomic<std::uint64_t> diskreads;
+  std::atomic<std::uint64_t> diskwrites;
+  std::atomic<std::uint64_t> evictions;
+  std::atomic<std::uint64_t> dirtyEvictions;
+  std::atomic<std::uint64_t> sweepSteps;
+  std::atomic<std::uint64_t> sweeps;
+  std::atomic<std::uint64_t> checkpoints;
+  std::atomic<std::uint64_t> checkpointWrites;
+  std::atomic<std::uint64_t> versionsCreated;
+  std::atomic<std::uint64_t> versionReads;
+  std::atomic<std::uint64_t> versionsReclaimed;
+  std::atomic<std::uint64_t> optimisticReads;
+  std::atomic<std::uint64_t> optimisticRetries;
+  std::atomic<std::uint64_t> optimisticFallbacks;
+  std::atomic<std::uint64_t> localAccesses;
+  std::atomic<std::uint64_t> remoteAccesses;
+  LatencyHistogram readPageLatency;
+  LatencyHistogram allocPageLatency;
+  LatencyHistogram unPinPageLatency;
+  LatencyHistogram flushFileLatency;
+  LatencyHistogram sweepLength;
+
+	/**
+	 * Per-file counters.  The mutex is uncontended except while a snapshot is
+	 * being taken.
+	 */
+  mutable std::mutex filesMutex;
+  std::unordered_map<std::string, FileBufStats> files;
+
+	/**
+	 * Nanoseconds per latencyClockTicks() tick
+	 */
+  double nanosPerTick;
+
+	/**
+	 * Adds to one of this shard's counters
+	 */
+  static void bump(std::atomic<std::uint64_t>& counter, const std::uint64_t amount = 1)
+  {
+		counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+	/**
+	 * Records the time since <startTicks> in a latency histogram
+	 */
+  void recordSince(LatencyHistogram& histogram, const std::uint64_t startTicks)
+  {
+		histogram.record(static_cast<std::uint64_t>((latencyClockTicks() - startTicks) * nanosPerTick));
+  }
+
+	/**
+	 * Adds one to a per-file counter
+	 *
+	 * @param filename	Name of the file
+	 * @param counter	Counter to bump, e.g. &FileBufStats::hits
+	 */
+  void bumpFile(const std::string& filename, std::uint64_t FileBufStats::* counter)
+  {
+		std::lock_guard<std::mutex> lock(filesMutex);
+		files[filename].*counter += 1;
+  }
+
+  void clear();
+
+	/**
+	 * Adds this shard's values to a snapshot
+	 */
+  void addTo(BufStats& stats) const;
+
+  BufStatsShard();
+};
+
+/**
+* @brief Per-thread buffer statistics, merged on read
+*
+* Each thread that uses a buffer manager gets its own BufStatsShard, found
+* through a small thread-local cache, so recording a statistic never touches a
+* cache line another thread writes.  Shards outlive their threads so that
+* nothing recorded is lost.
+*/
+class BufStatsCollector
+{
+ public:
+  BufStatsCollector();
+  ~BufStatsCollector();
+
+	/**
+	 * Returns the calling thread's shard
+	 */
+  BufStatsShard& local()
+  {
+		for (int i = 0; i < CACHE_SIZE; i++) {
+			if (cache[i].owner == id) {
+				return *cache[i].shard;
+			}
+		}
+		return localSlow();
+  }
+
+	/**
+	 * Returns the sum of all shards
+	 */
+  BufStats snapshot() const;
+
+	/**
+	 * Clears all shards.  Values being recorded concurrently may be lost.
+	 */
+  void clear();
+
+ private:
+  BufStatsCollector(const BufStatsCollector&);
+  BufStatsCollector& operator=(const BufStatsCollector&);
+
+	/**
+	 * Number of collectors each thread remembers its shard for
+	 */
+  static const int CACHE_SIZE = 4;
+
+	/**
+	 * Thread-local mapping from collector to shard
+	 */
+  struct CacheEntry
+  {
+		std::uint64_t owner;
+		BufStatsShard* shard;
+  };
+
+  static thread_local CacheEntry cache[CACHE_SIZE];
+
+	/**
+	 * Next cache entry to replace
+	 */
+  static thread_local int cacheNext;
+
+	/**
+	 * Finds or creates the calling thread's shard and caches it
+	 */
+  BufStatsShard& localSlow();
+
+	/**
+	 * Unique, never reused identifier of this collector; never 0, which marks an
+	 * empty cache entry
+	 */
+  const std::uint64_t id;
+
+	/**
+	 * Protects shards
+	 */
+  mutable std::mutex shardsMutex;
+
+	/**
+	 * Shard of each thread that has recorded statistics
+	 */
+  std::map<std::thread::id, BufStatsShard*> shards;
+};
+
+}
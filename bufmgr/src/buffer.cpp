@@ -6,8 +6,11 @@
  */
 
 
+#include <algorithm>
 #include <memory>
 #include <iostream>
+#include <new>
+#include <thread>
 #include "buffer.h"
 #include "exceptions/buffer_exceeded_exception.h"
 #include "exceptions/page_not_pinned_exception.h"
@@ -15,10 +18,13 @@
 #include "exceptions/bad_buffer_exception.h"
 #include "exceptions/hash_not_found_exception.h"
 #include "exceptions/hash_already_present_exception.h"
+#include "exceptions/invalid_pool_size_exception.h"
+#include "exceptions/badgerdb_exception.h"
 
 namespace badgerdb { 
 
-BufMgr::BufMgr(std::uint32_t bufs)
+template <std::size_t PageSize>
+BasicBufMgr<PageSize>::BasicBufMgr(std::uint32_t bufs)
 : numBufs(bufs) {
 	bufDescTable = new BufDesc[bufs];
 
@@ -27,135 +33,903 @@ BufMgr::BufMgr(std::uint32_t bufs)
 		bufDescTable[i].valid = false;
 	}
 
-	bufPool = new Page[bufs];
+	bufPool = new Page*[bufs];
+	for (FrameId i = 0; i < bufs; i++)
+		bufPool[i] = NULL;
 
-	int htsize = ((((int) (bufs * 1.2))*2)/2)+1;
-	hashTable = new BufHashTbl (htsize);  // allocate the buffer hash table
+	// Popped from the back, so frames are handed out in order.
+	freeFrames.reserve(bufs);
+	for (FrameId i = bufs; i > 0; i--)
+		freeFrames.push_back(i - 1);
 
-	clockHand = bufs - 1;
+	hashTable = new BufHashTbl (hashTableSize(bufs), &epochs);  // allocate the buffer hash table
+
+	clockHand = 0;
+	sweepers = 0;
+	policy = BUF_POOL_DEFAULT;
+
+	trace = NULL;
+	log = NULL;
+	doubleWrite = NULL;
+	checkpointerStop = false;
+	commitClock = 0;
+	frameLatches = newFrameLatches(bufs);
+	numa = NULL;
+	numaNodes = 1;
+	sparePages.resize(1);
+	const PageHome home = {this, 0};
+	pageHomes.push_back(home);
 }
 
 
-BufMgr::~BufMgr() {
+template <std::size_t PageSize>
+BasicBufMgr<PageSize>::~BasicBufMgr() {
 
 	/*
 	 * deallocates bufDescTable, hashTable and the bufPool, which is
 	 * everything that is created in the constructor (keyword new)
 	 *
 	 * */
+	stopCheckpointer();
+	//flushes out dirty pages; clean pages are already accurate on disk
+	std::vector<FrameId> dirtyFrames;
 	for(FrameId i = 0; i < numBufs; i++){
-		while(bufDescTable[i].valid){
-			if(bufDescTable[i].dirty == true){
-				//flushes out dirty bit
-				bufDescTable[i].file -> writePage(bufPool[i]);
-				bufDescTable[i].dirty = false;
-			}
-			else { //enters else only if bufPool[i] is accurate with memory. then deallocates bufpool
-			}
+		if(bufDescTable[i].valid && bufDescTable[i].dirty){
+			dirtyFrames.push_back(i);
 		}
 	}
+	writeFrames(dirtyFrames);
 
 	delete [] bufDescTable;
+	for (FrameId i = 0; i < numBufs; i++)
+		delete bufPool[i];
 	delete [] bufPool;
 	delete hashTable;
+	delete trace;
+	for (typename std::map<const Page*, PageVersion*>::iterator it = versionPages.begin(); it != versionPages.end(); ++it)
+	{
+		delete it->second->page;
+		delete it->second;
+	}
+	delete frameLatches.load();
+	// No reader is left, so everything retired can go; retired pages land in sparePages.
+	epochs.reclaimAll();
+	for (std::size_t n = 0; n < sparePages.size(); n++)
+	{
+		for (std::size_t i = 0; i < sparePages[n].size(); i++)
+			delete sparePages[n][i];
+	}
 }
 
-void BufMgr::advanceClock()
+template <std::size_t PageSize>
+const std::uint8_t BasicBufMgr<PageSize>::KEEP_EXTRA_PASSES;
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::reference(const FrameId frame, const bool loaded)
 {
-	if(clockHand >= (numBufs - 1)){
-		clockHand = 0;
+	BufDesc& desc = bufDescTable[frame];
+	if (policy == BUF_POOL_RECYCLE && loaded)
+	{
+		desc.refbit = false;
+		desc.extraPasses = 0;
 	}
-	else{
-		clockHand = (clockHand + 1);
+	else
+	{
+		desc.refbit = true;
+		desc.extraPasses = policy == BUF_POOL_KEEP ? KEEP_EXTRA_PASSES : 0;
 	}
 }
 
-void BufMgr::allocBuf(FrameId & frame) 
-{ 
-	std::uint32_t scanner = 0;
-	bool cont = 0;
-	while(scanner < 2*numBufs){
-		advanceClock();
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::sweep(std::unique_lock<std::mutex>& lock, const int node)
+{
+	BufStatsShard& stats = bufStats.local();
+	// resize() does not move the descriptors or the frame latches while a sweep is running.
+	BufDesc* const table = bufDescTable;
+	FrameLatch* const latches = frameLatches.load(std::memory_order_relaxed)->latches;
+	const std::uint32_t bufs = numBufs;
+	const std::uint32_t batch = evictBatch(bufs);
+	const std::uint32_t nodes = numaNodes;
+	// Every frame may need KEEP_EXTRA_PASSES passes beyond the usual two to lose its reference.
+	const std::uint64_t maxScan = (2 + KEEP_EXTRA_PASSES) * (std::uint64_t) bufs;
+	sweepers++;
+	lock.unlock();
+
+	FrameId victims[EVICT_BATCH];
+	std::uint32_t found = 0;
+	bool foundOnNode = node < 0;
+	std::uint64_t scanner = 0;
+	while ((found < batch || (!foundOnNode && found < EVICT_BATCH)) && scanner < maxScan)
+	{
+		const FrameId frame = (FrameId) (clockHand.fetch_add(1, std::memory_order_relaxed) % bufs);
 		scanner++;
-		if(bufDescTable[clockHand].valid == false){
-			break;
+		BufDesc& desc = table[frame];
+		if (!desc.refbit.load(std::memory_order_relaxed))
+		{
+			// An optimistic read since the last pass counts as a reference.
+			if (latches[frame].referenced.load(std::memory_order_relaxed))
+				latches[frame].referenced.store(false, std::memory_order_relaxed);
+			else if (desc.pinCnt.load() == 0)
+			{
+				victims[found++] = frame;
+				foundOnNode = foundOnNode || frame % nodes == (std::uint32_t) node;
+			}
 		}
-		if(!(bufDescTable[clockHand].refbit)){
-			if(bufDescTable[clockHand].pinCnt == 0){
-				hashTable->remove(bufDescTable[clockHand].file, bufDescTable[clockHand].pageNo);
-				cont = true;
-				break;
+		else
+		{
+			// Another sweep may age the frame at the same time; only one of them takes the pass.
+			std::uint8_t passes = desc.extraPasses.load(std::memory_order_relaxed);
+			if (passes > 0)
+				desc.extraPasses.compare_exchange_strong(passes, passes - 1, std::memory_order_relaxed);
+			else
+				desc.refbit.store(false, std::memory_order_relaxed);
+		}
+	}
 
+	sweepers--;
+	lock.lock();
+	BufStatsShard::bump(stats.sweeps);
+	BufStatsShard::bump(stats.sweepSteps, scanner);
+	stats.sweepLength.record(scanner);
+	if (found == 0)
+		throw BufferExceededException();
+	readyFrames.insert(readyFrames.end(), victims, victims + found);
+}
+
+template <std::size_t PageSize>
+bool BasicBufMgr<PageSize>::evict(const FrameId frame, std::unique_lock<std::mutex>& lock, const bool syncLog)
+{
+	BufStatsShard& stats = bufStats.local();
+	BufDesc& desc = bufDescTable[frame];
+	if (desc.dirty)
+	{
+		// Dirty frames queued for eviction, then those the clock hand reaches next, share the batch,
+		// so they are clean when their turn comes.
+		std::vector<FrameId> batch(1, frame);
+		if (doubleWrite)
+		{
+			const std::uint32_t capacity = doubleWrite->capacity();
+			std::vector<FrameId> candidates(readyFrames.begin(), readyFrames.end());
+			const FrameId hand = (FrameId) (clockHand.load(std::memory_order_relaxed) % numBufs);
+			for (std::uint32_t j = 0; j < numBufs && j < 4 * capacity; j++)
+				candidates.push_back((hand + j) % numBufs);
+			for (std::size_t j = 0; j < candidates.size() && batch.size() < capacity; j++)
+			{
+				const FrameId other = candidates[j];
+				if (other < numBufs && bufDescTable[other].valid && bufDescTable[other].dirty &&
+				    bufDescTable[other].pinCnt == 0 && std::find(batch.begin(), batch.end(), other) == batch.end())
+					batch.push_back(other);
+			}
+		}
+		// Sync the log without the latch, as checkpoint() does, so a miss that has to write a dirty
+		// page does not hold up every other thread for the sync.
+		WriteAheadLog* const pageLog = log;
+		if (pageLog && syncLog)
+		{
+			Lsn lsn = 0;
+			for (std::size_t i = 0; i < batch.size(); i++)
+				lsn = std::max(lsn, bufPool[batch[i]]->lsn());
+			if (pageLog->durableLsn() < lsn)
+			{
+				lock.unlock();
+				try{
+					pageLog->flush(lsn);
+				}
+				catch(...){
+					lock.lock();
+					throw;
+				}
+				lock.lock();
+				return false;
 			}
 		}
-		else{
-			bufStats.accesses++;
-			bufDescTable[clockHand].refbit = false;
+		BufStatsShard::bump(stats.dirtyEvictions);
+		for (std::size_t i = 0; i < batch.size(); i++)
+		{
+			BufStatsShard::bump(stats.diskwrites);
+			stats.bumpFile(bufDescTable[batch[i]].file->filename(), &FileBufStats::writes);
 		}
+		writeFrames(batch);
 	}
-	if((!cont) && (scanner >= 2*numBufs-1)){
-		throw BufferExceededException();
+	BufStatsShard::bump(stats.evictions);
+	beginFrameChange(frame);
+	hashTable->remove(desc.file, desc.pageNo);
+	desc.Clear();
+	endFrameChange(frame);
+	return true;
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::logFrame(const FrameId frame)
+{
+	Page* page = bufPool[frame];
+	std::string image(reinterpret_cast<const char*>(&page->header_), sizeof(PageHeader));
+	image.append(page->data_);
+	page->set_lsn(log->appendPageImage(bufDescTable[frame].file->filename(), bufDescTable[frame].pageNo,
+	                                   image.data(), image.size()));
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::writeFrame(const FrameId frame)
+{
+	writeFrames(std::vector<FrameId>(1, frame));
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::writeFrames(const std::vector<FrameId>& frames)
+{
+	if (frames.empty())
+		return;
+	// Write-ahead rule: the log record of the latest change must be durable before the page is.
+	// Evictions, flushFile and checkpoints sync the log without the latch beforehand, so this
+	// normally finds it durable; resize and the destructor sync here, as they stop the pool anyway.
+	if (log)
+	{
+		Lsn lsn = 0;
+		for (std::size_t i = 0; i < frames.size(); i++)
+			lsn = std::max(lsn, bufPool[frames[i]]->lsn());
+		log->flush(lsn);
+	}
+	if (doubleWrite)
+	{
+		std::vector<typename DoubleWriteBuffer::PageWrite> pages;
+		pages.reserve(frames.size());
+		for (std::size_t i = 0; i < frames.size(); i++)
+			pages.push_back(typename DoubleWriteBuffer::PageWrite(bufDescTable[frames[i]].file, bufPool[frames[i]]));
+		doubleWrite->write(pages);
+	}
+	else
+	{
+		for (std::size_t i = 0; i < frames.size(); i++)
+			bufDescTable[frames[i]].file->writePage(*bufPool[frames[i]]);
 	}
+	for (std::size_t i = 0; i < frames.size(); i++)
+	{
+		bufDescTable[frames[i]].dirty = false;
+		bufDescTable[frames[i]].recLsn = 0;
+	}
+}
 
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::allocBuf(FrameId & frame, std::unique_lock<std::mutex>& lock, const int node) 
+{ 
+	// The frame may have been referenced, pinned, emptied or removed since it was queued.
+	const auto evictable = [this](const FrameId queued)
+	{
+		return queued < numBufs && bufDescTable[queued].valid && bufDescTable[queued].pinCnt == 0 &&
+		       !bufDescTable[queued].refbit && !frameLatches.load(std::memory_order_relaxed)->latches[queued].referenced;
+	};
+	bool swept = false;
+	// The latch is released for a log sync at most once, so a victim that keeps being changed
+	// cannot hold the caller up for sync after sync.
+	bool logSynced = false;
+	for (;;)
+	{
+		// A free or queued frame of the node first, searched from where frames are taken.
+		if (node >= 0)
+		{
+			for (std::size_t i = freeFrames.size(); i > 0; i--)
+			{
+				if (frameNode(freeFrames[i - 1]) == (std::uint32_t) node)
+				{
+					frame = freeFrames[i - 1];
+					freeFrames.erase(freeFrames.begin() + (i - 1));
+					bufDescTable[frame].Clear();
+					return;
+				}
+			}
+			std::deque<FrameId>::iterator it = readyFrames.begin();
+			while (it != readyFrames.end() && !(*it < numBufs && frameNode(*it) == (std::uint32_t) node && evictable(*it)))
+				++it;
+			if (it != readyFrames.end())
+			{
+				frame = *it;
+				readyFrames.erase(it);
+				if (evict(frame, lock, !logSynced))
+					return;
+				// The latch was released for a log sync; the frame is checked again like any other.
+				logSynced = true;
+				readyFrames.push_front(frame);
+				continue;
+			}
+		}
+
+		if (!freeFrames.empty())
+		{
+			frame = freeFrames.back();
+			freeFrames.pop_back();
+			bufDescTable[frame].Clear();
+			return;
+		}
+
+		// A victim of another node only once a sweep has looked for one on the node.
+		while (!readyFrames.empty() && (node < 0 || swept))
+		{
+			frame = readyFrames.front();
+			readyFrames.pop_front();
+			if (evictable(frame))
+			{
+				if (evict(frame, lock, !logSynced))
+					return;
+				logSynced = true;
+				readyFrames.push_front(frame);
+			}
+		}
 
-	if(bufDescTable[clockHand].dirty && bufDescTable[clockHand].valid){
-		bufStats.diskwrites++;
-		bufDescTable[clockHand].file->writePage(bufPool[clockHand]);
+		sweep(lock, node);
+		swept = true;
 	}
-	
+}
+
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::readPage(File* file, const PageId pageNo, Page*& page)
+{
+	// "Return a pointer to the frame containing the page via the page parameter"
+	page = bufPool[readFrame(file, pageNo)];
+}
 
-	bufDescTable[clockHand].Clear();
-	//bufDescTable[clockHand].Set(bufDescTable[clockHand].file, bufDescTable[clockHand].pageNo);
-	frame = clockHand;
+template <std::size_t PageSize>
+BasicPageHandle<PageSize> BasicBufMgr<PageSize>::readPage(File* file, const PageId pageNo)
+{
+	const FrameId frameNo = readFrame(file, pageNo);
+	return PageHandle(this, frameNo, bufPool[frameNo]);
 }
 
+template <std::size_t PageSize>
+FrameId BasicBufMgr<PageSize>::readFrame(File* file, const PageId pageNo, const PinKind pin)
+{
+	std::unique_lock<std::mutex> lock(latch);
+	return readFrame(file, pageNo, lock, pin);
+}
 
-void BufMgr::readPage(File* file, const PageId pageNo, Page*& page)
+template <std::size_t PageSize>
+FrameId BasicBufMgr<PageSize>::readFrame(File* file, const PageId pageNo, std::unique_lock<std::mutex>& lock,
+                                         const PinKind pin)
 {
+	const std::uint64_t start = latencyClockTicks();
+	BufStatsShard& stats = bufStats.local();
+	BufStatsShard::bump(stats.accesses);
+	workingSet.record(file, pageNo);
+	if (trace) {
+		trace->record(TRACE_READ, file->filename(), pageNo, false);
+	}
+	const int threadNode = numa ? numa->currentNode() : -1;
 	FrameId frameNo;
 	try{
 		hashTable->lookup(file, pageNo, frameNo);  // Case 2: Page is in the buffer pool
-		bufDescTable[frameNo].refbit = true;
-		bufDescTable[frameNo].pinCnt++;
-		// "Return a pointer to the frame containing the page via the page parameter"
-		page = &bufPool[frameNo];
 	}
 	catch(HashNotFoundException e){ // Case 1: Page is not in the buffer pool
-		allocBuf(frameNo);
-		bufStats.diskreads++;
-		bufPool[frameNo] = file->readPage(pageNo);
-		bufDescTable[frameNo].Set(file, pageNo);
-		//bufDescTable[frameNo].refbit = true;
-		// "Return a pointer to the frame containing the page via the page parameter"
-		page = &bufPool[frameNo];
-		hashTable->insert(file, pageNo, frameNo);
+		allocBuf(frameNo, lock, missNode(file, pageNo, threadNode));
+		// Another thread may have read the page while the latch was released for a sweep or a log sync.
+		FrameId loaded;
+		try{
+			hashTable->lookup(file, pageNo, loaded);
+			freeFrames.push_back(frameNo);
+			frameNo = loaded;
+		}
+		catch(HashNotFoundException&){
+			BufStatsShard::bump(stats.misses);
+			stats.bumpFile(file->filename(), &FileBufStats::misses);
+			BufStatsShard::bump(stats.diskreads);
+			beginFrameChange(frameNo);
+			// Optimistic readers may still be reading the page the frame held.
+			Page* page = takePage(frameNode(frameNo));
+			try{
+				*page = file->readPage(pageNo);
+			}
+			catch(...){
+				sparePages[frameNode(frameNo)].push_back(page);
+				endFrameChange(frameNo);
+				freeFrames.push_back(frameNo);
+				throw;
+			}
+			if (bufPool[frameNo] != NULL)
+				retirePage(bufPool[frameNo], frameNode(frameNo));
+			bufPool[frameNo] = page;
+			bufDescTable[frameNo].Set(file, pageNo);
+			countNodeAccess(stats, frameNo, threadNode);
+			if (pin == PIN_NONE)
+				bufDescTable[frameNo].pinCnt = 0;
+			else if (pin == PIN_IN_PLACE)
+				beginInPlacePin(frameNo);
+			reference(frameNo, true);
+			//bufDescTable[frameNo].refbit = true;
+			hashTable->insert(file, pageNo, frameNo);
+			endFrameChange(frameNo);
+			stats.recordSince(stats.readPageLatency, start);
+			return frameNo;
+		}
 	}
+	reference(frameNo, false);
+	if (pin != PIN_NONE)
+		bufDescTable[frameNo].pinCnt++;
+	if (pin == PIN_IN_PLACE)
+		beginInPlacePin(frameNo);
+	bufDescTable[frameNo].hitCnt++;
+	BufStatsShard::bump(stats.hits);
+	countNodeAccess(stats, frameNo, threadNode);
+	stats.bumpFile(file->filename(), &FileBufStats::hits);
+	stats.recordSince(stats.readPageLatency, start);
+	return frameNo;
 }
 
 
-void BufMgr::unPinPage(File* file, const PageId pageNo, const bool dirty)
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::unPinPage(File* file, const PageId pageNo, const bool dirty)
 {
+	const std::uint64_t start = latencyClockTicks();
+	BufStatsShard& stats = bufStats.local();
+	std::lock_guard<std::mutex> lock(latch);
+	if (trace) {
+		trace->record(TRACE_UNPIN, file->filename(), pageNo, dirty);
+	}
 	//can throw a hashnotfoundexception
 	FrameId frameNo;
 	try{
 		hashTable->lookup(file, pageNo, frameNo);
 	} catch(HashNotFoundException e){
+		stats.recordSince(stats.unPinPageLatency, start);
 		return;
 	}
+	unPinFrame(frameNo, dirty, true);
+	stats.recordSince(stats.unPinPageLatency, start);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::unPinHandle(const FrameId frameNo, const bool dirty)
+{
+	const std::uint64_t start = latencyClockTicks();
+	BufStatsShard& stats = bufStats.local();
+	std::lock_guard<std::mutex> lock(latch);
+	if (trace) {
+		trace->record(TRACE_UNPIN, bufDescTable[frameNo].file->filename(), bufDescTable[frameNo].pageNo, dirty);
+	}
+	unPinFrame(frameNo, dirty, true);
+	stats.recordSince(stats.unPinPageLatency, start);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::unPinFrame(const FrameId frameNo, const bool dirty, const bool inPlace)
+{
 	if(bufDescTable[frameNo].pinCnt == 0){
-		throw PageNotPinnedException(file->filename(), pageNo, frameNo);
-		return;
+		throw PageNotPinnedException(bufDescTable[frameNo].file->filename(), bufDescTable[frameNo].pageNo, frameNo);
 	}
 
-	bufDescTable[frameNo].pinCnt = (bufDescTable[frameNo].pinCnt - 1);
-	
+	// Set before the pin is dropped, so a sweep that sees the frame unpinned also sees it dirty.
 	if(dirty == true){
+		// The page was changed in place; optimistic reads that overlapped the change fail.
+		beginFrameChange(frameNo);
+		if (log)
+		{
+			// The first change since the page was written is logged at or after the current end.
+			if (!bufDescTable[frameNo].dirty)
+				bufDescTable[frameNo].recLsn = log->endLsn();
+			logFrame(frameNo);
+		}
 		bufDescTable[frameNo].dirty = true;
+		endFrameChange(frameNo);
+	}
+
+	if (inPlace)
+		endInPlacePin(frameNo);
+	bufDescTable[frameNo].pinCnt--;
+}
+
+template <std::size_t PageSize>
+BasicSnapshot<PageSize> BasicBufMgr<PageSize>::beginSnapshot()
+{
+	std::lock_guard<std::mutex> lock(latch);
+	activeSnapshots.insert(commitClock);
+	return Snapshot(this, commitClock);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::endSnapshot(const std::uint64_t stamp)
+{
+	std::lock_guard<std::mutex> lock(latch);
+	activeSnapshots.erase(activeSnapshots.find(stamp));
+	reclaimVersions();
+}
+
+template <std::size_t PageSize>
+typename BasicBufMgr<PageSize>::PageVersion* BasicBufMgr<PageSize>::visibleVersion(const File* file,
+                                                                                  const PageId pageNo,
+                                                                                  const std::uint64_t stamp)
+{
+	const typename std::map<PageKey, PageVersion*>::const_iterator it = versions.find(PageKey(file, pageNo));
+	if (it == versions.end())
+		return NULL;
+	// The oldest image superseded after the snapshot began is the one current when it began.
+	PageVersion* visible = NULL;
+	for (PageVersion* version = it->second; version != NULL && version->end > stamp; version = version->older)
+		visible = version;
+	return visible;
+}
+
+template <std::size_t PageSize>
+BasicPageHandle<PageSize> BasicBufMgr<PageSize>::readPage(File* file, const PageId pageNo,
+                                                          const Snapshot& snapshot)
+{
+	BufStatsShard& stats = bufStats.local();
+	{
+		std::lock_guard<std::mutex> lock(latch);
+		PageVersion* version = visibleVersion(file, pageNo, snapshot.timestamp());
+		if (version)
+		{
+			version->pins++;
+			BufStatsShard::bump(stats.versionReads);
+			return PageHandle(this, 0, version->page, PageHandle::PIN_SNAPSHOT);
+		}
+	}
+
+	const FrameId frameNo = readFrame(file, pageNo, PIN_SHARED);
+	std::lock_guard<std::mutex> lock(latch);
+	// An update may have been installed while the page was being read.
+	PageVersion* version = visibleVersion(file, pageNo, snapshot.timestamp());
+	if (version)
+	{
+		version->pins++;
+		BufStatsShard::bump(stats.versionReads);
+		unPinFrame(frameNo, false, false);
+		return PageHandle(this, 0, version->page, PageHandle::PIN_SNAPSHOT);
+	}
+	bufDescTable[frameNo].snapshotPins++;
+	return PageHandle(this, frameNo, bufPool[frameNo], PageHandle::PIN_SNAPSHOT);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::unPinSnapshot(const FrameId frameNo, Page* page)
+{
+	std::lock_guard<std::mutex> lock(latch);
+	const typename std::map<const Page*, PageVersion*>::iterator it = versionPages.find(page);
+	if (it != versionPages.end())
+	{
+		PageVersion* version = it->second;
+		version->pins--;
+		if (version->obsolete && version->pins == 0)
+			freeVersion(version);
+		return;
+	}
+	bufDescTable[frameNo].snapshotPins--;
+	unPinFrame(frameNo, false, false);
+	versionChanged.notify_all();
+}
+
+template <std::size_t PageSize>
+BasicPageHandle<PageSize> BasicBufMgr<PageSize>::updatePage(File* file, const PageId pageNo)
+{
+	std::unique_lock<std::mutex> lock(latch);
+	// Pinned and, if another update is in progress, counted as waiting under one hold of the latch, so
+	// an update being installed never mistakes this pin for a reader of the page in the frame.
+	const FrameId frameNo = readFrame(file, pageNo, lock, PIN_SHARED);
+	// One update of a page at a time, so each starts from the image the last one installed.
+	if (bufDescTable[frameNo].updating)
+	{
+		bufDescTable[frameNo].updateWaiters++;
+		versionChanged.wait(lock, [this, frameNo]() { return !bufDescTable[frameNo].updating; });
+		bufDescTable[frameNo].updateWaiters--;
+	}
+	bufDescTable[frameNo].updating = true;
+	Page* copy = takePage(frameNode(frameNo));
+	*copy = *bufPool[frameNo];
+	return PageHandle(this, frameNo, copy, PageHandle::PIN_UPDATE);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::installUpdate(const FrameId frameNo, Page* copy, const bool dirty)
+{
+	const std::uint64_t start = latencyClockTicks();
+	BufStatsShard& stats = bufStats.local();
+	std::unique_lock<std::mutex> lock(latch);
+	if (trace) {
+		trace->record(TRACE_UNPIN, bufDescTable[frameNo].file->filename(), bufDescTable[frameNo].pageNo, dirty);
+	}
+	if (dirty)
+	{
+		// Snapshot readers of the page in its frame must keep the old image; it can only be moved
+		// out from under them once no one else reads the frame.
+		versionChanged.wait(lock, [this, frameNo]()
+		{
+			const BufDesc& desc = bufDescTable[frameNo];
+			return desc.snapshotPins == 0 || desc.pinCnt == 1 + desc.snapshotPins + desc.updateWaiters;
+		});
+		BufDesc& desc = bufDescTable[frameNo];
+		const std::uint64_t stamp = ++commitClock;
+		beginFrameChange(frameNo);
+		if (!activeSnapshots.empty() || desc.snapshotPins > 0)
+		{
+			PageVersion* version = new PageVersion();
+			version->end = stamp;
+			version->obsolete = false;
+			version->node = frameNode(frameNo);
+			if (desc.pinCnt == 1 + desc.snapshotPins + desc.updateWaiters)
+			{
+				// Hand the old image over to the snapshot readers without copying it.
+				version->page = bufPool[frameNo];
+				version->pins = desc.snapshotPins;
+				desc.pinCnt -= desc.snapshotPins;
+				desc.snapshotPins = 0;
+				bufPool[frameNo] = copy;
+			}
+			else
+			{
+				version->page = takePage(version->node);
+				*version->page = *bufPool[frameNo];
+				version->pins = 0;
+				*bufPool[frameNo] = *copy;
+				retirePage(copy, frameNode(frameNo));
+			}
+			const PageKey key(desc.file, desc.pageNo);
+			PageVersion*& newest = versions[key];
+			version->older = newest;
+			newest = version;
+			versionPages[version->page] = version;
+			closedVersions.push_back(std::make_pair(stamp, key));
+			BufStatsShard::bump(stats.versionsCreated);
+		}
+		else if (desc.pinCnt == 1 + desc.updateWaiters)
+		{
+			// Waiting updaters hold pins but no pointer to the page; they copy the new one.
+			retirePage(bufPool[frameNo], frameNode(frameNo));
+			bufPool[frameNo] = copy;
+		}
+		else
+		{
+			*bufPool[frameNo] = *copy;
+			retirePage(copy, frameNode(frameNo));
+		}
+		endFrameChange(frameNo);
+	}
+	else
+		retirePage(copy, frameNode(frameNo));
+
+	bufDescTable[frameNo].updating = false;
+	versionChanged.notify_all();
+	unPinFrame(frameNo, dirty, false);
+	reclaimVersions();
+	stats.recordSince(stats.unPinPageLatency, start);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::reclaimVersions()
+{
+	BufStatsShard& stats = bufStats.local();
+	const std::uint64_t oldest = activeSnapshots.empty() ? commitClock : *activeSnapshots.begin();
+	while (!closedVersions.empty() && closedVersions.front().first <= oldest)
+	{
+		// Images are superseded in timestamp order, so the oldest one of its page is last in the chain.
+		const typename std::map<PageKey, PageVersion*>::iterator it = versions.find(closedVersions.front().second);
+		closedVersions.pop_front();
+		PageVersion** link = &it->second;
+		while ((*link)->older != NULL)
+			link = &(*link)->older;
+		PageVersion* version = *link;
+		*link = NULL;
+		if (it->second == NULL)
+			versions.erase(it);
+		BufStatsShard::bump(stats.versionsReclaimed);
+		if (version->pins == 0)
+			freeVersion(version);
+		else
+			version->obsolete = true;
+	}
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::freeVersion(PageVersion* version)
+{
+	versionPages.erase(version->page);
+	retirePage(version->page, version->node);
+	delete version;
+}
+
+template <std::size_t PageSize>
+BasicPage<PageSize>* BasicBufMgr<PageSize>::takePage(const std::uint32_t node)
+{
+	std::vector<Page*>& spare = sparePages[node];
+	if (spare.empty())
+		epochs.reclaim();
+	if (spare.empty())
+		return new Page();
+	Page* page = spare.back();
+	spare.pop_back();
+	return page;
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::retirePage(Page* page, const std::uint32_t node)
+{
+	epochs.retire(page, &BasicBufMgr<PageSize>::reusePage, &pageHomes[node]);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::reusePage(void* page, void* home)
+{
+	const PageHome* const owner = static_cast<const PageHome*>(home);
+	BasicBufMgr<PageSize>* const mgr = owner->mgr;
+	// The pool may have been repartitioned since the page was retired.
+	std::vector<Page*>& spare = mgr->sparePages[owner->node < mgr->numaNodes ? owner->node : 0];
+	if (spare.size() < (mgr->numBufs + mgr->numaNodes - 1) / mgr->numaNodes)
+		spare.push_back(static_cast<Page*>(page));
+	else
+		delete static_cast<Page*>(page);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::fillSparePages()
+{
+	const std::uint32_t share = (numBufs + numaNodes - 1) / numaNodes;
+	std::vector<std::thread> fillers;
+	for (std::uint32_t n = 0; n < numaNodes; n++)
+	{
+		// Constructing a page writes all of it, so its memory is placed on the filler's node.
+		fillers.push_back(std::thread([this, n, share]()
+		{
+			numa->bindThread(n);
+			std::vector<Page*>& spare = sparePages[n];
+			while (spare.size() < share)
+				spare.push_back(new Page());
+		}));
+	}
+	for (std::size_t i = 0; i < fillers.size(); i++)
+		fillers[i].join();
+}
+
+template <std::size_t PageSize>
+int BasicBufMgr<PageSize>::missNode(const File* file, const PageId pageNo, const int threadNode) const
+{
+	if (numaNodes == 1)
+		return -1;
+	if (threadNode >= 0)
+		return threadNode;
+	std::uint64_t x = reinterpret_cast<std::uintptr_t>(file) * 0x9E3779B97F4A7C15ULL ^ pageNo;
+	x ^= x >> 33;
+	x *= 0xFF51AFD7ED558CCDULL;
+	x ^= x >> 33;
+	return (int) (x % numaNodes);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::countNodeAccess(BufStatsShard& stats, const FrameId frame, const int threadNode)
+{
+	if (threadNode < 0)
+		return;
+	if (frameNode(frame) == (std::uint32_t) threadNode)
+		BufStatsShard::bump(stats.localAccesses);
+	else
+		BufStatsShard::bump(stats.remoteAccesses);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::setNumaTopology(const NumaTopology* topology, const bool partition)
+{
+	std::lock_guard<std::mutex> lock(latch);
+	numa = topology;
+	const std::uint32_t nodes = topology && partition ? topology->numNodes() : 1;
+	if (nodes == numaNodes && !(topology && partition))
+		return;
+	// Spare pages were placed for the old partitions; start over with pages placed for the new.
+	for (std::size_t n = 0; n < sparePages.size(); n++)
+	{
+		for (std::size_t i = 0; i < sparePages[n].size(); i++)
+			delete sparePages[n][i];
+	}
+	numaNodes = nodes;
+	sparePages.assign(nodes, std::vector<Page*>());
+	while (pageHomes.size() < nodes)
+	{
+		const PageHome home = {this, (std::uint32_t) pageHomes.size()};
+		pageHomes.push_back(home);
+	}
+	if (topology && partition)
+		fillSparePages();
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::beginFrameChange(const FrameId frame)
+{
+	FrameLatch& latch = frameLatches.load(std::memory_order_relaxed)->latches[frame];
+	const std::uint64_t version = latch.version.load(std::memory_order_relaxed);
+	if ((version & 1) == 0)
+	{
+		latch.version.store(version + 1, std::memory_order_relaxed);
+		// Readers that see a change to the frame also see the odd version when they validate.
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::endFrameChange(const FrameId frame)
+{
+	beginFrameChange(frame);
+	FrameLatch& latch = frameLatches.load(std::memory_order_relaxed)->latches[frame];
+	const BufDesc& desc = bufDescTable[frame];
+	latch.file.store(desc.valid ? desc.file : NULL, std::memory_order_relaxed);
+	latch.pageNo.store(desc.pageNo, std::memory_order_relaxed);
+	// Released on its own too: a reader may load the pointer before the version that covers it, and
+	// must still see the page's contents once it does.
+	latch.page.store(bufPool[frame], std::memory_order_release);
+	latch.version.store(latch.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::beginInPlacePin(const FrameId frame)
+{
+	FrameLatch& latch = frameLatches.load(std::memory_order_relaxed)->latches[frame];
+	latch.writers.store(latch.writers.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	// Readers that see a change made through the pin also see the pin when they validate.
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::endInPlacePin(const FrameId frame)
+{
+	FrameLatch& latch = frameLatches.load(std::memory_order_relaxed)->latches[frame];
+	latch.writers.store(latch.writers.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+}
+
+template <std::size_t PageSize>
+typename BasicBufMgr<PageSize>::FrameLatchTable* BasicBufMgr<PageSize>::newFrameLatches(const std::uint32_t bufs)
+{
+	void* storage = NULL;
+	if (posix_memalign(&storage, alignof(FrameLatch), bufs * sizeof(FrameLatch)) != 0)
+		throw std::bad_alloc();
+	FrameLatchTable* table = new FrameLatchTable();
+	table->size = bufs;
+	table->latches = static_cast<FrameLatch*>(storage);
+	for (FrameId i = 0; i < bufs; i++)
+	{
+		new (&table->latches[i]) FrameLatch();
+		table->latches[i].version = 0;
+		table->latches[i].file = NULL;
+		table->latches[i].page = NULL;
+		table->latches[i].pageNo = 0;
+		table->latches[i].writers = 0;
+		table->latches[i].referenced = false;
 	}
+	return table;
 }
 
-void BufMgr::flushFile(const File* file) 
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::flushFile(const File* file) 
 {
+	const std::uint64_t start = latencyClockTicks();
+	BufStatsShard& stats = bufStats.local();
+	// Sync the log for the file's dirty pages before the latch is taken for the writes, so only
+	// changes made meanwhile are synced with it held.
+	WriteAheadLog* const pageLog = log;
+	if (pageLog)
+	{
+		Lsn lsn = 0;
+		{
+			std::lock_guard<std::mutex> scan(latch);
+			for (FrameId i = 0; i < numBufs; i++)
+			{
+				const BufDesc& desc = bufDescTable[i];
+				if (desc.file == file && desc.valid && desc.dirty)
+					lsn = std::max(lsn, bufPool[i]->lsn());
+			}
+		}
+		pageLog->flush(lsn);
+	}
+	std::lock_guard<std::mutex> lock(latch);
+	if (doubleWrite)
+	{
+		// Write the file's dirty pages in batches rather than one at a time.
+		std::vector<FrameId> batch;
+		for (FrameId i = 0; i < numBufs; i++)
+		{
+			const BufDesc& desc = bufDescTable[i];
+			if (desc.file == file && desc.valid && desc.dirty && desc.pinCnt == 0)
+			{
+				BufStatsShard::bump(stats.diskwrites);
+				stats.bumpFile(file->filename(), &FileBufStats::writes);
+				batch.push_back(i);
+			}
+		}
+		writeFrames(batch);
+	}
 	for(FrameId i = 0; i < numBufs; i++){
 		BufDesc* temp = &(bufDescTable[i]);
 		if (temp->file == file){
@@ -168,72 +942,469 @@ void BufMgr::flushFile(const File* file)
 			}
 			// (a)
 			if (temp->dirty){
-				temp->file -> writePage(bufPool[i]); // flushes the page to disk
-				temp->dirty = false; // sets dirty bit to false
+				BufStatsShard::bump(stats.diskwrites);
+				stats.bumpFile(file->filename(), &FileBufStats::writes);
+				writeFrame(i); // flushes the page to disk and clears the dirty bit
 			}
 			//(b)
+			beginFrameChange(i);
 			try{
 				hashTable->remove(file, bufDescTable[i].pageNo);
 			} catch(HashNotFoundException e){
+				endFrameChange(i);
+				stats.recordSince(stats.flushFileLatency, start);
 				return;
 			}
 			//(c)
 			temp->Clear(); // clears frame
+			endFrameChange(i);
+			freeFrames.push_back(i);
 			//bufDescTable[i].valid = false;
 			//bufDescTable[i].pinCnt = 0;
 		}
 	}
+	stats.recordSince(stats.flushFileLatency, start);
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::allocPage(File* file, PageId &pageNo, Page*& page)
+{
+	//returns pointer to the frame via the page parameter
+	page = bufPool[allocFrame(file, pageNo)];
+}
+
+template <std::size_t PageSize>
+BasicPageHandle<PageSize> BasicBufMgr<PageSize>::allocPage(File* file, PageId &pageNo)
+{
+	const FrameId frameNo = allocFrame(file, pageNo);
+	return PageHandle(this, frameNo, bufPool[frameNo]);
 }
 
-void BufMgr::allocPage(File* file, PageId &pageNo, Page*& page)
+template <std::size_t PageSize>
+FrameId BasicBufMgr<PageSize>::allocFrame(File* file, PageId &pageNo)
 {
+	const std::uint64_t start = latencyClockTicks();
+	BufStatsShard& stats = bufStats.local();
+	BufStatsShard::bump(stats.accesses);
+	std::unique_lock<std::mutex> lock(latch);
 	FrameId frameNo;
-	allocBuf(frameNo);
-	bufPool[frameNo] = file->allocatePage();
+	const int threadNode = numa ? numa->currentNode() : -1;
+	allocBuf(frameNo, lock, numaNodes > 1 ? threadNode : -1);
+	beginFrameChange(frameNo);
+	Page* page = takePage(frameNode(frameNo));
+	try{
+		*page = file->allocatePage();
+	}
+	catch(...){
+		sparePages[frameNode(frameNo)].push_back(page);
+		endFrameChange(frameNo);
+		freeFrames.push_back(frameNo);
+		throw;
+	}
+	if (bufPool[frameNo] != NULL)
+		retirePage(bufPool[frameNo], frameNode(frameNo));
+	bufPool[frameNo] = page;
+	countNodeAccess(stats, frameNo, threadNode);
 	//returns newly allocated page to the caller via the pageNo parameter
-	PageId pageNo1 = bufPool[frameNo].page_number();
+	PageId pageNo1 = bufPool[frameNo]->page_number();
 	hashTable->insert(file, pageNo1, frameNo);
 	bufDescTable[frameNo].Set(file, pageNo1);
-	//returns pointer to the frame via the page parameter
-	page = &bufPool[frameNo];
+	endFrameChange(frameNo);
+	beginInPlacePin(frameNo);
+	reference(frameNo, true);
 	pageNo = pageNo1;
+	workingSet.record(file, pageNo);
+	if (trace) {
+		trace->record(TRACE_ALLOC, file->filename(), pageNo, false);
+	}
+	stats.recordSince(stats.allocPageLatency, start);
+	return frameNo;
 }
 
-void BufMgr::disposePage(File* file, const PageId PageNo)
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::disposePage(File* file, const PageId PageNo)
 {
-	FrameId frameNo = numBufs + 20;
+	std::lock_guard<std::mutex> lock(latch);
+	if (trace) {
+		trace->record(TRACE_DISPOSE, file->filename(), PageNo, false);
+	}
+	FrameId frameNo;
 	try{
 		hashTable->lookup(file, PageNo, frameNo);
-		if(frameNo != (numBufs + 20)){ 
-			//file->deletePage(PageNo);
-		}
-		else{
-			bufDescTable[frameNo].Clear(); // frees frame
-			hashTable->remove(file, PageNo); // removes entry from hash table
-			//bufDescTable[frameNo].valid = false;
-		}
+		// A handle or pin still using the page would unpin whatever the frame holds next.
+		if (bufDescTable[frameNo].pinCnt > 0)
+			throw PagePinnedException(file->filename(), PageNo, frameNo);
+		beginFrameChange(frameNo);
+		bufDescTable[frameNo].Clear(); // frees frame
+		hashTable->remove(file, PageNo); // removes entry from hash table
+		endFrameChange(frameNo);
+		freeFrames.push_back(frameNo);
 	}catch(HashNotFoundException e){
-		return;
 	}
 	file->deletePage(PageNo);
 }
 
-void BufMgr::printSelf(void)
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::resize(const std::uint32_t newFrames)
+{
+	if (newFrames == 0)
+		throw InvalidPoolSizeException(newFrames);
+
+	std::lock_guard<std::mutex> lock(latch);
+	// Sweeps in progress read the old descriptors; no new one starts while the latch is held.
+	while (sweepers > 0)
+		std::this_thread::yield();
+
+	// Check before evicting anything so a failed shrink leaves the pool as it was.
+	for (FrameId i = newFrames; i < numBufs; i++)
+	{
+		if (bufDescTable[i].valid && bufDescTable[i].pinCnt > 0)
+			throw PagePinnedException(bufDescTable[i].file->filename(), bufDescTable[i].pageNo, i);
+	}
+
+	BufStatsShard& stats = bufStats.local();
+	std::vector<FrameId> dirtyFrames;
+	for (FrameId i = newFrames; i < numBufs; i++)
+	{
+		BufDesc& desc = bufDescTable[i];
+		if (desc.valid && desc.dirty)
+		{
+			BufStatsShard::bump(stats.dirtyEvictions);
+			BufStatsShard::bump(stats.diskwrites);
+			stats.bumpFile(desc.file->filename(), &FileBufStats::writes);
+			dirtyFrames.push_back(i);
+		}
+	}
+	writeFrames(dirtyFrames);
+	for (FrameId i = newFrames; i < numBufs; i++)
+	{
+		BufDesc& desc = bufDescTable[i];
+		if (desc.valid)
+		{
+			BufStatsShard::bump(stats.evictions);
+			hashTable->remove(desc.file, desc.pageNo);
+		}
+		if (bufPool[i] != NULL)
+			retirePage(bufPool[i], frameNode(i));
+	}
+
+	BufDesc* newDescTable = new BufDesc[newFrames];
+	Page** newPool = new Page*[newFrames];
+	for (FrameId i = 0; i < newFrames; i++)
+	{
+		if (i < numBufs)
+		{
+			newDescTable[i] = bufDescTable[i];
+			newPool[i] = bufPool[i];
+		}
+		else
+			newPool[i] = NULL;
+		newDescTable[i].frameNo = i;
+	}
+	delete [] bufDescTable;
+	delete [] bufPool;
+	bufDescTable = newDescTable;
+	bufPool = newPool;
+
+	// Readers still using the old latches find them all changing and move to the new table.
+	FrameLatchTable* const oldLatches = frameLatches.load(std::memory_order_relaxed);
+	FrameLatchTable* const newLatches = newFrameLatches(newFrames);
+	for (FrameId i = 0; i < newFrames && i < numBufs; i++)
+	{
+		newLatches->latches[i].version = oldLatches->latches[i].version.load(std::memory_order_relaxed);
+		newLatches->latches[i].writers = oldLatches->latches[i].writers.load(std::memory_order_relaxed);
+	}
+	for (FrameId i = 0; i < numBufs; i++)
+		oldLatches->latches[i].version.store(oldLatches->latches[i].version.load(std::memory_order_relaxed) + 1,
+		                                     std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	frameLatches.store(newLatches, std::memory_order_release);
+	epochs.retire(oldLatches);
+	for (FrameId i = 0; i < newFrames && i < numBufs; i++)
+		endFrameChange(i);
+
+	// Removed frames leave the free list; added frames join it, to be used first in order.
+	std::vector<FrameId> newFreeFrames;
+	newFreeFrames.reserve(newFrames);
+	for (FrameId i = newFrames; i > numBufs; i--)
+		newFreeFrames.push_back(i - 1);
+	for (std::size_t i = 0; i < freeFrames.size(); i++)
+	{
+		if (freeFrames[i] < newFrames)
+			newFreeFrames.push_back(freeFrames[i]);
+	}
+	freeFrames.swap(newFreeFrames);
+	for (std::deque<FrameId>::iterator it = readyFrames.begin(); it != readyFrames.end(); )
+	{
+		if (*it >= newFrames)
+			it = readyFrames.erase(it);
+		else
+			++it;
+	}
+
+	hashTable->resize(hashTableSize(newFrames));
+	numBufs = newFrames;
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::printSelf(void)
 {
 	BufDesc* tmpbuf;
 	int validFrames = 0;
 
-	for (std::uint32_t i = 0; i < numBufs; i++)
 	{
-		tmpbuf = &(bufDescTable[i]);
-		std::cout << "FrameNo:" << i << " ";
-		tmpbuf->Print();
+		std::lock_guard<std::mutex> lock(latch);
+		for (std::uint32_t i = 0; i < numBufs; i++)
+		{
+			tmpbuf = &(bufDescTable[i]);
+			std::cout << "FrameNo:" << i << " ";
+			tmpbuf->Print();
 
-		if (tmpbuf->valid == true)
-			validFrames++;
+			if (tmpbuf->valid == true)
+				validFrames++;
+		}
 	}
 
 	std::cout << "Total Number of Valid Frames:" << validFrames << "\n";
+
+	const BufStats stats = getBufStats();
+	for (std::map<std::string, FileBufStats>::const_iterator it = stats.files.begin(); it != stats.files.end(); ++it)
+	{
+		std::cout << "file:" << it->first << " ";
+		std::cout << "resident:" << it->second.resident << " ";
+		std::cout << "dirty:" << it->second.dirty << " ";
+		std::cout << "hits:" << it->second.hits << " ";
+		std::cout << "misses:" << it->second.misses << " ";
+		std::cout << "writes:" << it->second.writes << "\n";
+	}
+
+	std::cout << "Frames by hits since read:";
+	for (std::size_t k = 0; k < stats.heat.size(); k++)
+	{
+		if (k < 2)
+			std::cout << " " << k << ":" << stats.heat[k];
+		else
+			std::cout << " " << (1ULL << (k - 1)) << "-" << (1ULL << k) - 1 << ":" << stats.heat[k];
+	}
+	std::cout << "\n";
+	std::cout << "Working set estimate:";
+	for (std::size_t k = 0; k < stats.workingSet.size(); k++)
+		std::cout << " window:" << stats.workingSet[k].window << " pages:" << (std::uint64_t) (stats.workingSet[k].pages + 0.5);
+	std::cout << "\n";
+}
+
+template <std::size_t PageSize>
+BufStats BasicBufMgr<PageSize>::getBufStats() const
+{
+	BufStats stats = bufStats.snapshot();
+	std::lock_guard<std::mutex> lock(latch);
+	for (FrameId i = 0; i < numBufs; i++)
+	{
+		if (bufDescTable[i].valid)
+		{
+			std::size_t bucket = 0;
+			for (std::uint32_t hits = bufDescTable[i].hitCnt; hits != 0; hits >>= 1)
+				bucket++;
+			if (stats.heat.size() <= bucket)
+				stats.heat.resize(bucket + 1);
+			stats.heat[bucket]++;
+
+			FileBufStats& file = stats.files[bufDescTable[i].file->filename()];
+			file.resident++;
+			if (bufDescTable[i].dirty)
+				file.dirty++;
+		}
+	}
+	for (std::uint64_t window = numBufs; window <= 64 * (std::uint64_t) numBufs; window *= 4)
+	{
+		const WorkingSetPoint point = {window, workingSet.estimate(window)};
+		stats.workingSet.push_back(point);
+	}
+	const WorkingSetPoint all = {workingSet.accesses(), workingSet.estimate(workingSet.accesses())};
+	stats.workingSet.push_back(all);
+	return stats;
+}
+
+template <std::size_t PageSize>
+FileBufStats BasicBufMgr<PageSize>::getFileBufStats(const File* file) const
+{
+	const BufStats stats = getBufStats();
+	const std::map<std::string, FileBufStats>::const_iterator it = stats.files.find(file->filename());
+	return it == stats.files.end() ? FileBufStats() : it->second;
+}
+
+template <std::size_t PageSize>
+std::vector<DirtyPage> BasicBufMgr<PageSize>::getDirtyPages() const
+{
+	std::vector<DirtyPage> pages;
+	std::lock_guard<std::mutex> lock(latch);
+	for (FrameId i = 0; i < numBufs; i++)
+	{
+		const BufDesc& desc = bufDescTable[i];
+		if (desc.valid && desc.dirty)
+		{
+			const DirtyPage page = {desc.file->filename(), desc.pageNo, i, desc.recLsn};
+			pages.push_back(page);
+		}
+	}
+	return pages;
+}
+
+template <std::size_t PageSize>
+Lsn BasicBufMgr<PageSize>::redoLsn() const
+{
+	Lsn redo = log->endLsn();
+	for (FrameId i = 0; i < numBufs; i++)
+	{
+		const BufDesc& desc = bufDescTable[i];
+		if (desc.valid && desc.dirty)
+		{
+			// Dirtied before the log was attached: its changes may be anywhere in the log.
+			const Lsn rec = desc.recLsn == 0 ? WriteAheadLog::HEADER_SIZE : desc.recLsn;
+			if (rec < redo)
+				redo = rec;
+		}
+	}
+	return redo;
 }
 
+template <std::size_t PageSize>
+bool BasicBufMgr<PageSize>::checkpointPause(const std::chrono::steady_clock::time_point until)
+{
+	std::unique_lock<std::mutex> lock(checkpointerMutex);
+	return checkpointerWake.wait_until(lock, until, [this]() { return checkpointerStop; });
+}
+
+template <std::size_t PageSize>
+Lsn BasicBufMgr<PageSize>::checkpoint(const double pagesPerSecond)
+{
+	BufStatsShard& stats = bufStats.local();
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::uint64_t written = 0;
+	std::unique_lock<std::mutex> lock(latch);
+	const auto writable = [this](const FrameId frame)
+	{
+		return frame < numBufs && bufDescTable[frame].valid && bufDescTable[frame].dirty &&
+		       bufDescTable[frame].pinCnt == 0;
+	};
+	std::vector<FrameId> batch;
+	for (FrameId i = 0; i < numBufs; )
+	{
+		// Pages are written one at a time, or a batch at a time through a double-write buffer.
+		const std::uint32_t batchSize = doubleWrite ? doubleWrite->capacity() : 1;
+		Lsn lsn = 0;
+		batch.clear();
+		for (; i < numBufs && batch.size() < batchSize; i++)
+		{
+			if (writable(i))
+			{
+				batch.push_back(i);
+				lsn = std::max(lsn, bufPool[i]->lsn());
+			}
+		}
+		if (batch.empty())
+			break;
+		// Sync the log for the pages first, so the latch is not held through the sync.
+		WriteAheadLog* const pageLog = log;
+		if (pageLog && pageLog->durableLsn() < lsn)
+		{
+			lock.unlock();
+			pageLog->flush(lsn);
+			lock.lock();
+			// The pool may have shrunk, and the pages been pinned, written or replaced meanwhile.
+			batch.erase(std::remove_if(batch.begin(), batch.end(),
+			                           [&writable](const FrameId frame) { return !writable(frame); }),
+			            batch.end());
+		}
+		for (std::size_t j = 0; j < batch.size(); j++)
+		{
+			BufStatsShard::bump(stats.diskwrites);
+			BufStatsShard::bump(stats.checkpointWrites);
+			stats.bumpFile(bufDescTable[batch[j]].file->filename(), &FileBufStats::writes);
+		}
+		writeFrames(batch);
+		written += batch.size();
+
+		if (pagesPerSecond > 0)
+		{
+			const std::chrono::steady_clock::time_point due =
+				start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(written / pagesPerSecond));
+			lock.unlock();
+			const bool stopping = checkpointPause(due);
+			lock.lock();
+			if (stopping)
+				break;
+		}
+	}
+
+	BufStatsShard::bump(stats.checkpoints);
+	if (log == NULL)
+		return 0;
+	WriteAheadLog* const checkpointLog = log;
+	const Lsn redo = redoLsn();
+	const Lsn record = checkpointLog->appendCheckpoint(redo);
+	lock.unlock();
+	checkpointLog->markCheckpoint(record);
+	return redo;
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::startCheckpointer(const double pagesPerSecond,
+                                              const std::chrono::milliseconds interval)
+{
+	stopCheckpointer();
+	checkpointer = std::thread([this, pagesPerSecond, interval]()
+	{
+		do
+		{
+			try
+			{
+				checkpoint(pagesPerSecond);
+			}
+			catch(BadgerDbException&)
+			{
+			}
+		}
+		while (!checkpointPause(std::chrono::steady_clock::now() + interval));
+	});
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::stopCheckpointer()
+{
+	if (!checkpointer.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(checkpointerMutex);
+		checkpointerStop = true;
+	}
+	checkpointerWake.notify_all();
+	checkpointer.join();
+	std::lock_guard<std::mutex> lock(checkpointerMutex);
+	checkpointerStop = false;
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::startTrace(const std::string& filename)
+{
+	stopTrace();
+	PageTraceWriter* writer = new PageTraceWriter(filename, PageSize);
+	std::lock_guard<std::mutex> lock(latch);
+	delete trace;
+	trace = writer;
+}
+
+template <std::size_t PageSize>
+void BasicBufMgr<PageSize>::stopTrace()
+{
+	std::lock_guard<std::mutex> lock(latch);
+	delete trace;
+	trace = NULL;
+}
+
+#define BADGERDB_INSTANTIATE_BUF_MGR(size) template class BasicBufMgr<size>;
+BADGERDB_FOR_EACH_PAGE_SIZE(BADGERDB_INSTANTIATE_BUF_MGR)
+#undef BADGERDB_INSTANTIATE_BUF_MGR
+
 }
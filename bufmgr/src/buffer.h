@@ -7,25 +7,101 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "file.h"
 #include "bufHashTbl.h"
+#include "double_write_buffer.h"
+#include "page_trace.h"
+#include "buf_stats.h"
+#include "epoch_manager.h"
+#include "numa_topology.h"
+#include "working_set_estimator.h"
+#include "write_ahead_log.h"
 
 namespace badgerdb {
 
 /**
-* forward declaration of BufMgr class 
+* @brief Page replacement policies of a buffer pool
+*/
+enum BufPoolPolicy
+{
+	/**
+	 * Clock: a page survives one pass of the clock hand after it is referenced
+	 */
+	BUF_POOL_DEFAULT,
+
+	/**
+	 * For small, hot files: a page survives KEEP_EXTRA_PASSES more passes of the clock hand after
+	 * it is referenced, so a burst of other pages does not push it out
+	 */
+	BUF_POOL_KEEP,
+
+	/**
+	 * For large, scanned files: a page read in is the next victim unless it is referenced again
+	 * before the clock hand reaches it, so one pass over a file replaces only its own pages
+	 */
+	BUF_POOL_RECYCLE
+};
+
+/**
+* @brief Entry of the dirty page table: a page changed in the buffer pool since it was last written
+*/
+struct DirtyPage
+{
+	/**
+	 * Name of the file the page belongs to
+	 */
+  std::string filename;
+
+	/**
+	 * Number of the page in the file
+	 */
+  PageId pageNo;
+
+	/**
+	 * Frame holding the page
+	 */
+  FrameId frameNo;
+
+	/**
+	 * Log offset redo has to start from to recover the page's unwritten changes, or 0 if they were
+	 * made while no write-ahead log was attached
+	 */
+  Lsn recLsn;
+};
+
+/**
+* forward declaration of BasicBufMgr class 
 */
-class BufMgr;
+template <std::size_t PageSize> class BasicBufMgr;
 
 /**
 * @brief Class for maintaining information about buffer pool frames
 */
-class BufDesc {
+template <std::size_t PageSize>
+class BasicBufDesc {
 
-	friend class BufMgr;
+	friend class BasicBufMgr<PageSize>;
 
  private:
 	/**
+	 * Type of the files whose pages are held in the frame
+	 */
+	typedef BasicFile<PageSize> File;
+
+	/**
    * Pointer to file to which corresponding frame is assigned
 	 */
   File* file;
@@ -43,12 +119,12 @@ class BufDesc {
 	/**
    * Number of times this page has been pinned
 	 */
-  int pinCnt;
+  std::atomic<int> pinCnt;
 
 	/**
    * True if page is dirty;  false otherwise
 	 */
-  bool dirty;
+  std::atomic<bool> dirty;
 
 	/**
    * True if page is valid
@@ -58,7 +134,38 @@ class BufDesc {
 	/**
    * Has this buffer frame been reference recently
 	 */
-  bool refbit;
+  std::atomic<bool> refbit;
+
+	/**
+   * Number of readPage hits on the page since it was read into the frame
+	 */
+  std::uint32_t hitCnt;
+
+	/**
+   * Number of passes of the clock hand the page survives after refbit is next seen set
+	 */
+  std::atomic<std::uint8_t> extraPasses;
+
+	/**
+   * End of the log when the page was first logged dirty since it was last written, so redo of
+   * its changes starts there; 0 if the page is clean or was dirtied without a log
+	 */
+  Lsn recLsn;
+
+	/**
+   * Number of the pins in pinCnt held by snapshot readers reading the page in place
+	 */
+  int snapshotPins;
+
+	/**
+   * True while a handle returned by updatePage holds a copy of the page
+	 */
+  bool updating;
+
+	/**
+   * Number of the pins in pinCnt held by updatePage calls waiting for the update in progress
+	 */
+  int updateWaiters;
 
 	/**
    * Initialize buffer frame for a new user
@@ -67,10 +174,16 @@ class BufDesc {
 	{
     pinCnt = 0;
 		file = NULL;
-		pageNo = Page::INVALID_NUMBER;
+		pageNo = BasicPage<PageSize>::INVALID_NUMBER;
     dirty = false;
     refbit = false;
 		valid = false;
+		hitCnt = 0;
+		extraPasses = 0;
+		recLsn = 0;
+		snapshotPins = 0;
+		updating = false;
+		updateWaiters = 0;
   };
 
 	/**
@@ -88,6 +201,11 @@ class BufDesc {
     dirty = false;
     valid = true;
     refbit = true;
+    hitCnt = 0;
+    recLsn = 0;
+    snapshotPins = 0;
+    updating = false;
+    updateWaiters = 0;
   }
 
   void Print()
@@ -101,15 +219,37 @@ class BufDesc {
 			std::cout << "file:NULL ";
 
 		std::cout << "valid:" << valid << " ";
-		std::cout << "pinCnt:" << pinCnt << " ";
-		std::cout << "dirty:" << dirty << " ";
-		std::cout << "refbit:" << refbit << "\n";
+		std::cout << "pinCnt:" << pinCnt.load() << " ";
+		std::cout << "dirty:" << dirty.load() << " ";
+		std::cout << "refbit:" << refbit.load() << " ";
+		std::cout << "hits:" << hitCnt << "\n";
+  }
+
+	/**
+   * Copy a descriptor, e.g. into the new table when the pool is resized
+	 */
+  BasicBufDesc& operator=(const BasicBufDesc& other)
+	{
+		file = other.file;
+		pageNo = other.pageNo;
+		frameNo = other.frameNo;
+		pinCnt = other.pinCnt.load();
+		dirty = other.dirty.load();
+		valid = other.valid;
+		refbit = other.refbit.load();
+		hitCnt = other.hitCnt;
+		extraPasses = other.extraPasses.load();
+		recLsn = other.recLsn;
+		snapshotPins = other.snapshotPins;
+		updating = other.updating;
+		updateWaiters = other.updateWaiters;
+		return *this;
   }
 
 	/**
    * Constructor of BufDesc class 
 	 */
-  BufDesc()
+  BasicBufDesc()
 	{
   	Clear();
   }
@@ -117,174 +257,1391 @@ class BufDesc {
 
 
 /**
-* @brief Class to maintain statistics of buffer usage 
+* @brief A pin on a page in the buffer pool, released when the handle goes out of scope
+*
+* readPage and allocPage overloads return a handle instead of filling in a page pointer.  The
+* handle remembers the frame the page is pinned in, so releasing the pin goes straight to the
+* frame descriptor instead of looking the page up in the hash table again as unPinPage does.
+* Call markDirty() after changing the page; the page is unpinned dirty if it was called.
+*
+* A handle can be moved but not copied.  Do not also unpin its page with unPinPage, which
+* would drop a pin some other caller holds.
+*
+* A handle returned by updatePage holds a private copy of the page, which replaces the page in
+* the pool when it is released dirty.  A handle returned by readPage with a snapshot holds an image
+* of the page that must not be changed.
 */
-struct BufStats
+template <std::size_t PageSize>
+class BasicPageHandle
 {
+	friend class BasicBufMgr<PageSize>;
+
+ public:
 	/**
-   * Total number of accesses to buffer pool
+	 * Type of the page pinned
 	 */
-  int accesses;
+	typedef BasicPage<PageSize> Page;
 
 	/**
-   * Number of pages read from disk (including allocs)
+	 * Constructs a handle that holds no pin.
 	 */
-  int diskreads;
+  BasicPageHandle()
+		: mgr(NULL), frame(0), page(NULL), dirty(false), mode(PIN_FRAME)
+	{
+	}
 
 	/**
-   * Number of pages written back to disk
+	 * Takes over the pin held by another handle, leaving it empty.
 	 */
-  int diskwrites;
+  BasicPageHandle(BasicPageHandle&& other)
+		: mgr(other.mgr), frame(other.frame), page(other.page), dirty(other.dirty), mode(other.mode)
+	{
+		other.mgr = NULL;
+		other.page = NULL;
+	}
 
 	/**
-   * Clear all values 
+	 * Releases the pin held by this handle and takes over the one held by another handle.
 	 */
-  void clear()
-  {
-		accesses = diskreads = diskwrites = 0;
-  }
-      
+  BasicPageHandle& operator=(BasicPageHandle&& other)
+	{
+		if (this != &other)
+		{
+			release();
+			mgr = other.mgr;
+			frame = other.frame;
+			page = other.page;
+			dirty = other.dirty;
+			mode = other.mode;
+			other.mgr = NULL;
+			other.page = NULL;
+		}
+		return *this;
+	}
+
 	/**
-   * Constructor of BufStats class 
+	 * Unpins the page, dirty if markDirty() was called.
 	 */
-  BufStats()
-  {
-		clear();
-  }
+  ~BasicPageHandle()
+	{
+		release();
+	}
+
+	/**
+	 * Returns the pinned page, or NULL if the handle holds no pin.
+	 */
+  Page* get() const
+	{
+		return page;
+	}
+
+  Page* operator->() const
+	{
+		return page;
+	}
+
+  Page& operator*() const
+	{
+		return *page;
+	}
+
+	/**
+	 * Returns true if the handle holds a pin.
+	 */
+  explicit operator bool() const
+	{
+		return page != NULL;
+	}
+
+	/**
+	 * Returns the number of the pinned page in its file.
+	 */
+  PageId pageNumber() const
+	{
+		return page->page_number();
+	}
+
+	/**
+	 * Marks the page dirty, so it is written back before its frame is reused.  Has no effect on a
+	 * page read through a snapshot.
+	 */
+  void markDirty()
+	{
+		dirty = true;
+	}
+
+	/**
+	 * Unpins the page now instead of when the handle is destroyed, installing the copy held by a
+	 * handle from updatePage if it was marked dirty.  Does nothing if the handle holds no pin.
+	 */
+  void release()
+	{
+		if (mgr != NULL)
+		{
+			BasicBufMgr<PageSize>* owner = mgr;
+			Page* const held = page;
+			mgr = NULL;
+			page = NULL;
+			if (mode == PIN_FRAME)
+				owner->unPinHandle(frame, dirty);
+			else if (mode == PIN_SNAPSHOT)
+				owner->unPinSnapshot(frame, held);
+			else
+				owner->installUpdate(frame, held, dirty);
+		}
+	}
+
+ private:
+	/**
+	 * What a handle holds
+	 */
+  enum Mode
+	{
+		/**
+		 * A pin on the page in its frame
+		 */
+		PIN_FRAME,
+
+		/**
+		 * A pin on the image of the page a snapshot sees, in its frame or kept as an older version
+		 */
+		PIN_SNAPSHOT,
+
+		/**
+		 * A pin on the page in its frame and a private copy of it being updated
+		 */
+		PIN_UPDATE
+	};
+
+  BasicPageHandle(BasicBufMgr<PageSize>* mgr, const FrameId frame, Page* page,
+	                const Mode mode = PIN_FRAME)
+		: mgr(mgr), frame(frame), page(page), dirty(false), mode(mode)
+	{
+	}
+
+  BasicPageHandle(const BasicPageHandle&);
+  BasicPageHandle& operator=(const BasicPageHandle&);
+
+	/**
+	 * Buffer manager the page is pinned in, or NULL if the handle holds no pin
+	 */
+  BasicBufMgr<PageSize>* mgr;
+
+	/**
+	 * Frame the page is pinned in
+	 */
+  FrameId frame;
+
+	/**
+	 * Pinned page
+	 */
+  Page* page;
+
+	/**
+	 * True if the page is unpinned dirty
+	 */
+  bool dirty;
+
+	/**
+	 * What the handle holds
+	 */
+  Mode mode;
 };
 
 
 /**
-* @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file 
+* @brief A point in the sequence of updates made through BasicBufMgr::updatePage
+*
+* Pages read through a snapshot look as they did when it began, however they are updated
+* afterwards.  The snapshot ends when it is destroyed or released; handles on pages read through it
+* must be released first.  A snapshot can be moved but not copied.
 */
-class BufMgr 
+template <std::size_t PageSize>
+class BasicSnapshot
 {
- private:
+	friend class BasicBufMgr<PageSize>;
+
+ public:
+	/**
+	 * Constructs an object that holds no snapshot.
+	 */
+  BasicSnapshot()
+		: mgr(NULL), stamp(0)
+	{
+	}
+
 	/**
-   * Current position of clockhand in our buffer pool
+	 * Takes over the snapshot held by another object, leaving it empty.
 	 */
-  FrameId clockHand;
+  BasicSnapshot(BasicSnapshot&& other)
+		: mgr(other.mgr), stamp(other.stamp)
+	{
+		other.mgr = NULL;
+	}
 
 	/**
-   * Number of frames in the buffer pool
+	 * Ends the snapshot held by this object and takes over the one held by another object.
 	 */
-  std::uint32_t numBufs;
-	
+  BasicSnapshot& operator=(BasicSnapshot&& other)
+	{
+		if (this != &other)
+		{
+			release();
+			mgr = other.mgr;
+			stamp = other.stamp;
+			other.mgr = NULL;
+		}
+		return *this;
+	}
+
 	/**
-   * Hash table mapping (File, page) to frame
+	 * Ends the snapshot.
 	 */
-  BufHashTbl *hashTable;
+  ~BasicSnapshot()
+	{
+		release();
+	}
 
 	/**
-   * Array of BufDesc objects to hold information corresponding to every frame allocation from 'bufPool' (the buffer pool)
+	 * Returns true if the object holds a snapshot.
 	 */
-  BufDesc *bufDescTable;
+  explicit operator bool() const
+	{
+		return mgr != NULL;
+	}
+
+	/**
+	 * Returns the number of updates installed through the pool before the snapshot began.
+	 */
+  std::uint64_t timestamp() const
+	{
+		return stamp;
+	}
 
 	/**
-   * Maintains Buffer pool usage statistics 
+	 * Ends the snapshot now instead of when the object is destroyed.  Does nothing if the object
+	 * holds no snapshot.
 	 */
-  BufStats bufStats;
+  void release()
+	{
+		if (mgr != NULL)
+		{
+			BasicBufMgr<PageSize>* owner = mgr;
+			mgr = NULL;
+			owner->endSnapshot(stamp);
+		}
+	}
+
+ private:
+  BasicSnapshot(BasicBufMgr<PageSize>* mgr, const std::uint64_t stamp)
+		: mgr(mgr), stamp(stamp)
+	{
+	}
+
+  BasicSnapshot(const BasicSnapshot&);
+  BasicSnapshot& operator=(const BasicSnapshot&);
 
 	/**
-   * Advance clock to next frame in the buffer pool
+	 * Buffer manager the snapshot was taken of, or NULL if the object holds no snapshot
 	 */
-  void advanceClock();
+  BasicBufMgr<PageSize>* mgr;
 
 	/**
-	 * Allocate a free frame.  
-	 *
-	 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
-	 * @throws BufferExceededException If no such buffer is found which can be allocated
+	 * Commit timestamp the snapshot reads as of
 	 */
-  void allocBuf(FrameId & frame);
+  std::uint64_t stamp;
+};
 
+
+/**
+* @brief The central class which manages the buffer pool including frame allocation and deallocation to pages in the file 
+*
+* The buffer manager is templated on the page size of the files it caches, so a
+* pool of 4 KB frames for index files can sit beside a pool of 64 KB frames for
+* scanned files.  Use the BufMgr typedef for the default page size.
+*
+* The buffer manager is threadsafe.  A latch per pool protects the page table, the frame
+* descriptors and the files while pages are read and written; the clock sweep that finds
+* victims runs outside it, so threads that miss at the same time can look for victims together.
+* Callers that share a page must still coordinate changes to its contents.
+*
+* Dirty pages can be written back in the background by a fuzzy checkpoint, which goes through
+* the pool a page at a time at a limited rate while the pool stays in use, so the pages to redo
+* after a crash stay few without a burst of writes or a pause.
+*
+* Long readers can read through a snapshot instead of coordinating with writers.  A writer that
+* uses updatePage changes a private copy of the page, which becomes a new version of the page when
+* the handle is released.  If a snapshot may still need the previous image it is kept, and readers
+* of that snapshot go on reading it while the pool serves the new one.  Kept images are reclaimed
+* by epoch: the number of updates installed so far is the epoch, each snapshot stays in the epoch
+* it began in, and an image superseded in epoch T is freed once no snapshot from before T is left.
+* Changes made in place through readPage are not isolated from snapshots.
+*
+* Hot pages can be read optimistically, without the latch or a pin: readOptimistic reads a version
+* counter kept for each frame, reads the page, and checks the counter again, retrying if the frame
+* changed in between.  A reader writes no memory other threads use, so readers on many cores do not
+* contend for cache lines.  The counter changes when the frame gets another page and when an update
+* or a dirty unpin changes its page.  A page pinned through readPage or allocPage may be changed in
+* place at any time, so optimistic reads of its frame fail for as long as such a pin is held.
+*
+* Optimistic readers find pages in the page table and frames without the latch, so nothing they
+* may be reading is freed or reused at once.  Readers run inside an epoch of an EpochManager, and
+* pages that leave a frame, removed page table entries and replaced tables are retired to it and
+* reused or freed only once every reader that might hold them has left its epoch.  A page is read
+* into a fresh page rather than over the one the frame held, so optimistic readers only ever race
+* with changes made in place through readPage, and those fail validation.
+*
+* On a NUMA machine the frames can be split into one partition per node (setNumaTopology).  Frame
+* f belongs to node f % nodes, and the pages of a node's frames come from spare pages allocated by
+* a thread running on that node.  A miss takes a free or evictable frame of the missing thread's
+* node if there is one, and a thread whose node is not known places the page by a hash of its file
+* and number, so the pool's memory is used evenly.  Only the placement of pages changes; there is
+* still one page table and one latch.
+*/
+template <std::size_t PageSize>
+class BasicBufMgr 
+{
  public:
 	/**
-   * Actual buffer pool from which frames are allocated
+	 * Type of the pages held in the buffer pool
 	 */
-  Page* bufPool;
+	typedef BasicPage<PageSize> Page;
 
 	/**
-   * Constructor of BufMgr class
+	 * Type of the files whose pages are cached
 	 */
-  BufMgr(std::uint32_t bufs);
-	
+	typedef BasicFile<PageSize> File;
+
 	/**
-   * Destructor of BufMgr class
+	 * Type of the handles returned by readPage and allocPage
 	 */
-  ~BufMgr();
+	typedef BasicPageHandle<PageSize> PageHandle;
 
 	/**
-	 * Reads the given page from the file into a frame and returns the pointer to page.
-	 * If the requested page is already present in the buffer pool pointer to that frame is returned
-	 * otherwise a new frame is allocated from the buffer pool for reading the page.
-	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number in the file to be read
-	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+	 * Type of the double-write buffers pages can be written through
 	 */
-  void readPage(File* file, const PageId PageNo, Page*& page);
+	typedef BasicDoubleWriteBuffer<PageSize> DoubleWriteBuffer;
 
 	/**
-	 * Unpin a page from memory since it is no longer required for it to remain in memory.
-	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number
-	 * @param dirty		True if the page to be unpinned needs to be marked dirty	
-   * @throws  PageNotPinnedException If the page is not already pinned
+	 * Type of the snapshots returned by beginSnapshot
 	 */
-  void unPinPage(File* file, const PageId PageNo, const bool dirty);
+	typedef BasicSnapshot<PageSize> Snapshot;
+
+ private:
+	friend class BasicPageHandle<PageSize>;
+	friend class BasicSnapshot<PageSize>;
 
 	/**
-	 * Allocates a new, empty page in the file and returns the Page object.
-	 * The newly allocated page is also assigned a frame in the buffer pool.
-	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
-	 * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+	 * An image of a page superseded by an update that snapshots from before the update still read
 	 */
-  void allocPage(File* file, PageId &PageNo, Page*& page); 
+	struct PageVersion
+	{
+		/**
+		 * The image
+		 */
+		Page* page;
+
+		/**
+		 * Commit timestamp of the update that superseded the image; snapshots with an older timestamp
+		 * read it
+		 */
+		std::uint64_t end;
+
+		/**
+		 * Number of snapshot readers holding the image
+		 */
+		int pins;
+
+		/**
+		 * True once the image has been unlinked from its page; it is freed when the last pin goes
+		 */
+		bool obsolete;
+
+		/**
+		 * Next older image of the same page, or NULL
+		 */
+		PageVersion* older;
+
+		/**
+		 * Node of the frame the image came from, whose spare pages it goes back to
+		 */
+		std::uint32_t node;
+	};
 
 	/**
-	 * Writes out all dirty pages of the file to disk.
-	 * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
-	 * Otherwise Error returned.
-	 *
-	 * @param file   	File object
-   * @throws  PagePinnedException If any page of the file is pinned in the buffer pool 
-   * @throws BadBufferException If any frame allocated to the file is found to be invalid
+	 * Context of a retired page: the spare pages of one node of a pool
 	 */
-  void flushFile(const File* file);
+	struct PageHome
+	{
+		BasicBufMgr<PageSize>* mgr;
+		std::uint32_t node;
+	};
 
 	/**
-	 * Delete page from file and also from buffer pool if present.
-	 * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
-	 *
-	 * @param file   	File object
-	 * @param PageNo  Page number
+	 * Page a chain of versions belongs to
 	 */
-  void disposePage(File* file, const PageId PageNo);
+	typedef std::pair<const File*, PageId> PageKey;
 
 	/**
-   * Print member variable values. 
+	 * What optimistic readers see of a frame, one cache line per frame.  Written with the latch
+	 * held, read without it.
 	 */
-  void  printSelf();
+	struct alignas(64) FrameLatch
+	{
+		/**
+		 * Odd while the frame is changing; advanced by two for each change
+		 */
+		std::atomic<std::uint64_t> version;
+
+		/**
+		 * File of the page in the frame, or NULL if the frame holds no page
+		 */
+		std::atomic<const File*> file;
+
+		/**
+		 * The page in the frame
+		 */
+		std::atomic<Page*> page;
+
+		/**
+		 * Number of the page in the frame
+		 */
+		std::atomic<PageId> pageNo;
+
+		/**
+		 * Pins through which the page may be changed in place (readPage and allocPage); optimistic
+		 * reads of the frame fail while there are any
+		 */
+		std::atomic<std::uint32_t> writers;
+
+		/**
+		 * Set by optimistic readers; the clock hand treats it like the reference bit
+		 */
+		std::atomic<bool> referenced;
+	};
+
+	static_assert(sizeof(FrameLatch) == 64, "a frame latch must fill exactly one cache line");
 
 	/**
-   * Get buffer pool usage statistics
+	 * The frame latches of a pool of a given size.  resize() replaces the table and retires the old
+	 * one, every latch of it odd, so readers still using it fail validation.  The latches are
+	 * allocated on a cache line boundary, which new[] does not guarantee for them.
 	 */
-  BufStats & getBufStats()
-  {
-		return bufStats;
-  }
+	struct FrameLatchTable
+	{
+		std::uint32_t size;
+		FrameLatch* latches;
+
+		~FrameLatchTable()
+		{
+			std::free(latches);
+		}
+	};
 
 	/**
-   * Clear buffer pool usage statistics
+	 * Type of the frame descriptors
 	 */
-  void clearBufStats() 
-  {
-		bufStats.clear();
-  }
-};
+	typedef BasicBufDesc<PageSize> BufDesc;
+
+	/**
+	 * Type of the hash table mapping pages to frames
+	 */
+	typedef BasicBufHashTbl<PageSize> BufHashTbl;
+
+	/**
+   * Number of frames the clock hand has passed; it points at frame clockHand % numBufs.  A
+   * sweeping thread claims each frame it examines with fetch_add, so concurrent sweeps examine
+   * different frames.
+	 */
+  std::atomic<std::uint64_t> clockHand;
+
+	/**
+   * Protects the page table, the frame descriptors apart from the atomic fields the sweep
+   * reads and ages, the free list, the ready queue, the statistics that are not per thread
+   * and the files being read and written through the pool
+	 */
+  mutable std::mutex latch;
+
+	/**
+   * Number of threads sweeping without the latch, which resize() waits for before it
+   * reallocates the frame descriptors
+	 */
+  std::atomic<int> sweepers;
+
+	/**
+   * Number of frames in the buffer pool
+	 */
+  std::uint32_t numBufs;
+	
+	/**
+   * Hash table mapping (File, page) to frame
+	 */
+  BufHashTbl *hashTable;
+
+	/**
+   * Array of BufDesc objects to hold information corresponding to every frame allocation from 'bufPool' (the buffer pool)
+	 */
+  BufDesc *bufDescTable;
+
+	/**
+   * Maintains Buffer pool usage statistics, one shard per thread
+	 */
+  BufStatsCollector bufStats;
+
+	/**
+   * Page replacement policy
+	 */
+  BufPoolPolicy policy;
+
+	/**
+   * Estimates the number of distinct pages referenced recently
+	 */
+  WorkingSetEstimator workingSet;
+
+	/**
+   * Trace being recorded, or NULL if tracing is off
+	 */
+  PageTraceWriter* trace;
+
+	/**
+   * Write-ahead log that dirty pages are logged to, or NULL if logging is off
+	 */
+  WriteAheadLog* log;
+
+	/**
+   * Double-write buffer dirty pages are written through, or NULL if pages are written directly
+	 */
+  DoubleWriteBuffer* doubleWrite;
+
+	/**
+   * Frames holding no page, used before the clock looks for a victim.  Frames are added when the
+   * pool is created or grown and when flushFile or disposePage empties them.
+	 */
+  std::vector<FrameId> freeFrames;
+
+	/**
+   * Victims found by the last sweeps, in clock order.  A frame is checked again before it is
+   * evicted, since it may have been referenced since it was queued.
+	 */
+  std::deque<FrameId> readyFrames;
+
+	/**
+   * Page held by each frame, or NULL for a frame that has never been used.  Pages are allocated
+   * when a frame is first needed, so growing the pool does not touch memory, and a frame's page
+   * never moves while it is pinned through readPage or allocPage, so pointers they return stay
+   * valid across resize().  Installing an update replaces the page of a frame no one else has
+   * pinned, or that only snapshot readers have pinned, rather than copying it.
+	 */
+  Page** bufPool;
+
+	/**
+   * Thread running fuzzy checkpoints, if startCheckpointer() started one
+	 */
+  std::thread checkpointer;
+
+	/**
+   * Protects checkpointerStop; the checkpointer waits on checkpointerWake between writes and
+   * between checkpoints
+	 */
+  std::mutex checkpointerMutex;
+  std::condition_variable checkpointerWake;
+
+	/**
+   * Set by stopCheckpointer() to end the checkpoint in progress and the checkpointer thread
+	 */
+  bool checkpointerStop;
+
+	/**
+   * Number of updates installed through updatePage; the commit timestamp of the latest one
+	 */
+  std::uint64_t commitClock;
+
+	/**
+   * Timestamps of the snapshots that have not ended
+	 */
+  std::multiset<std::uint64_t> activeSnapshots;
+
+	/**
+   * Kept images of each page, newest first, so their end timestamps decrease along a chain
+	 */
+  std::map<PageKey, PageVersion*> versions;
+
+	/**
+   * Version holding each kept image, to find it again when a snapshot reader releases it
+	 */
+  std::map<const Page*, PageVersion*> versionPages;
+
+	/**
+   * Kept images by the timestamp they were superseded at, oldest first; the oldest image of a page
+   * is the last of its chain
+	 */
+  std::deque<std::pair<std::uint64_t, PageKey> > closedVersions;
+
+	/**
+   * Signalled when an update is installed or a snapshot reader releases a page in place; waited on
+   * with the latch
+	 */
+  std::condition_variable versionChanged;
+
+	/**
+   * Latches of the frames of the pool, read by optimistic readers without the latch
+	 */
+  std::atomic<FrameLatchTable*> frameLatches;
+
+	/**
+   * Reclaims what optimistic readers may still be reading: pages that have left a frame or a
+   * version chain, page table entries and bucket arrays, and latch tables
+	 */
+  EpochManager epochs;
+
+	/**
+   * Pages no reader can still be reading, to be reused for copies and loads, one list per node; at
+   * most a node's share of numBufs are kept and the rest freed
+	 */
+  std::vector<std::vector<Page*> > sparePages;
+
+	/**
+   * Context each node's retired pages are retired with; a deque, so the addresses pending
+   * retirements hold stay valid as nodes are added, and never shrunk
+	 */
+  std::deque<PageHome> pageHomes;
+
+	/**
+   * Topology the pool accounts accesses by, or NULL
+	 */
+  const NumaTopology* numa;
+
+	/**
+   * Number of partitions the frames are split into: the nodes of numa if partitioned, else 1
+	 */
+  std::uint32_t numaNodes;
+
+	/**
+   * Number of hash table buckets for a pool of the given size
+	 */
+  static int hashTableSize(const std::uint32_t bufs)
+  {
+		return ((((int) (bufs * 1.2))*2)/2)+1;
+  }
+
+	/**
+	 * Mark a frame referenced according to the replacement policy
+	 *
+	 * @param frame		Frame referenced
+	 * @param loaded	True if the page was just read into or allocated in the frame
+	 */
+  void reference(const FrameId frame, const bool loaded);
+
+	/**
+   * Number of victims one sweep looks for in a pool of the given size
+	 */
+  static std::uint32_t evictBatch(const std::uint32_t bufs)
+  {
+		return bufs / 64 == 0 ? 1 : (bufs / 64 < EVICT_BATCH ? bufs / 64 : EVICT_BATCH);
+  }
+
+	/**
+	 * Advance the clock hand until evictBatch() victims are found or every frame has had the
+	 * chance to lose its reference, and add the victims to the ready queue.  The latch is released
+	 * during the sweep.
+	 *
+	 * @param lock		Lock on the latch, held on entry and on return
+	 * @param node		Node a victim is wanted on; the sweep goes on past evictBatch() victims, up to
+	 *					EVICT_BATCH, until it finds one.  -1 for any node.
+	 * @throws BufferExceededException If no frame can be evicted
+	 */
+  void sweep(std::unique_lock<std::mutex>& lock, const int node = -1);
+
+	/**
+	 * Append an image of the page in a frame to the log and stamp the page with the record's LSN.
+	 * Called with the latch held.
+	 */
+  void logFrame(const FrameId frame);
+
+	/**
+	 * Write the page in a frame to its file, once the log is durable up to the page's LSN.  Called
+	 * with the latch held.
+	 */
+  void writeFrame(const FrameId frame);
+
+	/**
+	 * Write the pages in several frames to their files, through the double-write buffer if one is
+	 * attached, once the log is durable up to the largest of their LSNs.  Called with the latch
+	 * held.
+	 */
+  void writeFrames(const std::vector<FrameId>& frames);
+
+	/**
+	 * Write back the page in a frame if it is dirty and remove it from the page table, leaving the
+	 * frame empty.  Called with the latch held.
+	 *
+	 * If the log records of the pages to write are not yet durable and syncLog is set, the latch is
+	 * released while the log is synced and nothing is evicted: the frame may have been referenced,
+	 * pinned or reused meanwhile, so the caller checks it again.
+	 *
+	 * @param lock		Lock on the latch, held on entry and on return
+	 * @param syncLog	True to release the latch for a log sync; false to sync with it held
+	 * @return False if the latch was released and the frame not evicted
+	 */
+  bool evict(const FrameId frame, std::unique_lock<std::mutex>& lock, const bool syncLog);
+
+	/**
+	 * Log offset redo has to start from: the smallest recLsn of a dirty page, or the end of the log
+	 * if no page is dirty.  Called with the latch held and a log attached.
+	 */
+  Lsn redoLsn() const;
+
+	/**
+	 * Wait until the given time or until stopCheckpointer() is called.
+	 *
+	 * @return True if the checkpointer is being stopped
+	 */
+  bool checkpointPause(const std::chrono::steady_clock::time_point until);
+
+	/**
+	 * Allocate a free frame: an empty one if there is one, else a victim from the ready queue,
+	 * sweeping for more victims when the queue runs dry.
+	 *
+	 * @param frame   	Frame reference, frame ID of allocated frame returned via this variable
+	 * @param lock		Lock on the latch, held on entry and on return but released while sweeping
+	 * @param node		Node whose frames are preferred, or -1 for none
+	 * @throws BufferExceededException If no such buffer is found which can be allocated
+	 */
+  void allocBuf(FrameId & frame, std::unique_lock<std::mutex>& lock, const int node = -1);
+
+	/**
+	 * Node of the partition a frame belongs to
+	 */
+  std::uint32_t frameNode(const FrameId frame) const
+  {
+		return frame % numaNodes;
+  }
+
+	/**
+	 * Node a miss on the page prefers frames of: the missing thread's node, or if it has none one
+	 * chosen by a hash of the page; -1 if the pool is not partitioned
+	 */
+  int missNode(const File* file, const PageId pageNo, const int threadNode) const;
+
+	/**
+	 * Count an access to a frame as local or remote to the thread's node
+	 */
+  void countNodeAccess(BufStatsShard& stats, const FrameId frame, const int threadNode);
+
+	/**
+	 * How readFrame leaves the page it reads
+	 */
+  enum PinKind
+	{
+		/**
+		 * Read into a frame without a pin
+		 */
+		PIN_NONE,
+
+		/**
+		 * Pinned for a caller that does not change the page in the frame: an update or a snapshot
+		 */
+		PIN_SHARED,
+
+		/**
+		 * Pinned for a caller that may change the page in the frame in place
+		 */
+		PIN_IN_PLACE
+	};
+
+	/**
+	 * Pin the given page, reading it into a frame if it is not in the buffer pool.
+	 *
+	 * @param pin	How to pin the page
+	 * @return Frame holding the page
+	 */
+  FrameId readFrame(File* file, const PageId pageNo, const PinKind pin = PIN_IN_PLACE);
+
+	/**
+	 * readFrame() with the latch already held.
+	 *
+	 * @param lock		Lock on the latch, held on entry and on return but released while sweeping
+	 */
+  FrameId readFrame(File* file, const PageId pageNo, std::unique_lock<std::mutex>& lock,
+                    const PinKind pin = PIN_IN_PLACE);
+
+	/**
+	 * Allocate a new page in the file and pin it in a frame.
+	 *
+	 * @param pageNo	Number assigned to the page in the file is returned via this reference
+	 * @return Frame holding the page
+	 */
+  FrameId allocFrame(File* file, PageId &pageNo);
+
+	/**
+	 * Drop one pin on the page in a frame.
+	 *
+	 * @param inPlace	True if the pin was taken with PIN_IN_PLACE or by allocFrame
+	 * @throws  PageNotPinnedException If the page is not pinned
+	 */
+  void unPinFrame(const FrameId frame, const bool dirty, const bool inPlace);
+
+	/**
+	 * unPinPage for a page pinned through a PageHandle, which already knows the frame.
+	 */
+  void unPinHandle(const FrameId frame, const bool dirty);
+
+	/**
+	 * Release a page read through a snapshot, in its frame or as a kept image.
+	 */
+  void unPinSnapshot(const FrameId frame, Page* page);
+
+	/**
+	 * Release a page pinned by updatePage, replacing the page in its frame with the updated copy if
+	 * it is dirty.
+	 */
+  void installUpdate(const FrameId frame, Page* copy, const bool dirty);
+
+	/**
+	 * End a snapshot and reclaim the images only it still needed.
+	 */
+  void endSnapshot(const std::uint64_t stamp);
+
+	/**
+	 * The kept image of a page that a snapshot with the given timestamp reads, or NULL if it reads
+	 * the page in its frame.  Called with the latch held.
+	 */
+  PageVersion* visibleVersion(const File* file, const PageId pageNo, const std::uint64_t stamp);
+
+	/**
+	 * Unlink the kept images no snapshot reads any more and free those not pinned.  Called with the
+	 * latch held.
+	 */
+  void reclaimVersions();
+
+	/**
+	 * Free a kept image.  Called with the latch held.
+	 */
+  void freeVersion(PageVersion* version);
+
+	/**
+	 * A spare page of the node, or a new one.  Called with the latch held.
+	 */
+  Page* takePage(const std::uint32_t node);
+
+	/**
+	 * Retire a page that has left a frame or a version chain, to be reused by the node once no
+	 * optimistic reader can be reading it.  Called with the latch held.
+	 */
+  void retirePage(Page* page, const std::uint32_t node);
+
+	/**
+	 * Reclaim function of retired pages: adds the page to the spare pages of its node, or frees it
+	 * if enough are kept.  Called with the latch held.
+	 */
+  static void reusePage(void* page, void* home);
+
+	/**
+	 * Allocate up to each node's share of spare pages, each node's from a thread bound to it.
+	 * Called with the latch held.
+	 */
+  void fillSparePages();
+
+	/**
+	 * Make the latch of a frame odd, so optimistic reads of it in progress fail.  Called with the
+	 * latch held before the frame or its page is changed.
+	 */
+  void beginFrameChange(const FrameId frame);
+
+	/**
+	 * Publish the page a frame now holds, or that it holds none, to optimistic readers, ending the
+	 * change begun by beginFrameChange.  Called with the latch held.
+	 */
+  void endFrameChange(const FrameId frame);
+
+	/**
+	 * Count a pin through which the page in a frame may be changed in place, so optimistic reads of
+	 * the frame fail until it is dropped.  Called with the latch held before the pin is handed out.
+	 */
+  void beginInPlacePin(const FrameId frame);
+
+	/**
+	 * Drop a pin counted by beginInPlacePin.  Called with the latch held, after a dirty unpin has
+	 * changed the frame's version.
+	 */
+  void endInPlacePin(const FrameId frame);
+
+	/**
+	 * Allocate a latch table for a pool of the given size, every frame empty
+	 */
+  static FrameLatchTable* newFrameLatches(const std::uint32_t bufs);
+
+ public:
+	/**
+   * Constructor of BufMgr class
+	 */
+  BasicBufMgr(std::uint32_t bufs);
+	
+	/**
+   * Destructor of BufMgr class
+	 */
+  ~BasicBufMgr();
+
+	/**
+	 * Reads the given page from the file into a frame and returns the pointer to page.
+	 * If the requested page is already present in the buffer pool pointer to that frame is returned
+	 * otherwise a new frame is allocated from the buffer pool for reading the page.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param page  	Reference to page pointer. Used to fetch the Page object in which requested page from file is read in.
+	 */
+  void readPage(File* file, const PageId PageNo, Page*& page);
+
+	/**
+	 * Reads the given page like readPage above, returning a handle that unpins it when destroyed.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @return Handle on the pinned page
+	 */
+  PageHandle readPage(File* file, const PageId PageNo);
+
+	/**
+	 * Reads the given page as it was when a snapshot began.  The page is read through the pool as by
+	 * readPage unless it has been updated through updatePage since, in which case the image kept for
+	 * the snapshot is returned.  The page must not be changed.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param snapshot	Snapshot to read as of
+	 * @return Handle on the image of the page
+	 */
+  PageHandle readPage(File* file, const PageId PageNo, const Snapshot& snapshot);
+
+	/**
+	 * Pins the given page for an update isolated from snapshots.  The handle holds a private copy of
+	 * the page; changes to it are installed in the pool when the handle is released after
+	 * markDirty(), as one update with the next commit timestamp.  Another update of the same page
+	 * waits until then.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be updated
+	 * @return Handle on a copy of the page
+	 */
+  PageHandle updatePage(File* file, const PageId PageNo);
+
+	/**
+	 * Reads the given page optimistically: calls reader with the page, without the latch and
+	 * without pinning it, and calls it again if the frame changed while it ran.  Once the frame
+	 * has changed OPTIMISTIC_ATTEMPTS times, or if the page is not in the pool, reader is called
+	 * with the latch held instead, after reading the page into the pool if need be.  Only the last
+	 * call of reader saw a consistent page; earlier ones may see torn data, so reader must only
+	 * read the page, must not loop on what it reads or call the buffer manager, and should keep its
+	 * results in variables it overwrites on each call.  An exception reader throws on a frame that
+	 * then turns out to have changed is dropped and the read retried.
+	 *
+	 * The page is consistent with updates installed through updatePage, with pages loaded and
+	 * evicted, and with changes made in place through readPage or allocPage: the frame of a page
+	 * pinned that way is not read optimistically.  A reader that falls back to the latch reads such
+	 * a page as any pinned reader would, and is only consistent with the pin holder's changes if it
+	 * coordinates with the pin holder like one.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number in the file to be read
+	 * @param hint		Frame the page was in when last read; set to the frame it was found in.  Any
+	 * 					value works, but a right guess saves looking the page up.
+	 * @param reader	Called with a const Page&
+	 */
+  template <typename Reader>
+  void readOptimistic(File* file, const PageId PageNo, FrameId& hint, Reader reader)
+  {
+		BufStatsShard& stats = bufStats.local();
+		{
+			EpochGuard guard(epochs);
+			for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++)
+			{
+				FrameLatchTable* const table = frameLatches.load(std::memory_order_acquire);
+				if (hint < table->size)
+				{
+					FrameLatch& frame = table->latches[hint];
+					const std::uint64_t version = frame.version.load(std::memory_order_acquire);
+					const bool holds = frame.file.load(std::memory_order_relaxed) == file &&
+					                   frame.pageNo.load(std::memory_order_relaxed) == PageNo;
+					const bool pinnedInPlace = frame.writers.load(std::memory_order_relaxed) > 0;
+					if ((version & 1) == 0 && holds && !pinnedInPlace)
+					{
+						const Page& page = *frame.page.load(std::memory_order_acquire);
+						try
+						{
+							reader(page);
+						}
+						catch(...)
+						{
+							std::atomic_thread_fence(std::memory_order_acquire);
+							if (frame.version.load(std::memory_order_relaxed) == version &&
+							    frame.writers.load(std::memory_order_relaxed) == 0)
+								throw;
+							BufStatsShard::bump(stats.optimisticRetries);
+							continue;
+						}
+						// A pin taken meanwhile may still be changing the page; one already dropped changed the
+						// version if it changed the page.
+						std::atomic_thread_fence(std::memory_order_acquire);
+						if (frame.version.load(std::memory_order_relaxed) == version &&
+						    frame.writers.load(std::memory_order_relaxed) == 0)
+						{
+							// Written only when the clock hand has cleared it, so hot frames stay in every cache.
+							if (!frame.referenced.load(std::memory_order_relaxed))
+								frame.referenced.store(true, std::memory_order_relaxed);
+							BufStatsShard::bump(stats.optimisticReads);
+							return;
+						}
+						BufStatsShard::bump(stats.optimisticRetries);
+						continue;
+					}
+					// A pin for changes in place may be held for long; waiting out one is not worth retries.
+					if (holds && pinnedInPlace)
+						break;
+					if (version & 1)
+					{
+						BufStatsShard::bump(stats.optimisticRetries);
+						continue;
+					}
+				}
+				if (!hashTable->find(file, PageNo, hint))
+					break;
+			}
+		}
+
+		// Read under the latch rather than with a pin, so updates of the page are still installed
+		// without copying over the page other optimistic readers see.
+		BufStatsShard::bump(stats.optimisticFallbacks);
+		for (;;)
+		{
+			{
+				std::lock_guard<std::mutex> lock(latch);
+				if (hashTable->find(file, PageNo, hint))
+				{
+					reference(hint, false);
+					reader(static_cast<const Page&>(*bufPool[hint]));
+					return;
+				}
+			}
+			readFrame(file, PageNo, PIN_NONE);
+		}
+  }
+
+	/**
+	 * Begins a snapshot of the pages in the pool.  Pages read through it look as they did now,
+	 * however they are updated through updatePage later.
+	 *
+	 * @return The snapshot, which ends when it is destroyed
+	 */
+  Snapshot beginSnapshot();
+
+	/**
+	 * Get the number of superseded page images kept for snapshots
+	 */
+  std::size_t numVersions() const
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		return versionPages.size();
+  }
+
+	/**
+	 * Unpin a page from memory since it is no longer required for it to remain in memory.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number
+	 * @param dirty		True if the page to be unpinned needs to be marked dirty	
+   * @throws  PageNotPinnedException If the page is not already pinned
+	 */
+  void unPinPage(File* file, const PageId PageNo, const bool dirty);
+
+	/**
+	 * Allocates a new, empty page in the file and returns the Page object.
+	 * The newly allocated page is also assigned a frame in the buffer pool.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @param page  	Reference to page pointer. The newly allocated in-memory Page object is returned via this reference.
+	 */
+  void allocPage(File* file, PageId &PageNo, Page*& page); 
+
+	/**
+	 * Allocates a new page like allocPage above, returning a handle that unpins it when destroyed.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number. The number assigned to the page in the file is returned via this reference.
+	 * @return Handle on the pinned page
+	 */
+  PageHandle allocPage(File* file, PageId &PageNo);
+
+	/**
+	 * Writes out all dirty pages of the file to disk.
+	 * All the frames assigned to the file need to be unpinned from buffer pool before this function can be successfully called.
+	 * Otherwise Error returned.
+	 *
+	 * @param file   	File object
+   * @throws  PagePinnedException If any page of the file is pinned in the buffer pool 
+   * @throws BadBufferException If any frame allocated to the file is found to be invalid
+	 */
+  void flushFile(const File* file);
+
+	/**
+	 * Delete page from file and also from buffer pool if present.
+	 * Since the page is entirely deleted from file, its unnecessary to see if the page is dirty.
+	 *
+	 * @param file   	File object
+	 * @param PageNo  Page number
+   * @throws  PagePinnedException If the page is pinned in the buffer pool; neither the pool nor the file is changed
+	 */
+  void disposePage(File* file, const PageId PageNo);
+
+	/**
+	 * Change the number of frames in the buffer pool without discarding the pages it holds.
+	 *
+	 * Growing adds frames at the end of the pool and rehashes the page table; the new frames
+	 * take memory only once they are used.  Shrinking evicts the pages in the frames at the end
+	 * of the pool, writing dirty ones back to disk, and frees them.  Pinned pages keep their
+	 * frames and their addresses either way.
+	 *
+	 * @param newFrames	New number of frames, at least 1
+	 * @throws  InvalidPoolSizeException If newFrames is 0
+	 * @throws  PagePinnedException If shrinking and a frame to be removed holds a pinned page;
+	 *                              the pool is left unchanged
+	 */
+  void resize(const std::uint32_t newFrames);
+
+	/**
+	 * Get the number of frames in the buffer pool
+	 */
+  std::uint32_t numFrames() const
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		return numBufs;
+  }
+
+	/**
+	 * Number of extra passes of the clock hand a page survives under BUF_POOL_KEEP
+	 */
+  static const std::uint8_t KEEP_EXTRA_PASSES = 2;
+
+	/**
+	 * Largest number of victims a sweep of the clock hand looks for at once.  A sweep looks for
+	 * one victim per 64 frames in the pool, at least one and at most EVICT_BATCH.
+	 */
+  static const std::uint32_t EVICT_BATCH = 16;
+
+	/**
+	 * Number of times readOptimistic tries to read a page before it pins it instead
+	 */
+  static const int OPTIMISTIC_ATTEMPTS = 8;
+
+	/**
+	 * Set the page replacement policy.  Pages already in the pool keep their reference state.
+	 *
+	 * @param newPolicy	Policy to use from now on
+	 */
+  void setPolicy(const BufPoolPolicy newPolicy)
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		policy = newPolicy;
+  }
+
+	/**
+	 * Get the page replacement policy
+	 */
+  BufPoolPolicy getPolicy() const
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		return policy;
+  }
+
+	/**
+   * Print member variable values and the buffer usage of each file.
+	 */
+  void  printSelf();
+
+	/**
+   * Get buffer pool usage statistics, summed over all threads, including the usage of each file
+	 */
+  BufStats getBufStats() const;
+
+	/**
+	 * Get buffer pool usage of one file: the frames holding its pages now and its hits, misses and
+	 * writes since the statistics were last cleared.  Files are identified by name, so all File
+	 * objects open on the same file share one set of counters.
+	 *
+	 * @param file   	File object
+	 */
+  FileBufStats getFileBufStats(const File* file) const;
+
+	/**
+   * Clear buffer pool usage statistics
+	 */
+  void clearBufStats() 
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		bufStats.clear();
+		workingSet.clear();
+  }
+
+	/**
+	 * Estimate the number of distinct pages referenced by the most recent readPage and allocPage
+	 * requests.  A pool with fewer frames than the working set over a window of a few times its
+	 * size will thrash.  The estimate samples pages by hash in fixed memory and is exact for
+	 * working sets of up to WorkingSetEstimator::DEFAULT_MAX_SAMPLES pages.
+	 *
+	 * @param window	Number of most recent requests to consider
+	 */
+  double estimateWorkingSet(const std::uint64_t window) const
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		return workingSet.estimate(window);
+  }
+
+	/**
+	 * Attach a write-ahead log, or detach it with NULL.  While a log is attached, unpinning a page
+	 * dirty appends an image of the page to the log and stamps the page with the record's LSN, and
+	 * a dirty page is written to its file only after the log is durable up to that LSN.  Changes
+	 * are then durable once the log is flushed; the pages can be written back later.
+	 *
+	 * @param newLog	Log to use, which must outlive its use by the pool, or NULL
+	 */
+  void setLog(WriteAheadLog* newLog)
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		log = newLog;
+  }
+
+	/**
+	 * Get the attached write-ahead log, or NULL if none is attached
+	 */
+  WriteAheadLog* getLog() const
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		return log;
+  }
+
+	/**
+	 * Attach a double-write buffer, or detach it with NULL.  While one is attached, dirty pages are
+	 * written in batches: each batch is written and synced to the double-write file before its
+	 * pages are written in place, so DoubleWriteBuffer::repair() can fix a page torn by a crash.
+	 * Evicting a dirty page also writes the other dirty pages queued for eviction, and flushFile,
+	 * checkpoint and the destructor write up to a batch at a time.
+	 *
+	 * @param newDoubleWrite	Buffer to use, which must outlive its use by the pool, or NULL
+	 */
+  void setDoubleWrite(DoubleWriteBuffer* newDoubleWrite)
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		doubleWrite = newDoubleWrite;
+  }
+
+	/**
+	 * Split the frames into one partition per node of a topology, or stop accounting by node with
+	 * NULL.  Frame f belongs to node f % nodes, each node gets its share of spare pages allocated by
+	 * a thread bound to it, and misses prefer frames of the missing thread's node.  Pages already in
+	 * the pool stay where they are until they leave it, so this is best called on a new pool.
+	 *
+	 * Either way accesses through readPage, updatePage and allocPage by threads whose node is known are counted
+	 * in BufStats::localAccesses and BufStats::remoteAccesses.  Without partitions every frame counts
+	 * as being on node 0, like a pool allocated by a single thread there.
+	 *
+	 * @param topology	Topology to use, which must outlive its use by the pool, or NULL
+	 * @param partition	False to only count accesses, leaving the frames unpartitioned
+	 */
+  void setNumaTopology(const NumaTopology* topology, const bool partition = true);
+
+	/**
+	 * Get the topology set by setNumaTopology, or NULL
+	 */
+  const NumaTopology* getNumaTopology() const
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		return numa;
+  }
+
+	/**
+	 * Get the attached double-write buffer, or NULL if none is attached
+	 */
+  DoubleWriteBuffer* getDoubleWrite() const
+  {
+		std::lock_guard<std::mutex> lock(latch);
+		return doubleWrite;
+  }
+
+	/**
+	 * Get the dirty page table: every page in the pool changed since it was last written, with the
+	 * log offset redo of its changes starts from.
+	 */
+  std::vector<DirtyPage> getDirtyPages() const;
+
+	/**
+	 * Run a fuzzy checkpoint: write back the dirty pages in the pool one at a time, while other
+	 * threads keep using it, then log where redo has to start.  The latch is held only while one
+	 * page is written, and the log is synced for a page before the latch is taken for it, so
+	 * readPage waits for at most one page write.  Pages pinned when the checkpoint reaches them
+	 * stay dirty.
+	 *
+	 * With a write-ahead log attached, a LOG_CHECKPOINT record holding redoLsn, the smallest
+	 * recLsn of the pages still dirty at the end, is appended and flushed.  Recovery replays the
+	 * log from there.  The record covers this pool's pages only, so a log shared by several pools
+	 * should be checkpointed through all of them.
+	 *
+	 * @param pagesPerSecond	Largest number of pages written per second, or 0 for no limit
+	 * @return Log offset redo has to start from, or 0 if no log is attached
+	 * @throws LogFileException If the log cannot be written or synced
+	 */
+  Lsn checkpoint(const double pagesPerSecond = 0);
+
+	/**
+	 * Start a thread that runs fuzzy checkpoints in the background, replacing any running one.
+	 * Each checkpoint starts the given interval after the previous one finished.  A checkpoint
+	 * that fails, e.g. because the log cannot be synced, is retried at the next interval.
+	 *
+	 * @param pagesPerSecond	Largest number of pages written per second, or 0 for no limit
+	 * @param interval			Time between checkpoints
+	 */
+  void startCheckpointer(const double pagesPerSecond, const std::chrono::milliseconds interval);
+
+	/**
+	 * Stop the background checkpointer.  A checkpoint in progress ends after the page being written
+	 * and still logs where redo has to start.  Does nothing if no checkpointer is running.
+	 */
+  void stopCheckpointer();
+
+	/**
+	 * Starts recording every readPage, allocPage, unPinPage and disposePage call to a binary trace file,
+	 * replacing any trace being recorded.  The trace can be replayed offline with bench/trace_replay to
+	 * estimate hit ratios at other pool sizes.
+	 *
+	 * @param filename	Name of the trace file to create
+	 * @throws TraceFileException If the trace file cannot be created
+	 */
+  void startTrace(const std::string& filename);
+
+	/**
+	 * Stops recording and closes the trace file.  Does nothing if no trace is being recorded.
+	 */
+  void stopTrace();
+};
+
+/**
+* @brief Buffer manager for pages of the default page size
+*/
+typedef BasicBufMgr<DEFAULT_PAGE_SIZE> BufMgr;
+
+/**
+* @brief Frame descriptor for pages of the default page size
+*/
+typedef BasicBufDesc<DEFAULT_PAGE_SIZE> BufDesc;
+
+/**
+* @brief Page handle for pages of the default page size
+*/
+typedef BasicPageHandle<DEFAULT_PAGE_SIZE> PageHandle;
+
+/**
+* @brief Snapshot of a buffer manager for pages of the default page size
+*/
+typedef BasicSnapshot<DEFAULT_PAGE_SIZE> Snapshot;
 
 }
@@ -0,0 +1,232 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "checksum.h"
+
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define BADGERDB_CRC32C_HARDWARE 1
+#endif
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * CRC32C polynomial in reversed bit order.
+ */
+const std::uint32_t POLYNOMIAL = 0x82F63B78;
+
+/**
+ * Lookup tables for the slicing-by-8 implementation.  table[0] is the
+ * classic byte-at-a-time table; table[k] advances a byte through k more
+ * zero bytes.
+ */
+struct SlicingTables {
+  std::uint32_t table[8][256];
+
+  SlicingTables() {
+    for (std::uint32_t i = 0; i < 256; ++i) {
+      std::uint32_t crc = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = (crc & 1) ? (crc >> 1) ^ POLYNOMIAL : crc >> 1;
+      }
+      table[0][i] = crc;
+    }
+    for (std::uint32_t i = 0; i < 256; ++i) {
+      for (int k = 1; k < 8; ++k) {
+        table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+      }
+    }
+  }
+};
+
+const SlicingTables& slicingTables() {
+  static const SlicingTables tables;
+  return tables;
+}
+
+/**
+ * Advances a raw (not inverted) CRC state over the given bytes using the
+ * slicing-by-8 tables.
+ */
+std::uint32_t updatePortable(std::uint32_t crc, const unsigned char* p,
+                             std::size_t length) {
+  const std::uint32_t (*table)[256] = slicingTables().table;
+  while (length >= 8) {
+    std::uint32_t low;
+    std::uint32_t high;
+    std::memcpy(&low, p, sizeof(low));
+    std::memcpy(&high, p + 4, sizeof(high));
+    low ^= crc;
+    crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^
+        table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+        table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+        table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+    p += 8;
+    length -= 8;
+  }
+  while (length > 0) {
+    crc = table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    ++p;
+    --length;
+  }
+  return crc;
+}
+
+#ifdef BADGERDB_CRC32C_HARDWARE
+
+/**
+ * Length of each of the three streams checksummed in parallel for long
+ * buffers.  Three streams of this length cover the data area of an 8 KB page.
+ */
+const std::size_t LONG_BLOCK = 2720;
+
+/**
+ * Length of each of the three parallel streams for shorter buffers.
+ */
+const std::size_t SHORT_BLOCK = 256;
+
+/**
+ * Tables that advance a raw CRC state over a fixed number of zero bytes in
+ * four lookups.  Used to stitch together the states of parallel streams:
+ * crc(A followed by B) = shift_|B|(crc(A)) ^ crc_from_zero(B).
+ */
+struct ShiftTable {
+  std::uint32_t table[4][256];
+
+  explicit ShiftTable(const std::size_t length) {
+    const std::string zeros(length, '\0');
+    std::uint32_t basis[32];
+    for (int bit = 0; bit < 32; ++bit) {
+      basis[bit] = updatePortable(1u << bit,
+                                  reinterpret_cast<const unsigned char*>(
+                                      zeros.data()),
+                                  length);
+    }
+    for (int k = 0; k < 4; ++k) {
+      for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t shifted = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+          if (i & (1u << bit)) {
+            shifted ^= basis[8 * k + bit];
+          }
+        }
+        table[k][i] = shifted;
+      }
+    }
+  }
+
+  std::uint32_t shift(const std::uint32_t crc) const {
+    return table[0][crc & 0xFF] ^ table[1][(crc >> 8) & 0xFF] ^
+        table[2][(crc >> 16) & 0xFF] ^ table[3][crc >> 24];
+  }
+};
+
+const ShiftTable& longShift() {
+  static const ShiftTable table(LONG_BLOCK);
+  return table;
+}
+
+const ShiftTable& shortShift() {
+  static const ShiftTable table(SHORT_BLOCK);
+  return table;
+}
+
+inline std::uint64_t load64(const unsigned char* p) {
+  std::uint64_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+/**
+ * Checksums three consecutive streams of <block> bytes in parallel so the
+ * latency of the crc32 instruction is hidden, then combines them.
+ */
+__attribute__((target("sse4.2")))
+std::uint32_t updateThreeWay(std::uint32_t crc, const unsigned char* p,
+                             const std::size_t block,
+                             const ShiftTable& shift) {
+  std::uint64_t crc0 = crc;
+  std::uint64_t crc1 = 0;
+  std::uint64_t crc2 = 0;
+  const unsigned char* end = p + block;
+  for (; p < end; p += 8) {
+    crc0 = _mm_crc32_u64(crc0, load64(p));
+    crc1 = _mm_crc32_u64(crc1, load64(p + block));
+    crc2 = _mm_crc32_u64(crc2, load64(p + 2 * block));
+  }
+  crc = shift.shift(static_cast<std::uint32_t>(crc0)) ^
+      static_cast<std::uint32_t>(crc1);
+  return shift.shift(crc) ^ static_cast<std::uint32_t>(crc2);
+}
+
+/**
+ * Advances a raw CRC state over the given bytes with the crc32 instruction.
+ */
+__attribute__((target("sse4.2")))
+std::uint32_t updateHardware(std::uint32_t crc, const unsigned char* p,
+                             std::size_t length) {
+  while (length >= 3 * LONG_BLOCK) {
+    crc = updateThreeWay(crc, p, LONG_BLOCK, longShift());
+    p += 3 * LONG_BLOCK;
+    length -= 3 * LONG_BLOCK;
+  }
+  while (length >= 3 * SHORT_BLOCK) {
+    crc = updateThreeWay(crc, p, SHORT_BLOCK, shortShift());
+    p += 3 * SHORT_BLOCK;
+    length -= 3 * SHORT_BLOCK;
+  }
+  std::uint64_t crc64 = crc;
+  while (length >= 8) {
+    crc64 = _mm_crc32_u64(crc64, load64(p));
+    p += 8;
+    length -= 8;
+  }
+  crc = static_cast<std::uint32_t>(crc64);
+  while (length > 0) {
+    crc = _mm_crc32_u8(crc, *p);
+    ++p;
+    --length;
+  }
+  return crc;
+}
+
+#endif
+
+}
+
+std::uint32_t crc32c(const void* data, const std::size_t length,
+                     const std::uint32_t crc) {
+#ifdef BADGERDB_CRC32C_HARDWARE
+  static const bool hardware = crc32cHardwareAvailable();
+  if (hardware) {
+    return ~updateHardware(~crc, static_cast<const unsigned char*>(data),
+                           length);
+  }
+#endif
+  return crc32cPortable(data, length, crc);
+}
+
+std::uint32_t crc32cPortable(const void* data, const std::size_t length,
+                             const std::uint32_t crc) {
+  return ~updatePortable(~crc, static_cast<const unsigned char*>(data),
+                         length);
+}
+
+bool crc32cHardwareAvailable() {
+#ifdef BADGERDB_CRC32C_HARDWARE
+  return __builtin_cpu_supports("sse4.2");
+#else
+  return false;
+#endif
+}
+
+}
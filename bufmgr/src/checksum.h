@@ -0,0 +1,45 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace badgerdb {
+
+/**
+ * Computes the CRC32C (Castagnoli) checksum of a buffer.  Uses the SSE4.2
+ * crc32 instruction when the CPU has it and a table-driven implementation
+ * otherwise; both give the same result.
+ *
+ * A checksum over several buffers can be computed by passing the result for
+ * the previous buffers as <crc>.
+ *
+ * @param data    Bytes to checksum.
+ * @param length  Number of bytes.
+ * @param crc     Checksum of the preceding data, or 0 to start a new one.
+ * @return  Checksum of the preceding data followed by <data>.
+ */
+std::uint32_t crc32c(const void* data, const std::size_t length,
+                     const std::uint32_t crc = 0);
+
+/**
+ * Computes the CRC32C checksum of a buffer without using the crc32
+ * instruction, even if it is available.
+ *
+ * @see crc32c()
+ */
+std::uint32_t crc32cPortable(const void* data, const std::size_t length,
+                             const std::uint32_t crc = 0);
+
+/**
+ * Returns true if crc32c() uses the SSE4.2 crc32 instruction on this CPU.
+ */
+bool crc32cHardwareAvailable();
+
+}
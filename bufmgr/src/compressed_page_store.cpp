@@ -0,0 +1,271 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "compressed_page_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "block_compression.h"
+
+namespace badgerdb {
+
+namespace {
+
+std::size_t roundUpToUnit(const std::size_t size) {
+  return (size + CompressedPageStore::SLOT_UNIT - 1) /
+      CompressedPageStore::SLOT_UNIT * CompressedPageStore::SLOT_UNIT;
+}
+
+}
+
+const std::size_t CompressedPageStore::SLOT_UNIT;
+const std::size_t CompressedPageStore::ENTRIES_PER_CHUNK;
+const std::size_t CompressedPageStore::CHUNK_SIZE;
+
+CompressedPageStore::CompressedPageStore(std::fstream& stream,
+                                         const std::uint64_t first_chunk,
+                                         const std::size_t page_size,
+                                         const std::size_t header_size,
+                                         const bool create_new)
+    : page_size_(page_size),
+      header_size_(header_size),
+      first_chunk_(first_chunk),
+      end_(first_chunk + CHUNK_SIZE),
+      buffer_(page_size, char()),
+      cache_bytes_(0),
+      cache_capacity_(0) {
+  cache_stats_.hits = 0;
+  cache_stats_.misses = 0;
+  if (create_new) {
+    const std::string empty_chunk(CHUNK_SIZE, char());
+    stream.seekp(first_chunk_, std::ios::beg);
+    stream.write(empty_chunk.data(), CHUNK_SIZE);
+    stream.flush();
+    chunks_.push_back(first_chunk_);
+    slots_.resize(ENTRIES_PER_CHUNK);
+  } else {
+    load(stream);
+  }
+}
+
+bool CompressedPageStore::readPage(std::fstream& stream,
+                                   const PageId page_number, char* header,
+                                   char* data) {
+  std::unordered_map<PageId, CacheEntry>::iterator cached =
+      cache_.find(page_number);
+  if (cached != cache_.end()) {
+    ++cache_stats_.hits;
+    cache_order_.splice(cache_order_.begin(), cache_order_,
+                        cached->second.position);
+    return decode(cached->second.bytes, header, data);
+  }
+  ++cache_stats_.misses;
+  const CompressedSlot& slot = slots_[page_number];
+  buffer_.resize(slot.length);
+  stream.seekg(slot.offset, std::ios::beg);
+  stream.read(&buffer_[0], slot.length);
+  if (cache_capacity_ > 0) {
+    cachePut(page_number, buffer_.data(), buffer_.size());
+  }
+  return decode(buffer_, header, data);
+}
+
+void CompressedPageStore::readPageHeader(std::fstream& stream,
+                                         const PageId page_number,
+                                         char* header) {
+  std::unordered_map<PageId, CacheEntry>::const_iterator cached =
+      cache_.find(page_number);
+  if (cached != cache_.end()) {
+    std::memcpy(header, cached->second.bytes.data(), header_size_);
+    return;
+  }
+  stream.seekg(slots_[page_number].offset, std::ios::beg);
+  stream.read(header, header_size_);
+}
+
+void CompressedPageStore::writePage(std::fstream& stream,
+                                    const PageId page_number,
+                                    const char* header, const char* data) {
+  // Only keep the compressed form if it saves at least one unit on disk.
+  const std::size_t data_size = page_size_ - header_size_;
+  const std::size_t limit = roundUpToUnit(page_size_) - SLOT_UNIT;
+  buffer_.resize(page_size_);
+  std::memcpy(&buffer_[0], header, header_size_);
+  const std::size_t compressed =
+      limit > header_size_
+          ? compressBlock(data, data_size, &buffer_[header_size_],
+                          limit - header_size_)
+          : 0;
+  std::size_t length;
+  if (compressed != 0) {
+    length = header_size_ + compressed;
+  } else {
+    std::memcpy(&buffer_[header_size_], data, data_size);
+    length = page_size_;
+  }
+
+  ensureEntry(stream, page_number);
+  CompressedSlot& slot = slots_[page_number];
+  if (length <= slot.capacity) {
+    stream.seekp(slot.offset, std::ios::beg);
+    stream.write(buffer_.data(), length);
+    if (slot.length != length) {
+      slot.length = length;
+      writeEntry(stream, page_number);
+    }
+  } else {
+    // Write the page to its new slot before pointing the table at it.
+    const CompressedSlot old_slot = slot;
+    const std::size_t capacity = roundUpToUnit(length);
+    slot.offset = allocate(capacity);
+    slot.length = length;
+    slot.capacity = capacity;
+    stream.seekp(slot.offset, std::ios::beg);
+    stream.write(buffer_.data(), length);
+    writeEntry(stream, page_number);
+    if (old_slot.capacity != 0) {
+      release(old_slot.offset, old_slot.capacity);
+    }
+  }
+  stream.flush();
+
+  if (cache_capacity_ > 0) {
+    cachePut(page_number, buffer_.data(), length);
+  }
+}
+
+void CompressedPageStore::setCacheCapacity(const std::size_t bytes) {
+  cache_capacity_ = bytes;
+  cacheTrim();
+}
+
+void CompressedPageStore::load(std::fstream& stream) {
+  std::vector<std::pair<std::uint64_t, std::uint64_t> > used;
+  std::uint64_t chunk = first_chunk_;
+  while (chunk != 0) {
+    chunks_.push_back(chunk);
+    used.push_back(std::make_pair(chunk, chunk + CHUNK_SIZE));
+    const std::size_t first = slots_.size();
+    slots_.resize(first + ENTRIES_PER_CHUNK);
+    stream.seekg(chunk, std::ios::beg);
+    stream.read(reinterpret_cast<char*>(&chunk), sizeof(chunk));
+    stream.read(reinterpret_cast<char*>(&slots_[first]),
+                ENTRIES_PER_CHUNK * sizeof(CompressedSlot));
+  }
+  for (std::size_t i = 0; i < slots_.size(); ++i) {
+    if (slots_[i].capacity != 0) {
+      used.push_back(std::make_pair(slots_[i].offset,
+                                    slots_[i].offset + slots_[i].capacity));
+    }
+  }
+  std::sort(used.begin(), used.end());
+  std::uint64_t position = first_chunk_;
+  for (std::size_t i = 0; i < used.size(); ++i) {
+    if (used[i].first > position) {
+      release(position, used[i].first - position);
+    }
+    position = std::max(position, used[i].second);
+  }
+  end_ = position;
+}
+
+void CompressedPageStore::ensureEntry(std::fstream& stream,
+                                      const PageId page_number) {
+  while (page_number >= slots_.size()) {
+    const std::uint64_t chunk = allocate(CHUNK_SIZE);
+    const std::string empty_chunk(CHUNK_SIZE, char());
+    stream.seekp(chunk, std::ios::beg);
+    stream.write(empty_chunk.data(), CHUNK_SIZE);
+    // Link the new chunk only once it is on disk.
+    stream.seekp(chunks_.back(), std::ios::beg);
+    stream.write(reinterpret_cast<const char*>(&chunk), sizeof(chunk));
+    chunks_.push_back(chunk);
+    slots_.resize(slots_.size() + ENTRIES_PER_CHUNK);
+  }
+}
+
+void CompressedPageStore::writeEntry(std::fstream& stream,
+                                     const PageId page_number) {
+  const std::uint64_t position = chunks_[page_number / ENTRIES_PER_CHUNK] +
+      sizeof(std::uint64_t) +
+      (page_number % ENTRIES_PER_CHUNK) * sizeof(CompressedSlot);
+  stream.seekp(position, std::ios::beg);
+  stream.write(reinterpret_cast<const char*>(&slots_[page_number]),
+               sizeof(CompressedSlot));
+}
+
+std::uint64_t CompressedPageStore::allocate(const std::size_t size) {
+  std::multimap<std::uint32_t, std::uint64_t>::iterator free_slot =
+      free_slots_.lower_bound(size);
+  if (free_slot == free_slots_.end()) {
+    const std::uint64_t offset = end_;
+    end_ += size;
+    return offset;
+  }
+  const std::uint64_t offset = free_slot->second;
+  const std::size_t remainder = free_slot->first - size;
+  free_slots_.erase(free_slot);
+  if (remainder > 0) {
+    release(offset + size, remainder);
+  }
+  return offset;
+}
+
+void CompressedPageStore::release(const std::uint64_t offset,
+                                  const std::size_t size) {
+  free_slots_.insert(std::make_pair(static_cast<std::uint32_t>(size), offset));
+}
+
+bool CompressedPageStore::decode(const std::string& bytes, char* header,
+                                 char* data) const {
+  const std::size_t data_size = page_size_ - header_size_;
+  std::memcpy(header, bytes.data(), header_size_);
+  if (bytes.size() == page_size_) {
+    std::memcpy(data, bytes.data() + header_size_, data_size);
+    return true;
+  }
+  if (!decompressBlock(bytes.data() + header_size_,
+                       bytes.size() - header_size_, data, data_size)) {
+    std::memset(data, 0, data_size);
+    return false;
+  }
+  return true;
+}
+
+void CompressedPageStore::cachePut(const PageId page_number,
+                                   const char* bytes,
+                                   const std::size_t length) {
+  std::unordered_map<PageId, CacheEntry>::iterator cached =
+      cache_.find(page_number);
+  if (cached == cache_.end()) {
+    cache_order_.push_front(page_number);
+    cached = cache_.insert(
+        std::make_pair(page_number, CacheEntry())).first;
+    cached->second.position = cache_order_.begin();
+  } else {
+    cache_bytes_ -= cached->second.bytes.size();
+    cache_order_.splice(cache_order_.begin(), cache_order_,
+                        cached->second.position);
+  }
+  cached->second.bytes.assign(bytes, length);
+  cache_bytes_ += length;
+  cacheTrim();
+}
+
+void CompressedPageStore::cacheTrim() {
+  while (cache_bytes_ > cache_capacity_) {
+    std::unordered_map<PageId, CacheEntry>::iterator victim =
+        cache_.find(cache_order_.back());
+    cache_bytes_ -= victim->second.bytes.size();
+    cache_.erase(victim);
+    cache_order_.pop_back();
+  }
+}
+
+}
@@ -0,0 +1,310 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Mapping table entry locating one page in a compressed file.
+ */
+struct CompressedSlot {
+  /**
+   * Position of the page's slot in the file, or 0 if the page has never been
+   * written.
+   */
+  std::uint64_t offset;
+
+  /**
+   * Number of bytes stored in the slot.  Equal to the page size if the page
+   * is stored uncompressed.
+   */
+  std::uint32_t length;
+
+  /**
+   * Number of bytes reserved for the slot; a multiple of
+   * CompressedPageStore::SLOT_UNIT.
+   */
+  std::uint32_t capacity;
+};
+
+static_assert(sizeof(CompressedSlot) == 16,
+              "Slot layout must match the on-disk mapping table.");
+
+/**
+ * @brief Counters for the compressed page cache.
+ */
+struct CompressedCacheStats {
+  /**
+   * Page reads served from the cache.
+   */
+  std::uint64_t hits;
+
+  /**
+   * Page reads that went to disk.
+   */
+  std::uint64_t misses;
+};
+
+/**
+ * @brief Variable-length page storage used by files in the compressed format.
+ *
+ * Each page is stored in a slot holding the page header verbatim followed by
+ * the compressed data area, so walking the page list does not decompress
+ * anything.  Pages that do not compress by at least one SLOT_UNIT are stored
+ * as is.  Slots are located through a mapping table indexed by page number,
+ * persisted in fixed-size chunks chained from the start of the file; the
+ * whole table is read into memory when the file is opened.
+ *
+ * A page rewritten with a larger compressed size moves to a new slot and its
+ * old slot is reused for later writes.  Free slots are split but not
+ * coalesced.
+ *
+ * The store also keeps the compressed images of recently used pages in
+ * memory, up to a configurable number of bytes, so a buffer pool miss on a
+ * cached page costs a decompression instead of a disk read.
+ *
+ * The store does not own the stream; callers pass the file's stream to every
+ * operation.
+ *
+ * @warning This class is not threadsafe.
+ */
+class CompressedPageStore {
+ public:
+  /**
+   * Allocation unit for slots in bytes.
+   */
+  static const std::size_t SLOT_UNIT = 256;
+
+  /**
+   * Number of mapping table entries per chunk.
+   */
+  static const std::size_t ENTRIES_PER_CHUNK = 511;
+
+  /**
+   * Size of one mapping table chunk on disk: the position of the next chunk
+   * followed by the entries, rounded up to SLOT_UNIT.
+   */
+  static const std::size_t CHUNK_SIZE =
+      (sizeof(std::uint64_t) + ENTRIES_PER_CHUNK * sizeof(CompressedSlot) +
+       SLOT_UNIT - 1) / SLOT_UNIT * SLOT_UNIT;
+
+  /**
+   * Constructs the store for a file, creating an empty mapping table at
+   * <first_chunk> or reading the existing one.
+   *
+   * @param stream      Stream of the file.
+   * @param first_chunk Position of the first mapping table chunk.
+   * @param page_size   Size in bytes of an uncompressed page.
+   * @param header_size Size in bytes of the page header, which is stored
+   *                    uncompressed.
+   * @param create_new  Whether the file is new.
+   */
+  CompressedPageStore(std::fstream& stream, const std::uint64_t first_chunk,
+                      const std::size_t page_size,
+                      const std::size_t header_size, const bool create_new);
+
+  /**
+   * Returns true if the page has been written to the file.
+   *
+   * @param page_number   Number of page.
+   */
+  bool contains(const PageId page_number) const {
+    return page_number < slots_.size() && slots_[page_number].capacity != 0;
+  }
+
+  /**
+   * Reads and decompresses a page.  The page must have been written.
+   *
+   * @param stream      Stream of the file.
+   * @param page_number Number of page to read.
+   * @param header      Receives header_size bytes of page header.
+   * @param data        Receives the rest of the page.
+   * @return  False if the stored data area is malformed; <data> is then
+   *          zero-filled and the header is still valid.
+   */
+  bool readPage(std::fstream& stream, const PageId page_number, char* header,
+                char* data);
+
+  /**
+   * Reads only the header of a page.  The page must have been written.
+   *
+   * @param stream      Stream of the file.
+   * @param page_number Number of page whose header to read.
+   * @param header      Receives header_size bytes of page header.
+   */
+  void readPageHeader(std::fstream& stream, const PageId page_number,
+                      char* header);
+
+  /**
+   * Compresses and writes a page, moving it to a larger slot if needed.
+   *
+   * @param stream      Stream of the file.
+   * @param page_number Number of page to write.
+   * @param header      header_size bytes of page header.
+   * @param data        The rest of the page.
+   */
+  void writePage(std::fstream& stream, const PageId page_number,
+                 const char* header, const char* data);
+
+  /**
+   * Sets the number of bytes of compressed page images kept in memory.  Zero
+   * disables the cache.
+   *
+   * @param bytes   Cache capacity in bytes.
+   */
+  void setCacheCapacity(const std::size_t bytes);
+
+  /**
+   * Returns the number of bytes of compressed page images kept in memory.
+   */
+  std::size_t cacheCapacity() const { return cache_capacity_; }
+
+  /**
+   * Returns the cache counters.
+   */
+  const CompressedCacheStats& cacheStats() const { return cache_stats_; }
+
+ private:
+  /**
+   * Compressed image of a page kept in the cache.
+   */
+  struct CacheEntry {
+    /**
+     * Slot contents.
+     */
+    std::string bytes;
+
+    /**
+     * Position of the page in the recency list.
+     */
+    std::list<PageId>::iterator position;
+  };
+
+  /**
+   * Reads the mapping table chunks starting at first_chunk_ and rebuilds the
+   * free slot list from the gaps between used slots.
+   */
+  void load(std::fstream& stream);
+
+  /**
+   * Extends the mapping table with chunks until it has an entry for the given
+   * page.
+   */
+  void ensureEntry(std::fstream& stream, const PageId page_number);
+
+  /**
+   * Writes the mapping table entry for the given page to disk.
+   */
+  void writeEntry(std::fstream& stream, const PageId page_number);
+
+  /**
+   * Returns the position of a free region of <size> bytes, reusing a free
+   * slot if one is large enough.
+   */
+  std::uint64_t allocate(const std::size_t size);
+
+  /**
+   * Returns a region to the free slot list.
+   */
+  void release(const std::uint64_t offset, const std::size_t size);
+
+  /**
+   * Decodes a slot's contents into a page header and data area.
+   */
+  bool decode(const std::string& bytes, char* header, char* data) const;
+
+  /**
+   * Adds or replaces the cached image of a page and evicts the least
+   * recently used images beyond the capacity.
+   */
+  void cachePut(const PageId page_number, const char* bytes,
+                const std::size_t length);
+
+  /**
+   * Drops the least recently used images until the cache fits its capacity.
+   */
+  void cacheTrim();
+
+  /**
+   * Size in bytes of an uncompressed page.
+   */
+  const std::size_t page_size_;
+
+  /**
+   * Size in bytes of the uncompressed page header.
+   */
+  const std::size_t header_size_;
+
+  /**
+   * Position of the first mapping table chunk.
+   */
+  const std::uint64_t first_chunk_;
+
+  /**
+   * Positions of the mapping table chunks in order.
+   */
+  std::vector<std::uint64_t> chunks_;
+
+  /**
+   * Mapping table indexed by page number.
+   */
+  std::vector<CompressedSlot> slots_;
+
+  /**
+   * Free regions of the file keyed by size.
+   */
+  std::multimap<std::uint32_t, std::uint64_t> free_slots_;
+
+  /**
+   * Position just past the last used region of the file.
+   */
+  std::uint64_t end_;
+
+  /**
+   * Scratch buffer holding slot contents being read or written.
+   */
+  std::string buffer_;
+
+  /**
+   * Cached compressed images by page number.
+   */
+  std::unordered_map<PageId, CacheEntry> cache_;
+
+  /**
+   * Cached page numbers, most recently used first.
+   */
+  std::list<PageId> cache_order_;
+
+  /**
+   * Total bytes of cached images.
+   */
+  std::size_t cache_bytes_;
+
+  /**
+   * Maximum bytes of cached images.
+   */
+  std::size_t cache_capacity_;
+
+  /**
+   * Cache counters.
+   */
+  CompressedCacheStats cache_stats_;
+};
+
+}
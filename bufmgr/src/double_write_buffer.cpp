@@ -0,0 +1,262 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "double_write_buffer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <set>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "checksum.h"
+#include "posix_io.h"
+#include "exceptions/double_write_exception.h"
+#include "exceptions/invalid_page_exception.h"
+
+namespace badgerdb {
+
+template <std::size_t PageSize>
+const char BasicDoubleWriteBuffer<PageSize>::MAGIC[8] = {'B', 'D', 'B', 'D',
+                                                         'W', 'B', '0', '1'};
+
+namespace {
+
+/**
+ * Checksums the count and length of a batch header followed by the batch.
+ */
+std::uint32_t batchChecksum(const DoubleWriteHeader& header,
+                            const char* batch) {
+  std::uint32_t crc = crc32c(&header.count, sizeof(header.count));
+  crc = crc32c(&header.length, sizeof(header.length), crc);
+  return crc32c(batch, header.length, crc);
+}
+
+/**
+ * Makes the writes to a data file durable.  The file is opened by name since
+ * File writes through a stream.
+ */
+void syncFile(const std::string& filename) {
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  const bool synced = fd >= 0 && ::fdatasync(fd) == 0;
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  if (!synced) {
+    throw DoubleWriteException(filename, "cannot be synced");
+  }
+}
+
+}
+
+template <std::size_t PageSize>
+BasicDoubleWriteBuffer<PageSize>::BasicDoubleWriteBuffer(
+    const std::string& filename, const std::uint32_t capacity)
+    : filename_(filename),
+      fd_(::open(filename.c_str(), O_RDWR | O_CREAT, 0644)),
+      capacity_(capacity > 0 ? capacity : 1),
+      num_batches_(0),
+      num_pages_(0) {
+  if (fd_ < 0) {
+    throw DoubleWriteException(filename_, "cannot be opened");
+  }
+}
+
+template <std::size_t PageSize>
+BasicDoubleWriteBuffer<PageSize>::~BasicDoubleWriteBuffer() {
+  ::close(fd_);
+}
+
+template <std::size_t PageSize>
+void BasicDoubleWriteBuffer<PageSize>::write(
+    const std::vector<PageWrite>& pages) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::size_t begin = 0; begin < pages.size(); begin += capacity_) {
+    writeBatch(pages, begin, std::min(pages.size(), begin + capacity_));
+  }
+}
+
+template <std::size_t PageSize>
+void BasicDoubleWriteBuffer<PageSize>::writeBatch(
+    const std::vector<PageWrite>& pages, const std::size_t begin,
+    const std::size_t end) {
+  // Build each page as File will write it, keeping its next page number on
+  // disk, so the copy is what a torn write has to be repaired to.
+  std::vector<PageHeader> headers(end - begin);
+  std::set<std::string> files;
+  DoubleWriteHeader header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.count = 0;
+  batch_.assign(sizeof(header), '\0');
+  for (std::size_t i = begin; i < end; ++i) {
+    File* const file = pages[i].first;
+    const Page& page = *pages[i].second;
+    if (file->format() != FILE_FORMAT_PLAIN) {
+      continue;
+    }
+    PageHeader& stamped = headers[i - begin];
+    stamped = file->readPageHeader(page.page_number());
+    if (stamped.current_page_number == Page::INVALID_NUMBER) {
+      throw InvalidPageException(page.page_number(), file->filename());
+    }
+    const PageId next_page_number = stamped.next_page_number;
+    stamped = page.header_;
+    stamped.next_page_number = next_page_number;
+    stamped.checksum = Page::computeChecksum(stamped, page.data_);
+
+    const PageId page_number = page.page_number();
+    const std::uint32_t name_length =
+        static_cast<std::uint32_t>(file->filename().size());
+    batch_.append(reinterpret_cast<const char*>(&page_number),
+                  sizeof(page_number));
+    batch_.append(reinterpret_cast<const char*>(&name_length),
+                  sizeof(name_length));
+    batch_.append(file->filename());
+    batch_.append(reinterpret_cast<const char*>(&stamped), sizeof(stamped));
+    batch_.append(page.data_);
+    ++header.count;
+    files.insert(file->filename());
+  }
+
+  if (header.count > 0) {
+    header.length = batch_.size() - sizeof(header);
+    header.checksum = batchChecksum(header, batch_.data() + sizeof(header));
+    std::memcpy(&batch_[0], &header, sizeof(header));
+    if (!writeAt(fd_, batch_.data(), batch_.size(), 0)) {
+      throw DoubleWriteException(filename_, "cannot be written");
+    }
+    if (::fdatasync(fd_) != 0) {
+      throw DoubleWriteException(filename_, "cannot be synced");
+    }
+  }
+
+  for (std::size_t i = begin; i < end; ++i) {
+    File* const file = pages[i].first;
+    const Page& page = *pages[i].second;
+    if (file->format() != FILE_FORMAT_PLAIN) {
+      file->writePage(page);
+    } else {
+      file->writePage(page.page_number(), headers[i - begin], page);
+    }
+  }
+  // The next batch overwrites the copies, so these pages must be durable
+  // in place first.
+  for (std::set<std::string>::const_iterator it = files.begin();
+       it != files.end(); ++it) {
+    syncFile(*it);
+  }
+  ++num_batches_;
+  num_pages_ += header.count;
+}
+
+template <std::size_t PageSize>
+std::uint32_t BasicDoubleWriteBuffer<PageSize>::repair(
+    const std::string& filename) {
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return 0;
+    }
+    throw DoubleWriteException(filename, "cannot be opened");
+  }
+  struct stat st;
+  const std::uint64_t size = ::fstat(fd, &st) == 0 ? st.st_size : 0;
+  DoubleWriteHeader header;
+  std::string batch;
+  bool valid = false;
+  if (size >= sizeof(header) && readAt(fd, &header, sizeof(header), 0)) {
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+      ::close(fd);
+      throw DoubleWriteException(filename, "is not a double-write file");
+    }
+    if (header.length <= size - sizeof(header)) {
+      batch.resize(header.length);
+      valid = readAt(fd, &batch[0], batch.size(), sizeof(header)) &&
+              batchChecksum(header, batch.data()) == header.checksum;
+    }
+  }
+  ::close(fd);
+  if (!valid) {
+    return 0;
+  }
+
+  std::map<std::string, int> data_files;
+  std::uint32_t repaired = 0;
+  std::string failed_file;
+  Page page;
+  std::size_t offset = 0;
+  for (std::uint32_t i = 0; i < header.count && failed_file.empty(); ++i) {
+    PageId page_number;
+    std::uint32_t name_length;
+    if (batch.size() - offset < sizeof(page_number) + sizeof(name_length)) {
+      break;
+    }
+    std::memcpy(&page_number, batch.data() + offset, sizeof(page_number));
+    offset += sizeof(page_number);
+    std::memcpy(&name_length, batch.data() + offset, sizeof(name_length));
+    offset += sizeof(name_length);
+    if (batch.size() - offset < name_length + Page::SIZE) {
+      break;
+    }
+    const std::string data_file(batch, offset, name_length);
+    offset += name_length;
+    const char* const copy = batch.data() + offset;
+    offset += Page::SIZE;
+
+    std::map<std::string, int>::iterator it = data_files.find(data_file);
+    if (it == data_files.end()) {
+      // Pages of a file removed since the batch was written are ignored.
+      const int data_fd = ::open(data_file.c_str(), O_RDWR);
+      if (data_fd < 0 && errno != ENOENT) {
+        failed_file = data_file;
+        break;
+      }
+      it = data_files.insert(std::make_pair(data_file, data_fd)).first;
+    }
+    if (it->second < 0) {
+      continue;
+    }
+    const std::uint64_t position =
+        static_cast<std::uint64_t>(File::pagePosition(page_number));
+    page.data_.resize(Page::DATA_SIZE);
+    const bool intact =
+        readAt(it->second, &page.header_, sizeof(page.header_), position) &&
+        readAt(it->second, &page.data_[0], Page::DATA_SIZE,
+               position + sizeof(PageHeader)) &&
+        Page::computeChecksum(page.header_, page.data_) ==
+            page.header_.checksum;
+    if (intact) {
+      continue;
+    }
+    if (!writeAt(it->second, copy, Page::SIZE, position) ||
+        ::fdatasync(it->second) != 0) {
+      failed_file = data_file;
+      break;
+    }
+    ++repaired;
+  }
+  for (std::map<std::string, int>::iterator it = data_files.begin();
+       it != data_files.end(); ++it) {
+    if (it->second >= 0) {
+      ::close(it->second);
+    }
+  }
+  if (!failed_file.empty()) {
+    throw DoubleWriteException(failed_file, "cannot be repaired");
+  }
+  return repaired;
+}
+
+#define BADGERDB_INSTANTIATE_DOUBLE_WRITE_BUFFER(size) \
+  template class BasicDoubleWriteBuffer<size>;
+BADGERDB_FOR_EACH_PAGE_SIZE(BADGERDB_INSTANTIATE_DOUBLE_WRITE_BUFFER)
+#undef BADGERDB_INSTANTIATE_DOUBLE_WRITE_BUFFER
+
+}
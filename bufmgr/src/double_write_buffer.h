@@ -0,0 +1,210 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "file.h"
+#include "page.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Header at the start of a double-write file.
+ */
+struct DoubleWriteHeader {
+  /**
+   * BasicDoubleWriteBuffer::MAGIC.
+   */
+  char magic[8];
+
+  /**
+   * Number of pages in the batch.
+   */
+  std::uint32_t count;
+
+  /**
+   * CRC32C of count and length followed by the batch.  A batch whose
+   * checksum does not match was torn while it was written.
+   */
+  std::uint32_t checksum;
+
+  /**
+   * Number of bytes of the batch following the header.
+   */
+  std::uint64_t length;
+};
+
+static_assert(sizeof(DoubleWriteHeader) == 24,
+              "Double-write header layout must match the file format.");
+
+/**
+ * @brief Protects page writes from being torn by a crash.
+ *
+ * A page write the device performs in several pieces can be cut short by a
+ * power loss, leaving a page that is part old and part new and fails its
+ * checksum.  A double-write buffer writes a batch of pages one after another
+ * to a double-write file and syncs it before writing any of them in place,
+ * then syncs the data files before the next batch overwrites the double-write
+ * file.  Every page being written in place thus has an intact copy on disk,
+ * and repair() uses the copies to rewrite the pages that were torn.  Batching
+ * keeps the cost at two syncs per batch rather than per page.
+ *
+ * Each page in the double-write file is stored as its page number, the length
+ * and name of its file and the page as File writes it, checksum included.
+ * Only pages of files in the plain format are protected; pages of files in
+ * other formats are written as usual.  Files in the shadow format need no
+ * protection, since they never overwrite a committed page.
+ *
+ * All methods are threadsafe; batches are written one at a time.
+ */
+template <std::size_t PageSize>
+class BasicDoubleWriteBuffer {
+ public:
+  /**
+   * Type of the pages written.
+   */
+  typedef BasicPage<PageSize> Page;
+
+  /**
+   * Type of the files written to.
+   */
+  typedef BasicFile<PageSize> File;
+
+  /**
+   * A page to write and the file it belongs to.
+   */
+  typedef std::pair<File*, const Page*> PageWrite;
+
+  /**
+   * Magic string at the start of every double-write file.
+   */
+  static const char MAGIC[8];
+
+  /**
+   * Opens a double-write file, creating it if it does not exist.  Pages left
+   * in an existing file are kept until the first batch is written, so
+   * repair() has to run before the buffer is opened.
+   *
+   * @param filename  Name of the double-write file.
+   * @param capacity  Largest number of pages written in one batch.
+   * @throws  DoubleWriteException  If the file cannot be opened or created.
+   */
+  explicit BasicDoubleWriteBuffer(const std::string& filename,
+                                  const std::uint32_t capacity = 64);
+
+  /**
+   * Closes the double-write file.
+   */
+  ~BasicDoubleWriteBuffer();
+
+  /**
+   * Writes pages to their files through the double-write file, in batches
+   * of at most capacity() pages.  When it returns, the pages are durable in
+   * their files.
+   *
+   * @param pages   Pages to write; a page keeps the next page number it has
+   *                on disk, as with File::writePage().
+   * @throws  InvalidPageException  If a page has been deleted from its file.
+   * @throws  DoubleWriteException  If the double-write file or a data file
+   *                                cannot be written or synced.
+   */
+  void write(const std::vector<PageWrite>& pages);
+
+  /**
+   * Rewrites every page of the last batch in a double-write file that fails
+   * its checksum in its data file.  Run it after a crash before the data
+   * files or the double-write file are opened, and before Recovery::run().
+   * A batch torn while the double-write file was written is ignored, since
+   * none of its pages had been written in place.
+   *
+   * @param filename  Name of the double-write file.
+   * @return  Number of pages rewritten; 0 if the file does not exist.
+   * @throws  DoubleWriteException  If the double-write file is not one, or a
+   *                                data file cannot be written or synced.
+   */
+  static std::uint32_t repair(const std::string& filename);
+
+  /**
+   * Returns the largest number of pages written in one batch.
+   */
+  std::uint32_t capacity() const { return capacity_; }
+
+  /**
+   * Returns the number of batches written since the buffer was opened.
+   */
+  std::uint64_t numBatches() const { return num_batches_.load(); }
+
+  /**
+   * Returns the number of pages written through the double-write file since
+   * the buffer was opened.
+   */
+  std::uint64_t numPages() const { return num_pages_.load(); }
+
+  /**
+   * Returns the name of the double-write file.
+   */
+  const std::string& filename() const { return filename_; }
+
+ private:
+  BasicDoubleWriteBuffer(const BasicDoubleWriteBuffer&);
+  BasicDoubleWriteBuffer& operator=(const BasicDoubleWriteBuffer&);
+
+  /**
+   * Writes pages [begin, end) as one batch.
+   */
+  void writeBatch(const std::vector<PageWrite>& pages, const std::size_t begin,
+                  const std::size_t end);
+
+  /**
+   * Name of the double-write file.
+   */
+  std::string filename_;
+
+  /**
+   * Descriptor of the double-write file.
+   */
+  int fd_;
+
+  /**
+   * Largest number of pages in a batch.
+   */
+  std::uint32_t capacity_;
+
+  /**
+   * Serializes batches.
+   */
+  std::mutex mutex_;
+
+  /**
+   * Header and pages of the batch being written; kept to reuse its memory.
+   */
+  std::string batch_;
+
+  /**
+   * Number of batches written.
+   */
+  std::atomic<std::uint64_t> num_batches_;
+
+  /**
+   * Number of pages written through the double-write file.
+   */
+  std::atomic<std::uint64_t> num_pages_;
+};
+
+/**
+ * @brief Double-write buffer for pages of the default size
+ */
+typedef BasicDoubleWriteBuffer<DEFAULT_PAGE_SIZE> DoubleWriteBuffer;
+
+}
@@ -0,0 +1,187 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "epoch_manager.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace badgerdb {
+
+namespace {
+
+std::atomic<std::uint64_t> nextManagerId(1);
+
+}
+
+const std::size_t EpochManager::RECLAIM_INTERVAL;
+const int EpochManager::CACHE_SIZE;
+thread_local EpochManager::CacheEntry EpochManager::cache[EpochManager::CACHE_SIZE];
+thread_local int EpochManager::cacheNext;
+thread_local EpochManager::ThreadSlots EpochManager::threadSlots;
+
+EpochManager::EpochManager()
+: id(nextManagerId.fetch_add(1)),
+  globalEpoch(1),
+  sinceReclaim(0)
+{
+}
+
+EpochManager::~EpochManager()
+{
+	reclaimAll();
+	for (std::size_t i = 0; i < slots.size(); i++) {
+		release(slots[i]);
+	}
+}
+
+EpochManager::ThreadSlots::~ThreadSlots()
+{
+	for (std::size_t i = 0; i < entries.size(); i++) {
+		entries[i].slot->epoch.store(0, std::memory_order_release);
+		release(entries[i].slot);
+	}
+}
+
+void EpochManager::release(Slot* slot)
+{
+	if (slot->holders.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		std::free(slot);
+}
+
+EpochManager::Slot& EpochManager::localSlow()
+{
+	std::vector<CacheEntry>& entries = threadSlots.entries;
+	Slot* slot = NULL;
+	for (std::size_t i = 0; i < entries.size(); ) {
+		if (entries[i].owner == id) {
+			slot = entries[i].slot;
+			i++;
+		} else if (entries[i].slot->holders.load(std::memory_order_acquire) == 1) {
+			// Its manager is gone, so the thread alone holds the slot.
+			release(entries[i].slot);
+			entries[i] = entries.back();
+			entries.pop_back();
+		} else {
+			i++;
+		}
+	}
+
+	if (slot == NULL) {
+		entries.reserve(entries.size() + 1);
+		std::lock_guard<std::mutex> lock(mutex);
+		// A slot only the manager holds was released by a thread that exited outside any epoch.
+		for (std::size_t i = 0; i < slots.size() && slot == NULL; i++) {
+			if (slots[i]->holders.load(std::memory_order_acquire) == 1)
+				slot = slots[i];
+		}
+		if (slot == NULL) {
+			slots.reserve(slots.size() + 1);
+			void* storage = NULL;
+			if (posix_memalign(&storage, alignof(Slot), sizeof(Slot)) != 0)
+				throw std::bad_alloc();
+			slot = new (storage) Slot();
+			slot->epoch.store(0, std::memory_order_relaxed);
+			slots.push_back(slot);
+		}
+		slot->depth = 0;
+		slot->holders.store(2, std::memory_order_relaxed);
+		const CacheEntry entry = {id, slot};
+		entries.push_back(entry);
+	}
+	cache[cacheNext].owner = id;
+	cache[cacheNext].slot = slot;
+	cacheNext = (cacheNext + 1) % CACHE_SIZE;
+	return *slot;
+}
+
+void EpochManager::enter()
+{
+	Slot& slot = local();
+	if (slot.depth++ > 0)
+		return;
+	// Announce, then check that the epoch did not advance meanwhile; an advance that did not see
+	// the announcement could otherwise move two epochs past it.
+	std::uint64_t current = globalEpoch.load(std::memory_order_acquire);
+	for (;;)
+	{
+		slot.epoch.store(current, std::memory_order_seq_cst);
+		const std::uint64_t now = globalEpoch.load(std::memory_order_seq_cst);
+		if (now == current)
+			return;
+		current = now;
+	}
+}
+
+void EpochManager::exit()
+{
+	Slot& slot = local();
+	if (--slot.depth == 0)
+		slot.epoch.store(0, std::memory_order_release);
+}
+
+void EpochManager::retire(void* object, ReclaimFunction reclaim, void* context)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	const Retired entry = {globalEpoch.load(std::memory_order_relaxed), object, reclaim, context};
+	retired.push_back(entry);
+	if (++sinceReclaim >= RECLAIM_INTERVAL)
+		reclaimLocked();
+}
+
+std::size_t EpochManager::reclaim()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return reclaimLocked();
+}
+
+std::size_t EpochManager::reclaimLocked()
+{
+	sinceReclaim = 0;
+	// Two advances are enough to reclaim everything retired so far if no thread is in an epoch.
+	for (int advance = 0; advance < 2; advance++)
+	{
+		const std::uint64_t current = globalEpoch.load(std::memory_order_relaxed);
+		bool announced = true;
+		for (std::size_t i = 0; i < slots.size(); i++) {
+			const std::uint64_t epoch = slots[i]->epoch.load(std::memory_order_seq_cst);
+			if (epoch != 0 && epoch != current) {
+				announced = false;
+				break;
+			}
+		}
+		if (!announced)
+			break;
+		globalEpoch.store(current + 1, std::memory_order_seq_cst);
+	}
+
+	// A thread inside an epoch is in the global epoch or the one before it.
+	const std::uint64_t current = globalEpoch.load(std::memory_order_relaxed);
+	std::size_t reclaimed = 0;
+	while (!retired.empty() && retired.front().epoch + 2 <= current)
+	{
+		const Retired entry = retired.front();
+		retired.pop_front();
+		entry.reclaim(entry.object, entry.context);
+		reclaimed++;
+	}
+	return reclaimed;
+}
+
+void EpochManager::reclaimAll()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	while (!retired.empty())
+	{
+		const Retired entry = retired.front();
+		retired.pop_front();
+		entry.reclaim(entry.object, entry.context);
+	}
+	sinceReclaim = 0;
+}
+
+}
@@ -0,0 +1,286 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace badgerdb {
+
+/**
+* @brief Epoch-based reclamation of objects that threads read without a lock
+*
+* A thread that reads shared objects without a lock does so inside an epoch, between enter() and
+* exit().  A writer that unlinks such an object passes it to retire() instead of freeing it, and
+* the object is handed back to its reclaim function only once every thread that was inside an
+* epoch when it was retired has left it.
+*
+* A global epoch number is advanced when every thread inside an epoch has announced the current
+* one; an object retired in epoch E is reclaimed once the global epoch reaches E + 2.  Each thread
+* announces its epoch in a slot of its own, found through a small thread-local cache like the
+* shards of BufStatsCollector, so entering and leaving write only the thread's own cache line.
+* A thread releases its slots when it exits, and the manager hands a released slot to the next
+* thread that needs one, so the slots never outnumber the threads alive at once.  Retiring and
+* reclaiming take a mutex.
+*/
+class EpochManager
+{
+ public:
+	/**
+	 * Function an object is handed back to once no thread can still be reading it
+	 */
+  typedef void (*ReclaimFunction)(void* object, void* context);
+
+  EpochManager();
+
+	/**
+	 * Reclaims every object still retired.  No thread may be inside an epoch.
+	 */
+  ~EpochManager();
+
+	/**
+	 * Enters an epoch.  Objects retired from now on stay in place until the thread calls exit().
+	 * Calls nest; only the outermost pair enters and leaves.
+	 */
+  void enter();
+
+	/**
+	 * Leaves the epoch entered by the matching enter().
+	 */
+  void exit();
+
+	/**
+	 * Retires an unlinked object, tagging it with the current epoch, and reclaims what can be
+	 * reclaimed every RECLAIM_INTERVAL retirements.
+	 *
+	 * @param object	Object no thread can reach any more
+	 * @param reclaim	Called with the object and context once no thread can be reading it
+	 * @param context	Passed to reclaim
+	 */
+  void retire(void* object, ReclaimFunction reclaim, void* context);
+
+	/**
+	 * Retires an object to be deleted.
+	 */
+  template <typename T>
+  void retire(T* object)
+  {
+		retire(object, &deleteObject<T>, NULL);
+  }
+
+	/**
+	 * Advances the global epoch as far as the threads inside an epoch allow and reclaims the objects
+	 * retired before the oldest epoch one of them may be in.
+	 *
+	 * @return Number of objects reclaimed
+	 */
+  std::size_t reclaim();
+
+	/**
+	 * Reclaims every object retired.  No thread may be inside an epoch.
+	 */
+  void reclaimAll();
+
+	/**
+	 * Returns the global epoch
+	 */
+  std::uint64_t epoch() const
+  {
+		return globalEpoch.load(std::memory_order_relaxed);
+  }
+
+	/**
+	 * Returns the number of objects retired and not yet reclaimed
+	 */
+  std::size_t numRetired() const
+  {
+		std::lock_guard<std::mutex> lock(mutex);
+		return retired.size();
+  }
+
+	/**
+	 * Returns the number of slots allocated, for threads alive or exited and not yet replaced
+	 */
+  std::size_t numSlots() const
+  {
+		std::lock_guard<std::mutex> lock(mutex);
+		return slots.size();
+  }
+
+	/**
+	 * Number of retirements between the reclaim() calls retire() makes
+	 */
+  static const std::size_t RECLAIM_INTERVAL = 64;
+
+ private:
+  EpochManager(const EpochManager&);
+  EpochManager& operator=(const EpochManager&);
+
+	/**
+	 * A thread's announcement, on a cache line of its own; allocated aligned, since new does not
+	 * honour the alignment
+	 */
+  struct alignas(64) Slot
+  {
+		/**
+		 * Epoch the thread is inside, or 0 if it is outside any
+		 */
+		std::atomic<std::uint64_t> epoch;
+
+		/**
+		 * Number of enter() calls not yet matched by exit(); used only by the owning thread
+		 */
+		int depth;
+
+		/**
+		 * Holders of the slot: its manager and the thread using it.  Whichever lets go last frees the
+		 * slot; a slot the manager alone holds is idle and can be handed to another thread.
+		 */
+		std::atomic<int> holders;
+  };
+
+  static_assert(sizeof(Slot) == 64, "a slot must fill exactly one cache line");
+
+	/**
+	 * An object waiting to be reclaimed
+	 */
+  struct Retired
+  {
+		std::uint64_t epoch;
+		void* object;
+		ReclaimFunction reclaim;
+		void* context;
+  };
+
+  template <typename T>
+  static void deleteObject(void* object, void*)
+  {
+		delete static_cast<T*>(object);
+  }
+
+	/**
+	 * Returns the calling thread's slot
+	 */
+  Slot& local()
+  {
+		for (int i = 0; i < CACHE_SIZE; i++) {
+			if (cache[i].owner == id) {
+				return *cache[i].slot;
+			}
+		}
+		return localSlow();
+  }
+
+	/**
+	 * Finds the calling thread's slot, or gives it an idle or new one, and caches it
+	 */
+  Slot& localSlow();
+
+	/**
+	 * Lets go of a slot on behalf of its manager or its thread, freeing it if the other already has
+	 */
+  static void release(Slot* slot);
+
+	/**
+	 * reclaim() with the mutex held
+	 */
+  std::size_t reclaimLocked();
+
+	/**
+	 * Number of managers each thread remembers its slot for
+	 */
+  static const int CACHE_SIZE = 4;
+
+	/**
+	 * Thread-local mapping from manager to slot
+	 */
+  struct CacheEntry
+  {
+		std::uint64_t owner;
+		Slot* slot;
+  };
+
+  static thread_local CacheEntry cache[CACHE_SIZE];
+
+	/**
+	 * Every slot a thread uses, whatever the size of the cache; releases them when the thread exits
+	 */
+  struct ThreadSlots
+  {
+		~ThreadSlots();
+
+		std::vector<CacheEntry> entries;
+  };
+
+  static thread_local ThreadSlots threadSlots;
+
+	/**
+	 * Next cache entry to replace
+	 */
+  static thread_local int cacheNext;
+
+	/**
+	 * Unique, never reused identifier of this manager; never 0, which marks an empty cache entry
+	 */
+  const std::uint64_t id;
+
+	/**
+	 * The global epoch; starts at 1 so that 0 can mark a thread outside any epoch
+	 */
+  std::atomic<std::uint64_t> globalEpoch;
+
+	/**
+	 * Protects slots, retired and sinceReclaim, and orders the epoch advances
+	 */
+  mutable std::mutex mutex;
+
+	/**
+	 * Slots of the threads that have entered an epoch, including idle ones their threads released
+	 */
+  std::vector<Slot*> slots;
+
+	/**
+	 * Retired objects, oldest first
+	 */
+  std::deque<Retired> retired;
+
+	/**
+	 * Number of retirements since retire() last reclaimed
+	 */
+  std::size_t sinceReclaim;
+};
+
+/**
+* @brief Keeps the calling thread inside an epoch for the guard's lifetime
+*/
+class EpochGuard
+{
+ public:
+  explicit EpochGuard(EpochManager& manager)
+		: manager(manager)
+  {
+		manager.enter();
+  }
+
+  ~EpochGuard()
+  {
+		manager.exit();
+  }
+
+ private:
+  EpochGuard(const EpochGuard&);
+  EpochGuard& operator=(const EpochGuard&);
+
+  EpochManager& manager;
+};
+
+}
@@ -0,0 +1,22 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "buffer_pool_exists_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+BufferPoolExistsException::BufferPoolExistsException(const std::string& name)
+    : BadgerDbException(""), pool_name_(name) {
+  std::stringstream ss;
+  ss << "Buffer pool already exists: " << pool_name_;
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,47 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a buffer pool is requested by
+ *        a name that no pool has.
+ */
+class BufferPoolNotFoundException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a buffer pool not found exception for the given pool.
+   *
+   * @param name  Name of the pool.
+   */
+  explicit BufferPoolNotFoundException(const std::string& name);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~BufferPoolNotFoundException() throw() {}
+
+  /**
+   * Returns the name of the pool that caused this exception.
+   */
+  virtual const std::string& pool_name() const { return pool_name_; }
+
+ protected:
+  /**
+   * Name of the pool that caused this exception.
+   */
+  const std::string pool_name_;
+};
+
+}
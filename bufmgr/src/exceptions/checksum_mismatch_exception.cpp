@@ -0,0 +1,32 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "checksum_mismatch_exception.h"
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+ChecksumMismatchException::ChecksumMismatchException(
+    const std::string& name, const PageId page_num,
+    const std::uint32_t expected, const std::uint32_t actual)
+    : BadgerDbException(""),
+      filename_(name),
+      page_number_(page_num) {
+  std::stringstream ss;
+  ss << "Checksum mismatch on page " << page_number_;
+  if (!filename_.empty()) {
+    ss << " of file " << filename_;
+  }
+  ss << std::hex << std::setfill('0') << ": stored 0x" << std::setw(8)
+     << expected << ", computed 0x" << std::setw(8) << actual;
+  message_.assign(ss.str());
+}
+
+}
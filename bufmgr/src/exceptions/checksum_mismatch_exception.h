@@ -0,0 +1,65 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "badgerdb_exception.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a page read from disk does not match
+ *        the checksum stored in its header.
+ */
+class ChecksumMismatchException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a checksum mismatch exception for the given page.
+   *
+   * @param name      Name of the file the page was read from, or an empty
+   *                  string if it is not known.
+   * @param page_num  Number of the corrupt page.
+   * @param expected  Checksum stored in the page header.
+   * @param actual    Checksum computed over the page contents.
+   */
+  ChecksumMismatchException(const std::string& name, const PageId page_num,
+                            const std::uint32_t expected,
+                            const std::uint32_t actual);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~ChecksumMismatchException() throw() {}
+
+  /**
+   * Returns the name of the file the corrupt page was read from.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+  /**
+   * Returns the page number of the page that caused this exception.
+   */
+  virtual PageId page_number() const { return page_number_; }
+
+ protected:
+  /**
+   * Name of file the page was read from.
+   */
+  const std::string filename_;
+
+  /**
+   * Page number of page which caused this exception.
+   */
+  const PageId page_number_;
+};
+
+}
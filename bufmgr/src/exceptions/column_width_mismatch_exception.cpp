@@ -0,0 +1,30 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "column_width_mismatch_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+ColumnWidthMismatchException::ColumnWidthMismatchException(
+    const PageId page_num, const std::size_t column,
+    const std::size_t column_width, const std::size_t value_width)
+    : BadgerDbException(""),
+      page_number_(page_num),
+      column_(column),
+      column_width_(column_width),
+      value_width_(value_width) {
+  std::stringstream ss;
+  ss << "Column " << column_ << " of page " << page_number_ << " is "
+     << column_width_ << " bytes wide but was accessed as a " << value_width_
+     << " byte value.";
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,70 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "badgerdb_exception.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a column value is read or written
+ *        as a type whose size differs from the column's width.
+ */
+class ColumnWidthMismatchException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a column width mismatch exception for the given column.
+   *
+   * @param page_num      Number of the page being accessed.
+   * @param column        Index of the column.
+   * @param column_width  Width of the column in the schema.
+   * @param value_width   Size of the type the value was accessed as.
+   */
+  ColumnWidthMismatchException(const PageId page_num,
+                               const std::size_t column,
+                               const std::size_t column_width,
+                               const std::size_t value_width);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~ColumnWidthMismatchException() throw() {}
+
+  /**
+   * Returns the index of the column that caused this exception.
+   */
+  virtual std::size_t column() const { return column_; }
+
+ protected:
+  /**
+   * Number of the page being accessed.
+   */
+  const PageId page_number_;
+
+  /**
+   * Index of the column that caused this exception.
+   */
+  const std::size_t column_;
+
+  /**
+   * Width of the column in the schema.
+   */
+  const std::size_t column_width_;
+
+  /**
+   * Size of the type the value was accessed as.
+   */
+  const std::size_t value_width_;
+};
+
+}
@@ -0,0 +1,24 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "double_write_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+DoubleWriteException::DoubleWriteException(const std::string& name,
+                                           const std::string& reason)
+    : BadgerDbException(""),
+      filename_(name) {
+  std::stringstream ss;
+  ss << "Double write to '" << filename_ << "': " << reason;
+  message_.assign(ss.str());
+}
+
+}
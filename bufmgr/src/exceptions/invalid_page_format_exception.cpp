@@ -0,0 +1,24 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "invalid_page_format_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+InvalidPageFormatException::InvalidPageFormatException(
+    const PageId page_num, const std::string& expected)
+    : BadgerDbException(""),
+      page_number_(page_num) {
+  std::stringstream ss;
+  ss << "Page " << page_number_ << " is not formatted as " << expected;
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,50 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a page is accessed through a layout
+ *        it was not formatted with.
+ */
+class InvalidPageFormatException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an invalid page format exception for the given page.
+   *
+   * @param page_num  Number of the page that was accessed.
+   * @param expected  Description of the layout the caller expected.
+   */
+  InvalidPageFormatException(const PageId page_num,
+                             const std::string& expected);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~InvalidPageFormatException() throw() {}
+
+  /**
+   * Returns the page number of the page that caused this exception.
+   */
+  virtual PageId page_number() const { return page_number_; }
+
+ protected:
+  /**
+   * Page number of page which caused this exception.
+   */
+  const PageId page_number_;
+};
+
+}
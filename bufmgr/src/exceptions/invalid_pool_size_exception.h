@@ -0,0 +1,42 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a buffer pool is given a number of
+ *        frames it cannot have.
+ */
+class InvalidPoolSizeException : public BadgerDbException {
+ public:
+  /**
+   * Constructs an invalid pool size exception for the given number of frames.
+   *
+   * @param frames  Number of frames requested.
+   */
+  explicit InvalidPoolSizeException(const std::uint32_t frames);
+
+  /**
+   * Returns the number of frames that caused this exception.
+   */
+  virtual std::uint32_t frames() const { return frames_; }
+
+ protected:
+  /**
+   * Number of frames that caused this exception.
+   */
+  const std::uint32_t frames_;
+};
+
+}
@@ -0,0 +1,48 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a write-ahead log cannot be
+ *        created, read, written or synced to disk.
+ */
+class LogFileException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a log file exception for the given file.
+   *
+   * @param name    Name of the log file.
+   * @param reason  Description of what went wrong.
+   */
+  LogFileException(const std::string& name, const std::string& reason);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~LogFileException() throw() {}
+
+  /**
+   * Returns the name of the log file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Name of the log file that caused this exception.
+   */
+  const std::string filename_;
+};
+
+}
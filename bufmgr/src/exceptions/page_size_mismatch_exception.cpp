@@ -0,0 +1,28 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "page_size_mismatch_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+PageSizeMismatchException::PageSizeMismatchException(
+    const std::string& name, const std::size_t file_page_size,
+    const std::size_t page_size)
+    : BadgerDbException(""),
+      filename_(name),
+      file_page_size_(file_page_size),
+      page_size_(page_size) {
+  std::stringstream ss;
+  ss << "File '" << filename_ << "' has " << file_page_size_
+     << " byte pages but was opened with " << page_size_ << " byte pages.";
+  message_.assign(ss.str());
+}
+
+}
@@ -0,0 +1,62 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a file is opened with a page size
+ *        different from the one it was created with.
+ */
+class PageSizeMismatchException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a page size mismatch exception for the given file.
+   *
+   * @param name            Name of file that was opened.
+   * @param file_page_size  Page size recorded in the file header.
+   * @param page_size       Page size the file was opened with.
+   */
+  PageSizeMismatchException(const std::string& name,
+                            const std::size_t file_page_size,
+                            const std::size_t page_size);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~PageSizeMismatchException() throw() {}
+
+  /**
+   * Returns the name of the file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Name of file that caused this exception.
+   */
+  const std::string filename_;
+
+  /**
+   * Page size recorded in the file header.
+   */
+  const std::size_t file_page_size_;
+
+  /**
+   * Page size the file was opened with.
+   */
+  const std::size_t page_size_;
+};
+
+}
@@ -0,0 +1,48 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when recovery cannot replay a
+ *        write-ahead log onto the files it covers.
+ */
+class RecoveryException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a recovery exception for the given file.
+   *
+   * @param name    Name of the log or data file recovery failed on.
+   * @param reason  Description of what went wrong.
+   */
+  RecoveryException(const std::string& name, const std::string& reason);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~RecoveryException() throw() {}
+
+  /**
+   * Returns the name of the file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Name of the file that caused this exception.
+   */
+  const std::string filename_;
+};
+
+}
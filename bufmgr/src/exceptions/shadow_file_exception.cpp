@@ -0,0 +1,24 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "shadow_file_exception.h"
+
+#include <sstream>
+#include <string>
+
+namespace badgerdb {
+
+ShadowFileException::ShadowFileException(const std::string& name,
+                                         const std::string& reason)
+    : BadgerDbException(""),
+      filename_(name) {
+  std::stringstream ss;
+  ss << "Shadow file '" << filename_ << "': " << reason;
+  message_.assign(ss.str());
+}
+
+}
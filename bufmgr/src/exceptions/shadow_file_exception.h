@@ -0,0 +1,48 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a file in the shadow format cannot
+ *        be read, committed or written.
+ */
+class ShadowFileException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a shadow file exception for the given file.
+   *
+   * @param name    Name of the file.
+   * @param reason  Description of what went wrong.
+   */
+  ShadowFileException(const std::string& name, const std::string& reason);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~ShadowFileException() throw() {}
+
+  /**
+   * Returns the name of the file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Name of the file that caused this exception.
+   */
+  const std::string filename_;
+};
+
+}
@@ -0,0 +1,48 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "badgerdb_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief An exception that is thrown when a page access trace cannot be
+ *        created or read.
+ */
+class TraceFileException : public BadgerDbException {
+ public:
+  /**
+   * Constructs a trace file exception for the given file.
+   *
+   * @param name    Name of the trace file.
+   * @param reason  Description of what went wrong.
+   */
+  TraceFileException(const std::string& name, const std::string& reason);
+
+  /**
+   * Destroys the exception.  Does nothing special; just included to make the
+   * compiler happy.
+   */
+  virtual ~TraceFileException() throw() {}
+
+  /**
+   * Returns the name of the trace file that caused this exception.
+   */
+  virtual const std::string& filename() const { return filename_; }
+
+ protected:
+  /**
+   * Name of the trace file that caused this exception.
+   */
+  const std::string filename_;
+};
+
+}
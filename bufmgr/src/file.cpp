@@ -9,32 +9,85 @@
 
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <cstdio>
+#include <cstring>
 #include <cassert>
 
+#include "exceptions/checksum_mismatch_exception.h"
 #include "exceptions/file_exists_exception.h"
 #include "exceptions/file_not_found_exception.h"
 #include "exceptions/file_open_exception.h"
 #include "exceptions/invalid_page_exception.h"
+#include "exceptions/page_size_mismatch_exception.h"
+#include "exceptions/shadow_file_exception.h"
 #include "file_iterator.h"
 #include "page.h"
+#include "write_ahead_log.h"
 
 namespace badgerdb {
 
-File::StreamMap File::open_streams_;
-File::CountMap File::open_counts_;
+namespace {
 
-File File::create(const std::string& filename) {
-  return File(filename, true /* create_new */);
+// Returns a copy of the name that lives as long as the process, for pages that
+// report it after their file is gone.
+const std::string* internName(const std::string& name) {
+  static std::mutex mutex;
+  static std::set<std::string> names;
+  std::lock_guard<std::mutex> lock(mutex);
+  return &*names.insert(name).first;
 }
 
-File File::open(const std::string& filename) {
-  return File(filename, false /* create_new */);
+// The files open in the process, whatever page size they were opened with.
+struct OpenFiles {
+  std::map<std::string, std::shared_ptr<std::fstream> > streams;
+  std::map<std::string, int> counts;
+  std::map<std::string, std::shared_ptr<CompressedPageStore> > stores;
+  std::map<std::string, std::shared_ptr<ShadowPageStore> > shadows;
+};
+
+OpenFiles open_files;
+
+}
+
+template <std::size_t PageSize>
+typename BasicFile<PageSize>::StreamMap& BasicFile<PageSize>::open_streams_ =
+    open_files.streams;
+
+template <std::size_t PageSize>
+typename BasicFile<PageSize>::CountMap& BasicFile<PageSize>::open_counts_ =
+    open_files.counts;
+
+template <std::size_t PageSize>
+typename BasicFile<PageSize>::StoreMap& BasicFile<PageSize>::open_stores_ =
+    open_files.stores;
+
+template <std::size_t PageSize>
+typename BasicFile<PageSize>::ShadowMap& BasicFile<PageSize>::open_shadows_ =
+    open_files.shadows;
+
+template <std::size_t PageSize>
+BasicFile<PageSize> BasicFile<PageSize>::create(const std::string& filename) {
+  return BasicFile(filename, true /* create_new */, FILE_FORMAT_PLAIN);
 }
 
-void File::remove(const std::string& filename) {
+template <std::size_t PageSize>
+BasicFile<PageSize> BasicFile<PageSize>::create(const std::string& filename,
+                                                const FileFormat format) {
+  return BasicFile(filename, true /* create_new */, format);
+}
+
+template <std::size_t PageSize>
+BasicFile<PageSize> BasicFile<PageSize>::open(const std::string& filename) {
+  return BasicFile(filename, false /* create_new */, FILE_FORMAT_PLAIN);
+}
+
+template <std::size_t PageSize>
+void BasicFile<PageSize>::remove(const std::string& filename) {
   if (!exists(filename)) {
     throw FileNotFoundException(filename);
   }
@@ -44,14 +97,16 @@ void File::remove(const std::string& filename) {
   std::remove(filename.c_str());
 }
 
-bool File::isOpen(const std::string& filename) {
+template <std::size_t PageSize>
+bool BasicFile<PageSize>::isOpen(const std::string& filename) {
   if (!exists(filename)) {
     return false;
   }
   return open_counts_.find(filename) != open_counts_.end();
 }
 
-bool File::exists(const std::string& filename) {
+template <std::size_t PageSize>
+bool BasicFile<PageSize>::exists(const std::string& filename) {
 	std::fstream file(filename);
 	if(file)
 	{
@@ -62,26 +117,50 @@ bool File::exists(const std::string& filename) {
 	return false;
 }
 
-File::File(const File& other)
+template <std::size_t PageSize>
+BasicFile<PageSize>::BasicFile(const BasicFile& other)
   : filename_(other.filename_),
-    stream_(open_streams_[filename_]) {
+    stream_(open_streams_[filename_]),
+    checksum_mode_(other.checksum_mode_),
+    store_(other.store_),
+    shadow_(other.shadow_),
+    snapshot_(other.snapshot_),
+    log_(other.log_) {
   ++open_counts_[filename_];
 }
 
-File& File::operator=(const File& rhs) {
+template <std::size_t PageSize>
+BasicFile<PageSize>& BasicFile<PageSize>::operator=(const BasicFile& rhs) {
   // This accounts for self-assignment and assignment of a File object for the
   // same file.
+  const std::shared_ptr<CompressedPageStore> store = rhs.store_;
+  const std::shared_ptr<ShadowPageStore> shadow = rhs.shadow_;
+  const std::shared_ptr<const ShadowVersion> snapshot = rhs.snapshot_;
   close();	//close my file and associate me with the new one
   filename_ = rhs.filename_;
   openIfNeeded(false /* create_new */);
+  checksum_mode_ = rhs.checksum_mode_;
+  log_ = rhs.log_;
+  store_ = store;
+  if (store_) {
+    open_stores_[filename_] = store_;
+  }
+  shadow_ = shadow;
+  snapshot_ = snapshot;
+  if (shadow_) {
+    open_shadows_[filename_] = shadow_;
+  }
   return *this;
 }
 
-File::~File() {
+template <std::size_t PageSize>
+BasicFile<PageSize>::~BasicFile() {
   close();
 }
 
-Page File::allocatePage() {
+template <std::size_t PageSize>
+BasicPage<PageSize> BasicFile<PageSize>::allocatePage() {
+  checkWritable();
   FileHeader header = readHeader();
   Page new_page;
   Page existing_page;
@@ -123,10 +202,14 @@ Page File::allocatePage() {
       header.first_used_page = new_page.page_number();
     } else {
       // If we have pages allocated, we need to add the new page to the tail
-      // of the linked list.
-      for (FileIterator iter = begin(); iter != end(); ++iter) {
-        if ((*iter).next_page_number() == Page::INVALID_NUMBER) {
-          existing_page = *iter;
+      // of the linked list.  The used list is kept in page number order, so
+      // the tail is the highest numbered used page; search backwards for it
+      // rather than walking the whole list.
+      for (PageId page_number = header.num_pages - 1;
+           page_number != Page::INVALID_NUMBER; --page_number) {
+        if (readPageHeader(page_number).current_page_number !=
+            Page::INVALID_NUMBER) {
+          existing_page = readPage(page_number, false /* allow_free */);
           break;
         }
       }
@@ -135,6 +218,10 @@ Page File::allocatePage() {
     }
     ++header.num_pages;
   }
+  logListChange(new_page.page_number(), new_page,
+                existing_page.page_number() != Page::INVALID_NUMBER
+                    ? &existing_page : NULL,
+                header);
   writePage(new_page.page_number(), new_page);
   if (existing_page.page_number() != Page::INVALID_NUMBER) {
     // If we updated an existing page by inserting the new page into the
@@ -146,7 +233,9 @@ Page File::allocatePage() {
   return new_page;
 }
 
-Page File::readPage(const PageId page_number) const {
+template <std::size_t PageSize>
+BasicPage<PageSize> BasicFile<PageSize>::readPage(
+    const PageId page_number) const {
   FileHeader header = readHeader();
   if (page_number >= header.num_pages) {
     throw InvalidPageException(page_number, filename_);
@@ -154,11 +243,48 @@ Page File::readPage(const PageId page_number) const {
   return readPage(page_number, false /* allow_free */);
 }
 
-Page File::readPage(const PageId page_number, const bool allow_free) const {
+template <std::size_t PageSize>
+BasicPage<PageSize> BasicFile<PageSize>::readPage(
+    const PageId page_number, const bool allow_free) const {
   Page page;
-  stream_->seekg(pagePosition(page_number), std::ios::beg);
-  stream_->read(reinterpret_cast<char*>(&page.header_), sizeof(page.header_));
-  stream_->read(reinterpret_cast<char*>(&page.data_[0]), Page::DATA_SIZE);
+  if (shadow_) {
+    if (!shadow_->contains(snapshot_.get(), page_number)) {
+      throw InvalidPageException(page_number, filename_);
+    }
+    shadow_->readPage(*stream_, snapshot_.get(), page_number,
+                      reinterpret_cast<char*>(&page.header_),
+                      sizeof(page.header_), &page.data_[0]);
+  } else if (store_) {
+    if (!store_->contains(page_number)) {
+      throw InvalidPageException(page_number, filename_);
+    }
+    // A data area that fails to decompress is zero-filled and caught by the
+    // checksum.
+    store_->readPage(*stream_, page_number,
+                     reinterpret_cast<char*>(&page.header_), &page.data_[0]);
+  } else {
+    stream_->seekg(pagePosition(page_number), std::ios::beg);
+    stream_->read(reinterpret_cast<char*>(&page.header_),
+                  sizeof(page.header_));
+    stream_->read(reinterpret_cast<char*>(&page.data_[0]), Page::DATA_SIZE);
+  }
+  switch (checksum_mode_) {
+    case CHECKSUM_VERIFY_ON_READ: {
+      const std::uint32_t actual =
+          Page::computeChecksum(page.header_, page.data_);
+      if (actual != page.header_.checksum) {
+        throw ChecksumMismatchException(filename_, page_number,
+                                        page.header_.checksum, actual);
+      }
+      break;
+    }
+    case CHECKSUM_VERIFY_LAZILY:
+      page.checksum_pending_.store(true, std::memory_order_relaxed);
+      page.checksum_file_ = internName(filename_);
+      break;
+    case CHECKSUM_VERIFY_NEVER:
+      break;
+  }
   if (!allow_free && !page.isUsed()) {
     throw InvalidPageException(page_number, filename_);
   }
@@ -166,7 +292,8 @@ Page File::readPage(const PageId page_number, const bool allow_free) const {
   return page;
 }
 
-void File::writePage(const Page& new_page) {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::writePage(const Page& new_page) {
   PageHeader header = readPageHeader(new_page.page_number());
   if (header.current_page_number == Page::INVALID_NUMBER) {
     // Page has been deleted since it was read.
@@ -181,7 +308,9 @@ void File::writePage(const Page& new_page) {
   writePage(new_page.page_number(), header, new_page);
 }
 
-void File::deletePage(const PageId page_number) {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::deletePage(const PageId page_number) {
+  checkWritable();
   FileHeader header = readHeader();
   Page existing_page = readPage(page_number);
   Page previous_page;
@@ -204,6 +333,8 @@ void File::deletePage(const PageId page_number) {
   existing_page.set_next_page_number(header.first_free_page);
   header.first_free_page = page_number;
   ++header.num_free_pages;
+  logListChange(page_number, existing_page,
+                previous_page.isUsed() ? &previous_page : NULL, header);
   if (previous_page.isUsed()) {
     writePage(previous_page.page_number(), previous_page);
   }
@@ -211,27 +342,132 @@ void File::deletePage(const PageId page_number) {
   writeHeader(header);
 }
 
-FileIterator File::begin() {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::logListChange(const PageId page_number,
+                                        const Page& page, const Page* linked,
+                                        const FileHeader& header) {
+  if (log_ == NULL) {
+    return;
+  }
+  std::string image(reinterpret_cast<const char*>(&page.header_),
+                    sizeof(page.header_));
+  image.append(page.data_);
+  log_->appendPageRecord(LOG_FILE_PAGE, filename_, page_number, image.data(),
+                         image.size());
+  if (linked != NULL) {
+    const PageId next_page_number = linked->next_page_number();
+    log_->appendPageRecord(LOG_PAGE_LINK, filename_, linked->page_number(),
+                           &next_page_number, sizeof(next_page_number));
+  }
+  log_->flush(log_->appendPageRecord(LOG_FILE_HEADER, filename_,
+                                     0 /* page_number */, &header,
+                                     sizeof(header)));
+}
+
+template <std::size_t PageSize>
+void BasicFile<PageSize>::commit() {
+  checkWritable();
+  if (shadow_) {
+    shadow_->commit(*stream_);
+  }
+}
+
+template <std::size_t PageSize>
+BasicFile<PageSize> BasicFile<PageSize>::snapshot() const {
+  if (!shadow_) {
+    throw ShadowFileException(filename_, "is not in the shadow format");
+  }
+  BasicFile view(*this);
+  view.snapshot_ = shadow_->snapshot();
+  view.log_ = NULL;
+  return view;
+}
+
+template <std::size_t PageSize>
+void BasicFile<PageSize>::checkWritable() const {
+  if (snapshot_) {
+    throw ShadowFileException(filename_, "snapshot cannot be written");
+  }
+}
+
+template <std::size_t PageSize>
+BasicFileIterator<PageSize> BasicFile<PageSize>::begin() {
   const FileHeader& header = readHeader();
   return FileIterator(this, header.first_used_page);
 }
 
-FileIterator File::end() {
+template <std::size_t PageSize>
+BasicFileIterator<PageSize> BasicFile<PageSize>::end() {
   return FileIterator(this, Page::INVALID_NUMBER);
 }
 
-File::File(const std::string& name, const bool create_new) : filename_(name) {
+template <std::size_t PageSize>
+BasicFile<PageSize>::BasicFile(const std::string& name, const bool create_new,
+                               const FileFormat format)
+    : filename_(name),
+      checksum_mode_(CHECKSUM_VERIFY_ON_READ),
+      log_(NULL) {
   openIfNeeded(create_new);
 
+  // The mapping table of a compressed file, and the root areas of a shadow
+  // file, start after the file header.
+  const std::uint64_t first_chunk =
+      (sizeof(FileHeader) + CompressedPageStore::SLOT_UNIT - 1) /
+      CompressedPageStore::SLOT_UNIT * CompressedPageStore::SLOT_UNIT;
+  const std::uint64_t first_root =
+      (sizeof(FileHeader) + ShadowPageStore::ROOT_SIZE - 1) /
+      ShadowPageStore::ROOT_SIZE * ShadowPageStore::ROOT_SIZE;
   if (create_new) {
     // File starts with 1 page (the header).
     FileHeader header = {1 /* num_pages */, 0 /* first_used_page */,
-                         0 /* num_free_pages */, 0 /* first_free_page */};
+                         0 /* num_free_pages */, 0 /* first_free_page */,
+                         PageSize /* page_size */,
+                         static_cast<std::uint32_t>(format) /* format */};
     writeHeader(header);
+    if (format == FILE_FORMAT_COMPRESSED) {
+      store_.reset(new CompressedPageStore(*stream_, first_chunk, Page::SIZE,
+                                           sizeof(PageHeader),
+                                           true /* create_new */));
+      open_stores_[filename_] = store_;
+    } else if (format == FILE_FORMAT_SHADOW) {
+      shadow_.reset(new ShadowPageStore(
+          *stream_, filename_, first_root, Page::SIZE,
+          std::string(reinterpret_cast<const char*>(&header), sizeof(header)),
+          true /* create_new */));
+      open_shadows_[filename_] = shadow_;
+    }
+  } else {
+    const FileHeader header = readHeader();
+    if (header.page_size != PageSize) {
+      close();
+      throw PageSizeMismatchException(filename_, header.page_size, PageSize);
+    }
+    if (header.format == FILE_FORMAT_COMPRESSED) {
+      typename StoreMap::iterator store = open_stores_.find(filename_);
+      if (store != open_stores_.end()) {
+        store_ = store->second;
+      } else {
+        store_.reset(new CompressedPageStore(*stream_, first_chunk, Page::SIZE,
+                                             sizeof(PageHeader),
+                                             false /* create_new */));
+        open_stores_[filename_] = store_;
+      }
+    } else if (header.format == FILE_FORMAT_SHADOW) {
+      typename ShadowMap::iterator shadow = open_shadows_.find(filename_);
+      if (shadow != open_shadows_.end()) {
+        shadow_ = shadow->second;
+      } else {
+        shadow_.reset(new ShadowPageStore(
+            *stream_, filename_, first_root, Page::SIZE,
+            std::string(sizeof(FileHeader), char()), false /* create_new */));
+        open_shadows_[filename_] = shadow_;
+      }
+    }
   }
 }
 
-void File::openIfNeeded(const bool create_new) {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::openIfNeeded(const bool create_new) {
   if (open_counts_.find(filename_) != open_counts_.end()) {	//exists an entry already
     ++open_counts_[filename_];
     stream_ = open_streams_[filename_];
@@ -258,48 +494,117 @@ void File::openIfNeeded(const bool create_new) {
   }
 }
 
-void File::close() {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::close() {
+  if (open_counts_[filename_] == 1 && shadow_ && shadow_->hasChanges()) {
+    // Closing the file commits it; there is no one to report a failure to,
+    // and the file keeps its last committed state.
+    try {
+      shadow_->commit(*stream_);
+    } catch (const ShadowFileException&) {
+    }
+  }
   --open_counts_[filename_];
   stream_.reset();
   if (open_counts_[filename_] == 0) {
     open_streams_.erase(filename_);
     open_counts_.erase(filename_);
+    open_stores_.erase(filename_);
+    open_shadows_.erase(filename_);
   }
 }
 
-void File::writePage(const PageId page_number, const Page& new_page) {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::writePage(const PageId page_number,
+                                    const Page& new_page) {
   writePage(page_number, new_page.header_, new_page);
 }
 
-void File::writePage(const PageId page_number, const PageHeader& header,
-                     const Page& new_page) {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::writePage(const PageId page_number,
+                                    const PageHeader& header,
+                                    const Page& new_page) {
+  checkWritable();
+  PageHeader stamped = header;
+  stamped.checksum = Page::computeChecksum(header, new_page.data_);
+  if (shadow_) {
+    shadow_->writePage(*stream_, page_number,
+                       reinterpret_cast<const char*>(&stamped),
+                       sizeof(stamped), new_page.data_.data());
+    return;
+  }
+  if (store_) {
+    store_->writePage(*stream_, page_number,
+                      reinterpret_cast<const char*>(&stamped),
+                      new_page.data_.data());
+    return;
+  }
   stream_->seekp(pagePosition(page_number), std::ios::beg);
-  stream_->write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream_->write(reinterpret_cast<const char*>(&stamped), sizeof(stamped));
   stream_->write(reinterpret_cast<const char*>(&new_page.data_[0]),
                  Page::DATA_SIZE);
   stream_->flush();
 }
 
-FileHeader File::readHeader() const {
+template <std::size_t PageSize>
+FileHeader BasicFile<PageSize>::readHeader() const {
   FileHeader header;
+  if (shadow_) {
+    const std::string& metadata =
+        snapshot_ ? snapshot_->metadata : shadow_->metadata();
+    std::memcpy(&header, metadata.data(), sizeof(header));
+    return header;
+  }
   stream_->seekg(0 /* pos */, std::ios::beg);
   stream_->read(reinterpret_cast<char*>(&header), sizeof(header));
 
   return header;
 }
 
-void File::writeHeader(const FileHeader& header) {
+template <std::size_t PageSize>
+void BasicFile<PageSize>::writeHeader(const FileHeader& header) {
+  checkWritable();
+  if (shadow_) {
+    shadow_->setMetadata(
+        std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+    return;
+  }
   stream_->seekp(0 /* pos */, std::ios::beg);
   stream_->write(reinterpret_cast<const char*>(&header), sizeof(header));
   stream_->flush();
 }
 
-PageHeader File::readPageHeader(PageId page_number) const {
+template <std::size_t PageSize>
+PageHeader BasicFile<PageSize>::readPageHeader(PageId page_number) const {
   PageHeader header;
+  if (shadow_) {
+    if (shadow_->contains(snapshot_.get(), page_number)) {
+      shadow_->readPage(*stream_, snapshot_.get(), page_number,
+                        reinterpret_cast<char*>(&header), sizeof(header),
+                        NULL);
+    } else {
+      header = PageHeader();
+    }
+    return header;
+  }
+  if (store_) {
+    if (store_->contains(page_number)) {
+      store_->readPageHeader(*stream_, page_number,
+                             reinterpret_cast<char*>(&header));
+    } else {
+      // Never written; report it as a free page.
+      header = PageHeader();
+    }
+    return header;
+  }
   stream_->seekg(pagePosition(page_number), std::ios::beg);
   stream_->read(reinterpret_cast<char*>(&header), sizeof(header));
 
   return header;
 }
 
+#define BADGERDB_INSTANTIATE_FILE(size) template class BasicFile<size>;
+BADGERDB_FOR_EACH_PAGE_SIZE(BADGERDB_INSTANTIATE_FILE)
+#undef BADGERDB_INSTANTIATE_FILE
+
 }
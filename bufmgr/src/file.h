@@ -12,11 +12,65 @@
 #include <map>
 #include <memory>
 
+#include "compressed_page_store.h"
 #include "page.h"
+#include "shadow_page_store.h"
 
 namespace badgerdb {
 
-class FileIterator;
+template <std::size_t PageSize> class BasicFileIterator;
+class WriteAheadLog;
+
+/**
+ * @brief When a File checks page checksums on read.
+ *
+ * Every page is stamped with a CRC32C of its contents when it is written.
+ */
+enum ChecksumMode {
+  /**
+   * Verify each page as it is read from disk.
+   */
+  CHECKSUM_VERIFY_ON_READ,
+
+  /**
+   * Verify a page the first time its records are accessed.  Pages that are
+   * read but never looked at (e.g. while walking the page list) are not
+   * checked.
+   */
+  CHECKSUM_VERIFY_LAZILY,
+
+  /**
+   * Never verify checksums.  Pages are still stamped when written.
+   */
+  CHECKSUM_VERIFY_NEVER
+};
+
+/**
+ * @brief How pages are laid out in a file on disk.
+ */
+enum FileFormat {
+  /**
+   * Every page occupies a full page-sized slot at a position computed from
+   * its page number.
+   */
+  FILE_FORMAT_PLAIN = 0,
+
+  /**
+   * Page data areas are compressed and stored in variable-length slots
+   * located through a mapping table.
+   *
+   * @see CompressedPageStore
+   */
+  FILE_FORMAT_COMPRESSED = 1,
+
+  /**
+   * Pages are written copy-on-write and a set of changes becomes durable all
+   * at once when it is committed.
+   *
+   * @see ShadowPageStore
+   */
+  FILE_FORMAT_SHADOW = 2
+};
 
 /**
  * @brief Header metadata for files on disk which contain pages.
@@ -42,6 +96,16 @@ struct FileHeader {
    */
   PageId first_free_page;
 
+  /**
+   * Size in bytes of the pages stored in the file.
+   */
+  std::uint32_t page_size;
+
+  /**
+   * Layout of the pages in the file; a FileFormat value.
+   */
+  std::uint32_t format;
+
   /**
    * Returns true if this file header is equal to the other.
    *
@@ -52,7 +116,9 @@ struct FileHeader {
     return num_pages == rhs.num_pages &&
         num_free_pages == rhs.num_free_pages &&
         first_used_page == rhs.first_used_page &&
-        first_free_page == rhs.first_free_page;
+        first_free_page == rhs.first_free_page &&
+        page_size == rhs.page_size &&
+        format == rhs.format;
   }
 };
 
@@ -68,17 +134,54 @@ struct FileHeader {
  * detects this (by looking in the open_streams_ map) and just returns a file object with
  * the already created stream for the file without actually opening the UNIX file again. 
  *
+ * The page size is fixed per file: it is recorded in the file header when the
+ * file is created and checked whenever the file is opened.
+ *
+ * A file may be created in the compressed format, in which case page data is
+ * compressed on write and decompressed on read.  Pages returned by readPage()
+ * are always full-size, so callers such as the buffer manager are unaware of
+ * the format.
+ *
+ * A file may instead be created in the shadow format, in which case writes,
+ * including the changes to the page lists made by allocatePage() and
+ * deletePage(), are not visible after a crash until commit() publishes them
+ * together.  The file header at the start of the file then only records the
+ * page size and format; the current header is committed with the pages.
+ * snapshot() returns a read-only view of the last committed state that later
+ * changes do not affect.
+ *
  * @warning This class is not threadsafe.
  */
-class File {
+template <std::size_t PageSize>
+class BasicFile {
  public:
+  /**
+   * Type of the pages stored in this file.
+   */
+  typedef BasicPage<PageSize> Page;
+
+  /**
+   * Type of iterator over the pages of this file.
+   */
+  typedef BasicFileIterator<PageSize> FileIterator;
+
   /**
    * Creates a new file.
    *
    * @param filename  Name of the file.
    * @throws  FileExistsException     If the requested file already exists.
    */
-  static File create(const std::string& filename);
+  static BasicFile create(const std::string& filename);
+
+  /**
+   * Creates a new file with the given page layout.
+   *
+   * @param filename  Name of the file.
+   * @param format    Layout of the pages on disk.
+   * @throws  FileExistsException     If the requested file already exists.
+   */
+  static BasicFile create(const std::string& filename,
+                          const FileFormat format);
 
   /**
    * Opens the file named fileName and returns the corresponding File object.
@@ -89,8 +192,10 @@ class File {
    *
    * @param filename  Name of the file.
    * @throws  FileNotFoundException   If the requested file doesn't exist.
+   * @throws  PageSizeMismatchException If the file was created with a
+   *                                    different page size.
    */
-  static File open(const std::string& filename);
+  static BasicFile open(const std::string& filename);
 
   /**
    * Deletes an existing file.
@@ -122,7 +227,7 @@ class File {
    * @param other File object to copy.
    * @return      A copy of the File object.
    */
-  File(const File& other);
+  BasicFile(const BasicFile& other);
 
   /**
    * Assignment operator.
@@ -130,13 +235,13 @@ class File {
    * @param rhs File object to assign.
    * @return    Newly assigned file object.
    */
-  File& operator=(const File& rhs);
+  BasicFile& operator=(const BasicFile& rhs);
 
   /**
    * Destructor that automatically closes the underlying file if no other
    * File objects are using it.
    */
-  ~File();
+  ~BasicFile();
 
   /**
    * Allocates a new page in the file.
@@ -152,6 +257,8 @@ class File {
    * @return  The page.
    * @throws  InvalidPageException  If the page doesn't exist in the file or is
    *                                not currently used.
+   * @throws  ChecksumMismatchException If the page is corrupt and checksums
+   *                                    are verified on read.
    */
   Page readPage(const PageId page_number) const;
 
@@ -171,6 +278,35 @@ class File {
    */
   void deletePage(const PageId page_number);
 
+  /**
+   * Makes the changes written to a file in the shadow format since its last
+   * commit durable, all at once.  Until then a crash loses all of them.
+   * Changes are also committed when the last File object for the file is
+   * closed.  Does nothing for files in other formats, whose writes take
+   * effect as they are made.
+   *
+   * @throws  ShadowFileException   If the file cannot be synced, or this
+   *                                object is a snapshot.
+   */
+  void commit();
+
+  /**
+   * Returns a read-only File object for the last committed state of a file
+   * in the shadow format.  Its pages and header stay as they are however the
+   * file is changed and committed afterwards, and the space they use is not
+   * reused until the snapshot and all copies of it are destroyed.  Writing
+   * through it throws ShadowFileException.
+   *
+   * @return  Snapshot of the file.
+   * @throws  ShadowFileException   If the file is not in the shadow format.
+   */
+  BasicFile snapshot() const;
+
+  /**
+   * Returns true if this object is a snapshot returned by snapshot().
+   */
+  bool isSnapshot() const { return snapshot_ != NULL; }
+
   /**
    * Returns the name of the file this object represents.
    *
@@ -178,6 +314,72 @@ class File {
    */
   const std::string& filename() const { return filename_; }
 
+  /**
+   * Sets when pages read through this object have their checksums verified.
+   * The mode is per object and is kept by copies.
+   *
+   * @param mode  Checksum verification mode.
+   */
+  void setChecksumMode(const ChecksumMode mode) { checksum_mode_ = mode; }
+
+  /**
+   * Returns when pages read through this object have their checksums
+   * verified.
+   */
+  ChecksumMode checksumMode() const { return checksum_mode_; }
+
+  /**
+   * Attaches a write-ahead log, or detaches it with NULL.  While a log is
+   * attached, allocatePage() and deletePage() log the pages and the file header
+   * they are about to write and flush the log first, so that recovery can
+   * finish a change to the used and free page lists that a crash cut short.
+   * The log is per object and is kept by copies.
+   *
+   * @param log   Log to use, which must outlive its use by this object, or
+   *              NULL.
+   */
+  void setLog(WriteAheadLog* log) { log_ = log; }
+
+  /**
+   * Returns the attached write-ahead log, or NULL if none is attached.
+   */
+  WriteAheadLog* log() const { return log_; }
+
+  /**
+   * Returns the layout of the pages in this file.
+   */
+  FileFormat format() const {
+    if (store_) {
+      return FILE_FORMAT_COMPRESSED;
+    }
+    return shadow_ ? FILE_FORMAT_SHADOW : FILE_FORMAT_PLAIN;
+  }
+
+  /**
+   * Sets how many bytes of compressed page images are kept in memory for
+   * this file.  The cache is shared by all File objects for the file.  Has no
+   * effect on files in the plain format.
+   *
+   * @param bytes   Cache capacity in bytes; zero disables the cache.
+   */
+  void setCompressedCacheSize(const std::size_t bytes) {
+    if (store_) {
+      store_->setCacheCapacity(bytes);
+    }
+  }
+
+  /**
+   * Returns the hit and miss counts of the compressed page cache.  Both are
+   * zero for files in the plain format.
+   */
+  CompressedCacheStats compressedCacheStats() const {
+    if (store_) {
+      return store_->cacheStats();
+    }
+    const CompressedCacheStats none = {0, 0};
+    return none;
+  }
+
   /**
    * Returns an iterator at the first page in the file.
    *
@@ -214,12 +416,16 @@ class File {
    * @see File::open()
    * @param name        Name of file.
    * @param create_new  Whether to create a new file.
+   * @param format      Layout of the pages of a new file.
    * @throws  FileExistsException     If the underlying file exists and
    *                                  create_new is true.
    * @throws  FileNotFoundException   If the underlying file doesn't exist and
    *                                  create_new is false.
+   * @throws  PageSizeMismatchException If an existing file was created with a
+   *                                    different page size.
    */
-  File(const std::string& name, const bool create_new);
+  BasicFile(const std::string& name, const bool create_new,
+            const FileFormat format);
 
   /**
    * Opens the underlying file named in filename_.
@@ -253,6 +459,8 @@ class File {
    * @return  The page.
    * @throws  InvalidPageException  If the page is free (unused) and
    *                                allow_free is false.
+   * @throws  ChecksumMismatchException If the page is corrupt and checksums
+   *                                    are verified on read.
    */
   Page readPage(const PageId page_number, const bool allow_free) const;
 
@@ -269,7 +477,8 @@ class File {
   /**
    * Writes a page into the file at the given page number with the given header.
    * This does not ensure that the number in the header equals the position on
-   * disk.  No bounds checking is performed.
+   * disk.  No bounds checking is performed.  The header is written with the
+   * checksum of the page contents.
    *
    * @param page_number Number of page whose contents to replace.
    * @param header      Header of page to write.
@@ -301,19 +510,53 @@ class File {
    */
   PageHeader readPageHeader(const PageId page_number) const;
 
+  /**
+   * Logs the writes allocatePage() or deletePage() is about to make and
+   * flushes the log.  Does nothing if no log is attached.
+   *
+   * @param page_number Number of the page to be written.
+   * @param page        Page to be written as is, including its next page
+   *                    number.
+   * @param linked      Page whose next page number is to be changed, or NULL.
+   * @param header      File header to be written.
+   */
+  void logListChange(const PageId page_number, const Page& page,
+                     const Page* linked, const FileHeader& header);
+
+  /**
+   * Throws ShadowFileException if this object is a snapshot.
+   */
+  void checkWritable() const;
+
   typedef std::map<std::string,
                    std::shared_ptr<std::fstream> > StreamMap;
   typedef std::map<std::string, int> CountMap;
+  typedef std::map<std::string,
+                   std::shared_ptr<CompressedPageStore> > StoreMap;
+  typedef std::map<std::string,
+                   std::shared_ptr<ShadowPageStore> > ShadowMap;
 
   /**
-   * Streams for opened files.
+   * Streams for opened files.  This and the maps below are one registry shared
+   * by the File classes of every page size, so a file open with any page size
+   * counts as open for isOpen() and remove().
    */
-  static StreamMap open_streams_;
+  static StreamMap& open_streams_;
 
   /**
    * Counts for opened files.
    */
-  static CountMap open_counts_;
+  static CountMap& open_counts_;
+
+  /**
+   * Page stores for opened files in the compressed format.
+   */
+  static StoreMap& open_stores_;
+
+  /**
+   * Page stores for opened files in the shadow format.
+   */
+  static ShadowMap& open_shadows_;
 
   /**
    * Name of the file this object represents.
@@ -325,8 +568,40 @@ class File {
    */
   std::shared_ptr<std::fstream> stream_;
 
-  friend class FileIterator;
+  /**
+   * When pages read through this object are verified.
+   */
+  ChecksumMode checksum_mode_;
+
+  /**
+   * Page store if the file is in the compressed format; null otherwise.
+   */
+  std::shared_ptr<CompressedPageStore> store_;
+
+  /**
+   * Page store if the file is in the shadow format; null otherwise.
+   */
+  std::shared_ptr<ShadowPageStore> shadow_;
+
+  /**
+   * Committed state this object reads if it is a snapshot; null otherwise.
+   */
+  std::shared_ptr<const ShadowVersion> snapshot_;
+
+  /**
+   * Write-ahead log that changes to the page lists are logged to, or NULL.
+   */
+  WriteAheadLog* log_;
+
+  friend class BasicFileIterator<PageSize>;
+  template <std::size_t> friend class BasicRecovery;
+  template <std::size_t> friend class BasicDoubleWriteBuffer;
   friend class FileTest;
 };
 
+/**
+ * @brief File of pages with the default page size.
+ */
+typedef BasicFile<DEFAULT_PAGE_SIZE> File;
+
 }
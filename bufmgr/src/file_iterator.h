@@ -20,12 +20,23 @@ namespace badgerdb {
  * This class provides a forward-only iterator for iterating over all of the
  * pages in a file.
  */
-class FileIterator {
+template <std::size_t PageSize>
+class BasicFileIterator {
  public:
+  /**
+   * Type of file this iterator walks over.
+   */
+  typedef BasicFile<PageSize> File;
+
+  /**
+   * Type of the pages returned by this iterator.
+   */
+  typedef BasicPage<PageSize> Page;
+
   /**
    * Constructs an empty iterator.
    */
-  FileIterator()
+  BasicFileIterator()
       : file_(NULL),
         current_page_number_(Page::INVALID_NUMBER) {
   }
@@ -36,7 +47,7 @@ class FileIterator {
    *
    * @param file  File to iterate over.
    */
-  FileIterator(File* file)
+  BasicFileIterator(File* file)
       : file_(file) {
     assert(file_ != NULL);
     const FileHeader& header = file_->readHeader();
@@ -50,7 +61,7 @@ class FileIterator {
    * @param file        File to iterate over.
    * @param page_number Number of page to start iterator at.
    */
-  FileIterator(File* file, PageId page_number)
+  BasicFileIterator(File* file, PageId page_number)
       : file_(file),
         current_page_number_(page_number) {
   }
@@ -58,7 +69,7 @@ class FileIterator {
   /**
    * Advances the iterator to the next page in the file.
    */
-	inline FileIterator& operator++() {
+	inline BasicFileIterator& operator++() {
     assert(file_ != NULL);
     const PageHeader& header = file_->readPageHeader(current_page_number_);
     current_page_number_ = header.next_page_number;
@@ -67,9 +78,9 @@ class FileIterator {
 	}
 
 	//postfix
-	inline FileIterator operator++(int)
+	inline BasicFileIterator operator++(int)
 	{
-		FileIterator tmp = *this;   // copy ourselves
+		BasicFileIterator tmp = *this;   // copy ourselves
 
     assert(file_ != NULL);
     const PageHeader& header = file_->readPageHeader(current_page_number_);
@@ -84,12 +95,12 @@ class FileIterator {
    * @param rhs   Iterator to compare against.
    * @return    True if other iterator is equal to this one.
    */
-	inline bool operator==(const FileIterator& rhs) const {
+	inline bool operator==(const BasicFileIterator& rhs) const {
     return file_->filename() == rhs.file_->filename() &&
         current_page_number_ == rhs.current_page_number_;
   }
 
-	inline bool operator!=(const FileIterator& rhs) const {
+	inline bool operator!=(const BasicFileIterator& rhs) const {
     return (file_->filename() != rhs.file_->filename()) ||
         (current_page_number_ != rhs.current_page_number_);
   }
@@ -115,4 +126,9 @@ class FileIterator {
   PageId current_page_number_;
 };
 
+/**
+ * @brief Iterator over the pages of a file with the default page size.
+ */
+typedef BasicFileIterator<DEFAULT_PAGE_SIZE> FileIterator;
+
 }
@@ -0,0 +1,365 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <stdint.h>
+#include <string>
+
+#include "page.h"
+#include "types.h"
+#include "exceptions/insufficient_space_exception.h"
+#include "exceptions/invalid_page_format_exception.h"
+#include "exceptions/invalid_record_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Metadata at the start of the data area of a fixed-length record page.
+ */
+struct FixedPageHeader {
+  /**
+   * Length of every record on the page.  Also identifies the layout: a page
+   * is only accessible through a FixedRecordPage of the same record size.
+   */
+  std::uint16_t record_size;
+
+  /**
+   * Number of records currently stored on the page.
+   */
+  std::uint16_t num_records;
+};
+
+/**
+ * @brief Layout for pages holding records of one compile-time length.
+ *
+ * Instead of a slot array, the data area holds a presence bitmap followed by a
+ * dense array of records.  The record in slot s lives at a fixed offset
+ * computed from s, so there is no per-record slot overhead and scans walk the
+ * bitmap a word at a time.  Slots are numbered from 1 as on slotted pages, so
+ * RecordIds keep their meaning.
+ *
+ * A FixedRecordPage is a view over a Page (for example a buffer pool frame);
+ * it does not own the page.  The page header's slot fields are left empty so
+ * the slotted-page API sees a full page with no records.
+ *
+ * @warning This class is not threadsafe.
+ */
+template <std::size_t RecordSize, std::size_t PageSize = DEFAULT_PAGE_SIZE>
+class FixedRecordPage {
+ public:
+  /**
+   * Type of the page this layout is applied to.
+   */
+  typedef BasicPage<PageSize> Page;
+
+  /**
+   * Length in bytes of every record on the page.
+   */
+  static const std::size_t RECORD_SIZE = RecordSize;
+
+ private:
+  /**
+   * Offset of the records array when the page holds <capacity> records.
+   */
+  static constexpr std::size_t recordsOffset(const std::size_t capacity) {
+    return (sizeof(FixedPageHeader) + (capacity + 7) / 8 + 7) & ~std::size_t(7);
+  }
+
+  /**
+   * Returns the largest capacity not above <capacity> that fits on the page.
+   */
+  static constexpr std::size_t maxCapacity(const std::size_t capacity) {
+    return recordsOffset(capacity) + capacity * RecordSize <= Page::DATA_SIZE
+        ? capacity : maxCapacity(capacity - 1);
+  }
+
+ public:
+  /**
+   * Number of records that fit on one page.  Each record costs RecordSize
+   * bytes plus one bit of bitmap.
+   */
+  static const std::size_t CAPACITY =
+      maxCapacity(8 * (Page::DATA_SIZE - sizeof(FixedPageHeader)) /
+                  (8 * RecordSize + 1));
+
+  /**
+   * Offset of the presence bitmap in the page's data area.
+   */
+  static const std::size_t BITMAP_OFFSET = sizeof(FixedPageHeader);
+
+  /**
+   * Offset of the first record in the page's data area.  Records are 8-byte
+   * aligned relative to the data area.
+   */
+  static const std::size_t RECORDS_OFFSET = recordsOffset(CAPACITY);
+
+  static_assert(RecordSize > 0, "Records must have a length.");
+  static_assert(CAPACITY > 0, "At least one record must fit on a page.");
+  static_assert(CAPACITY <= UINT16_MAX, "Slot numbers must fit in a SlotId.");
+
+  /**
+   * Formats the given page as an empty fixed-length record page, discarding
+   * its records.  The page number and next page pointer are kept.
+   *
+   * @param page  Page to format.
+   * @return  View over the formatted page.
+   */
+  static FixedRecordPage format(Page* page) {
+    page->header_.free_space_lower_bound = Page::DATA_SIZE;
+    page->header_.free_space_upper_bound = Page::DATA_SIZE;
+    page->header_.num_slots = 0;
+    page->header_.num_free_slots = 0;
+    page->data_.assign(Page::DATA_SIZE, char());
+    page->checksum_pending_.store(false, std::memory_order_relaxed);
+    FixedPageHeader* header =
+        reinterpret_cast<FixedPageHeader*>(&page->data_[0]);
+    header->record_size = RecordSize;
+    header->num_records = 0;
+    return FixedRecordPage(page);
+  }
+
+  /**
+   * Constructs a view over a page previously formatted with format().
+   *
+   * @param page  Page to access.
+   * @throws  InvalidPageFormatException  If the page was not formatted for
+   *                                      records of this size.
+   * @throws  ChecksumMismatchException   If the page was read lazily and is
+   *                                      corrupt.
+   */
+  explicit FixedRecordPage(Page* page)
+      : page_(page) {
+    page_->verifyIfPending();
+    if (header()->record_size != RecordSize ||
+        page_->header_.num_slots != 0) {
+      throw InvalidPageFormatException(page_->page_number(),
+                                       "a fixed-length record page");
+    }
+  }
+
+  /**
+   * Inserts a record into the first free slot.  Records shorter than
+   * RecordSize are padded with zero bytes.
+   *
+   * @param record_data  Bytes that compose the record.
+   * @return  ID of the newly inserted record.
+   * @throws  InsufficientSpaceException  If the page is full or the record is
+   *                                      longer than RecordSize.
+   */
+  RecordId insertRecord(const std::string& record_data) {
+    if (record_data.length() > RecordSize || isFull()) {
+      throw InsufficientSpaceException(
+          page_->page_number(), record_data.length(),
+          isFull() ? 0 : RecordSize);
+    }
+    const SlotId slot_number = firstFreeSlot();
+    char* record = recordAt(slot_number);
+    std::memcpy(record, record_data.data(), record_data.length());
+    std::memset(record + record_data.length(), 0,
+                RecordSize - record_data.length());
+    setUsed(slot_number, true);
+    ++header()->num_records;
+    return {page_->page_number(), slot_number};
+  }
+
+  /**
+   * Returns a copy of the record with the given ID.
+   *
+   * @param record_id  ID of the record to return.
+   * @return  The record.
+   */
+  std::string getRecord(const RecordId& record_id) const {
+    return std::string(getRecordData(record_id), RecordSize);
+  }
+
+  /**
+   * Returns a pointer to the bytes of the record with the given ID.  The
+   * pointer is valid until the page is reformatted or goes away.
+   *
+   * @param record_id  ID of the record.
+   * @return  Pointer to RecordSize bytes of record data.
+   */
+  const char* getRecordData(const RecordId& record_id) const {
+    validateRecordId(record_id);
+    return recordAt(record_id.slot_number);
+  }
+
+  /**
+   * Overwrites the record with the given ID in place.
+   *
+   * @param record_id   ID of record to update.
+   * @param record_data Updated bytes that compose the record.
+   */
+  void updateRecord(const RecordId& record_id,
+                    const std::string& record_data) {
+    validateRecordId(record_id);
+    if (record_data.length() > RecordSize) {
+      throw InsufficientSpaceException(
+          page_->page_number(), record_data.length(), RecordSize);
+    }
+    char* record = recordAt(record_id.slot_number);
+    std::memcpy(record, record_data.data(), record_data.length());
+    std::memset(record + record_data.length(), 0,
+                RecordSize - record_data.length());
+  }
+
+  /**
+   * Deletes the record with the given ID.  Other records do not move.
+   *
+   * @param record_id   ID of the record to delete.
+   */
+  void deleteRecord(const RecordId& record_id) {
+    validateRecordId(record_id);
+    setUsed(record_id.slot_number, false);
+    --header()->num_records;
+  }
+
+  /**
+   * Returns true if the given slot holds a record.
+   *
+   * @param slot_number   Slot to check.
+   */
+  bool isUsed(const SlotId slot_number) const {
+    const std::size_t bit = slot_number - 1;
+    return (bitmap()[bit / 8] >> (bit % 8)) & 1;
+  }
+
+  /**
+   * Returns the next used slot after the given slot or Page::INVALID_SLOT if
+   * no slots are used after it.  Pass Page::INVALID_SLOT to find the first.
+   *
+   * @param start   Slot to start search after.
+   * @return  Next used slot after given slot or Page::INVALID_SLOT.
+   */
+  SlotId getNextUsedSlot(const SlotId start) const {
+    // Slot s is bit s - 1, so the slot after <start> is bit <start>.
+    std::size_t bit = start;
+    while (bit < CAPACITY) {
+      std::uint64_t word = 0;
+      const std::size_t byte = bit / 8;
+      const std::size_t bytes = BITMAP_SIZE - byte < sizeof(word)
+          ? BITMAP_SIZE - byte : sizeof(word);
+      std::memcpy(&word, bitmap() + byte, bytes);
+      word >>= bit % 8;
+      if (word != 0) {
+        bit += __builtin_ctzll(word);
+        return bit < CAPACITY ? static_cast<SlotId>(bit + 1)
+                              : Page::INVALID_SLOT;
+      }
+      bit = (byte + bytes) * 8;
+    }
+    return Page::INVALID_SLOT;
+  }
+
+  /**
+   * Returns the number of records stored on the page.
+   */
+  std::uint16_t numRecords() const { return header()->num_records; }
+
+  /**
+   * Returns true if no more records fit on the page.
+   */
+  bool isFull() const { return header()->num_records == CAPACITY; }
+
+  /**
+   * Returns the number of the underlying page in its file.
+   */
+  PageId page_number() const { return page_->page_number(); }
+
+ private:
+  /**
+   * Size in bytes of the presence bitmap.
+   */
+  static const std::size_t BITMAP_SIZE = (CAPACITY + 7) / 8;
+
+  FixedPageHeader* header() {
+    return reinterpret_cast<FixedPageHeader*>(&page_->data_[0]);
+  }
+
+  const FixedPageHeader* header() const {
+    return reinterpret_cast<const FixedPageHeader*>(page_->data_.data());
+  }
+
+  unsigned char* bitmap() {
+    return reinterpret_cast<unsigned char*>(&page_->data_[BITMAP_OFFSET]);
+  }
+
+  const unsigned char* bitmap() const {
+    return reinterpret_cast<const unsigned char*>(
+        page_->data_.data() + BITMAP_OFFSET);
+  }
+
+  char* recordAt(const SlotId slot_number) {
+    return &page_->data_[RECORDS_OFFSET + (slot_number - 1) * RecordSize];
+  }
+
+  const char* recordAt(const SlotId slot_number) const {
+    return page_->data_.data() + RECORDS_OFFSET +
+        (slot_number - 1) * RecordSize;
+  }
+
+  void setUsed(const SlotId slot_number, const bool used) {
+    const std::size_t bit = slot_number - 1;
+    if (used) {
+      bitmap()[bit / 8] |= 1 << (bit % 8);
+    } else {
+      bitmap()[bit / 8] &= ~(1 << (bit % 8));
+    }
+  }
+
+  /**
+   * Returns the lowest numbered unused slot.  The page must not be full.
+   */
+  SlotId firstFreeSlot() const {
+    std::size_t byte = 0;
+    while (bitmap()[byte] == 0xFF) {
+      ++byte;
+    }
+    return static_cast<SlotId>(byte * 8 + __builtin_ctz(~bitmap()[byte]) + 1);
+  }
+
+  /**
+   * Throws an exception if the given record ID does not name a used slot on
+   * this page.
+   *
+   * @param record_id   Record ID to validate.
+   * @throws  InvalidRecordException  Thrown if the ID has a bad page or slot
+   *                                  number.
+   */
+  void validateRecordId(const RecordId& record_id) const {
+    if (record_id.page_number != page_->page_number() ||
+        record_id.slot_number == Page::INVALID_SLOT ||
+        record_id.slot_number > CAPACITY ||
+        !isUsed(record_id.slot_number)) {
+      throw InvalidRecordException(record_id, page_->page_number());
+    }
+  }
+
+  /**
+   * Page whose data area holds the records.
+   */
+  Page* page_;
+};
+
+template <std::size_t RecordSize, std::size_t PageSize>
+const std::size_t FixedRecordPage<RecordSize, PageSize>::RECORD_SIZE;
+
+template <std::size_t RecordSize, std::size_t PageSize>
+const std::size_t FixedRecordPage<RecordSize, PageSize>::CAPACITY;
+
+template <std::size_t RecordSize, std::size_t PageSize>
+const std::size_t FixedRecordPage<RecordSize, PageSize>::BITMAP_OFFSET;
+
+template <std::size_t RecordSize, std::size_t PageSize>
+const std::size_t FixedRecordPage<RecordSize, PageSize>::RECORDS_OFFSET;
+
+template <std::size_t RecordSize, std::size_t PageSize>
+const std::size_t FixedRecordPage<RecordSize, PageSize>::BITMAP_SIZE;
+
+}
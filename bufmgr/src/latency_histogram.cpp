@@ -0,0 +1,144 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "latency_histogram.h"
+
+#include <limits>
+
+namespace badgerdb {
+
+namespace {
+
+double calibrateNanosPerTick() {
+#if defined(__x86_64__)
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start = Clock::now();
+  const std::uint64_t start_ticks = latencyClockTicks();
+  Clock::time_point now;
+  do {
+    now = Clock::now();
+  } while (now - start < std::chrono::milliseconds(2));
+  const std::uint64_t ticks = latencyClockTicks() - start_ticks;
+  const double nanos = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - start)
+          .count());
+  return ticks == 0 ? 1.0 : nanos / ticks;
+#else
+  return 1.0;
+#endif
+}
+
+}
+
+double latencyClockNanosPerTick() {
+  static const double nanos_per_tick = calibrateNanosPerTick();
+  return nanos_per_tick;
+}
+
+const int LatencyHistogram::SUB_BUCKET_BITS;
+const std::size_t LatencyHistogram::SUB_BUCKETS;
+const std::size_t LatencyHistogram::NUM_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() {
+  clear();
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& other) {
+  clear();
+  add(other);
+}
+
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& other) {
+  if (this != &other) {
+    clear();
+    add(other);
+  }
+  return *this;
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+  for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+    const std::uint64_t n = other.bucketCount(i);
+    if (n != 0) {
+      bump(counts_[i], n);
+    }
+  }
+  bump(count_, other.count());
+  bump(sum_, other.sum());
+  const std::uint64_t other_min = other.min_.load(std::memory_order_relaxed);
+  if (other_min < min_.load(std::memory_order_relaxed)) {
+    min_.store(other_min, std::memory_order_relaxed);
+  }
+  if (other.max() > max()) {
+    max_.store(other.max(), std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::clear() {
+  for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+    counts_[i].store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  min_.store(std::numeric_limits<std::uint64_t>::max(),
+             std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::min() const {
+  return count() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+  const std::uint64_t n = count();
+  return n == 0 ? 0.0 : static_cast<double>(sum()) / n;
+}
+
+std::uint64_t LatencyHistogram::percentile(const double fraction) const {
+  // Sum the buckets rather than trusting count_, which a concurrent writer
+  // may have updated separately.
+  std::uint64_t total = 0;
+  for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+    total += bucketCount(i);
+  }
+  if (total == 0) {
+    return 0;
+  }
+  std::uint64_t rank = static_cast<std::uint64_t>(fraction * total + 0.5);
+  if (rank < 1) {
+    rank = 1;
+  } else if (rank > total) {
+    rank = total;
+  }
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += bucketCount(i);
+    if (seen >= rank) {
+      const std::uint64_t upper = bucketUpperBound(i);
+      return upper < max() ? upper : max();
+    }
+  }
+  return max();
+}
+
+std::uint64_t LatencyHistogram::bucketLowerBound(const std::size_t bucket) {
+  if (bucket < 2 * SUB_BUCKETS) {
+    return bucket;
+  }
+  const int shift = static_cast<int>(bucket / SUB_BUCKETS) - 1;
+  return static_cast<std::uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS)
+      << shift;
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(const std::size_t bucket) {
+  if (bucket + 1 >= NUM_BUCKETS) {
+    return std::numeric_limits<std::uint64_t>::max();
+  }
+  return bucketLowerBound(bucket + 1) - 1;
+}
+
+}
@@ -0,0 +1,222 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace badgerdb {
+
+/**
+ * Returns a timestamp from the cheapest monotonic clock available: the time
+ * stamp counter on x86-64, std::chrono::steady_clock in nanoseconds elsewhere.
+ * Differences between timestamps are converted to nanoseconds with
+ * latencyClockNanosPerTick().
+ *
+ * @return  Current timestamp in clock ticks.
+ */
+inline std::uint64_t latencyClockTicks() {
+#if defined(__x86_64__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Returns the length of one latencyClockTicks() tick in nanoseconds.  The
+ * time stamp counter is calibrated against steady_clock on the first call,
+ * which spins for about two milliseconds; later calls are free.
+ *
+ * @return  Nanoseconds per tick.
+ */
+double latencyClockNanosPerTick();
+
+/**
+ * @brief Log-linear histogram of latencies in nanoseconds.
+ *
+ * Values below 32 have a bucket each; above that every power of two is split
+ * into 16 equal buckets, so any recorded value is known to within 1/16 (6.25%)
+ * over the full 64-bit range in a fixed 976 buckets.  This is the layout used
+ * by HdrHistogram with one significant hex digit.
+ *
+ * record() is meant to be called by a single thread (the owner of a per-thread
+ * histogram) and costs a few plain loads and stores; other threads may read
+ * or add() the histogram concurrently and see a slightly stale copy.
+ */
+class LatencyHistogram {
+ public:
+  /**
+   * log2 of the number of buckets each power of two is split into.
+   */
+  static const int SUB_BUCKET_BITS = 4;
+
+  /**
+   * Number of buckets each power of two is split into.
+   */
+  static const std::size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+  /**
+   * Total number of buckets.
+   */
+  static const std::size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  /**
+   * Constructs an empty histogram.
+   */
+  LatencyHistogram();
+
+  /**
+   * Constructs a copy of another histogram.
+   */
+  LatencyHistogram(const LatencyHistogram& other);
+
+  /**
+   * Replaces this histogram's contents with a copy of another's.
+   */
+  LatencyHistogram& operator=(const LatencyHistogram& other);
+
+  /**
+   * Records one value.  Must only be called by one thread at a time.
+   *
+   * @param value   Latency in nanoseconds.
+   */
+  void record(const std::uint64_t value) {
+    bump(counts_[bucketIndex(value)], 1);
+    bump(count_, 1);
+    bump(sum_, value);
+    if (value < min_.load(std::memory_order_relaxed)) {
+      min_.store(value, std::memory_order_relaxed);
+    }
+    if (value > max_.load(std::memory_order_relaxed)) {
+      max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Adds the values recorded in another histogram to this one.
+   *
+   * @param other   Histogram to merge in.
+   */
+  void add(const LatencyHistogram& other);
+
+  /**
+   * Removes all recorded values.
+   */
+  void clear();
+
+  /**
+   * Returns the number of values recorded.
+   */
+  std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+  /**
+   * Returns the sum of the values recorded.
+   */
+  std::uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+  /**
+   * Returns the smallest value recorded, or 0 if the histogram is empty.
+   */
+  std::uint64_t min() const;
+
+  /**
+   * Returns the largest value recorded, or 0 if the histogram is empty.
+   */
+  std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  /**
+   * Returns the mean of the values recorded, or 0 if the histogram is empty.
+   */
+  double mean() const;
+
+  /**
+   * Returns a value at or above the given fraction of the recorded values:
+   * the upper bound of the bucket holding that rank, capped at max().
+   *
+   * @param fraction  Fraction in [0, 1], e.g. 0.99 for the 99th percentile.
+   * @return  Percentile in nanoseconds, or 0 if the histogram is empty.
+   */
+  std::uint64_t percentile(const double fraction) const;
+
+  /**
+   * Returns the number of values recorded in a bucket.
+   *
+   * @param bucket  Bucket index, less than NUM_BUCKETS.
+   */
+  std::uint64_t bucketCount(const std::size_t bucket) const {
+    return counts_[bucket].load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the index of the bucket a value is recorded in.
+   */
+  static std::size_t bucketIndex(const std::uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+      return static_cast<std::size_t>(value);
+    }
+    const int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKETS +
+        static_cast<std::size_t>((value >> shift) & (SUB_BUCKETS - 1));
+  }
+
+  /**
+   * Returns the smallest value recorded in a bucket.
+   */
+  static std::uint64_t bucketLowerBound(const std::size_t bucket);
+
+  /**
+   * Returns the largest value recorded in a bucket.
+   */
+  static std::uint64_t bucketUpperBound(const std::size_t bucket);
+
+ private:
+  /**
+   * Adds to a counter that only the calling thread writes.  A relaxed load and
+   * store is enough and avoids a locked instruction.
+   */
+  static void bump(std::atomic<std::uint64_t>& counter,
+                   const std::uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount,
+                  std::memory_order_relaxed);
+  }
+
+  /**
+   * Number of values recorded in each bucket.
+   */
+  std::atomic<std::uint64_t> counts_[NUM_BUCKETS];
+
+  /**
+   * Number of values recorded.
+   */
+  std::atomic<std::uint64_t> count_;
+
+  /**
+   * Sum of the values recorded.
+   */
+  std::atomic<std::uint64_t> sum_;
+
+  /**
+   * Smallest value recorded; UINT64_MAX while empty.
+   */
+  std::atomic<std::uint64_t> min_;
+
+  /**
+   * Largest value recorded.
+   */
+  std::atomic<std::uint64_t> max_;
+};
+
+}
@@ -68,6 +68,179 @@
  * If you want to edit what <code>badgerdb_main</code> does, edit
  * <code>src/main.cpp</code>.
  *
+ * Benchmarks live in <code>bench/</code>; each source file there is a
+ * standalone program.  To build them all:
+ * @code
+ *   $ make bench
+ * @endcode
+ *
+ * <code>bench/bufmgr_bench</code> drives the buffer manager with uniform,
+ * Zipfian, scan or mixed page references and reports throughput, hit ratio,
+ * latency percentiles and disk I/O; run it with no arguments for the Zipfian
+ * preset or see the top of its source for the options.
+ *
+ * BufMgr is threadsafe: threads can share a pool without locking around it.
+ * A miss that finds no empty frame sweeps the clock hand for a batch of
+ * victims (BufMgr::EVICT_BATCH at most) and queues them for the next misses,
+ * and the sweep runs outside the pool's latch, so several threads can look
+ * for victims at once.  BufStats::sweepLength records how far each sweep
+ * went; <code>bufmgr_bench --pinned=X</code> shows it with most frames pinned.
+ *
+ * Instead of pairing readPage with unPinPage, callers can hold the
+ * PageHandle that readPage and allocPage return without a page argument.  It
+ * unpins the page when it goes out of scope, dirty if markDirty() was called,
+ * and goes straight to the page's frame instead of looking the page up again:
+ * @code
+ *   badgerdb::PageHandle handle = bufMgr->readPage(&file, page_number);
+ *   handle->insertRecord("hello!");
+ *   handle.markDirty();
+ * @endcode
+ * <code>bench/pin_bench</code> compares the two on pages already in the pool.
+ *
+ * Files can be given separate buffer pools with a BufPoolRegistry, so that a
+ * large scanned file cannot evict a small, hot one.  Each pool has its own
+ * size, replacement policy (BufPoolPolicy) and statistics:
+ * @code
+ *   badgerdb::BufPoolRegistry registry(4096);
+ *   registry.createPool("keep", 256, badgerdb::BUF_POOL_KEEP);
+ *   registry.bindFile(&lookup_file, "keep");
+ *   registry.readPage(&lookup_file, page_number, page);
+ * @endcode
+ *
+ * A pool can be resized while in use with BufMgr::resize(); cached pages are
+ * kept, and pages pinned by callers never move.  <code>bench/resize_bench</code>
+ * measures the pause.
+ *
+ * Changes can be made durable through a write-ahead log instead of by
+ * writing pages back.  With a WriteAheadLog attached by BufMgr::setLog(),
+ * unpinning a page dirty appends an image of the page to the log and stamps
+ * the page with the record's LSN (Page::lsn()), and the pool writes a dirty
+ * page to its file only once the log is durable up to that LSN.  A commit is
+ * then one sequential log append and sync:
+ * @code
+ *   badgerdb::WriteAheadLog log("db.wal");
+ *   bufMgr->setLog(&log);
+ *   ...
+ *   log.flush();
+ * @endcode
+ * Threads committing at the same time share syncs: while one thread syncs
+ * the log, the others wait and are covered by the next sync.
+ * WriteAheadLog::setGroupCommitDelay() makes each sync wait briefly for more
+ * commits to join; <code>bench/group_commit_bench</code> shows commits and
+ * syncs per second for 1 to 64 committing threads.
+ *
+ * BufMgr::getDirtyPages() returns the dirty page table: each dirty page with
+ * the log offset from which its unwritten changes are redone.
+ * BufMgr::checkpoint() runs a fuzzy checkpoint.  It writes dirty pages back
+ * one at a time at a limited rate while the pool stays in use, then logs the
+ * offset recovery has to replay from.  BufMgr::startCheckpointer() runs
+ * checkpoints in a background thread, and
+ * <code>bufmgr_bench --checkpoint=N</code> measures one writing N pages per
+ * second.
+ *
+ * After a crash, Recovery::run() replays the log onto its files before they
+ * are opened again, starting from the last checkpoint and spreading the pages
+ * over several threads.  Attach the log to each File with File::setLog() as
+ * well, so page allocations and deletions are logged and finished by
+ * recovery:
+ * @code
+ *   #include "recovery.h"
+ *
+ *   ...
+ *
+ *   badgerdb::Recovery::run("db.wal");
+ *   badgerdb::File db_file = badgerdb::File::open("db.db");
+ *   badgerdb::WriteAheadLog log("db.wal");
+ *   db_file.setLog(&log);
+ *   bufMgr->setLog(&log);
+ * @endcode
+ * <code>bench/recovery_bench</code> shows that recovery time follows the
+ * amount of log written since the checkpoint, not the size of the file.
+ *
+ * A power loss can tear a page write, leaving a page that fails its checksum.
+ * With a DoubleWriteBuffer attached by BufMgr::setDoubleWrite(), dirty pages
+ * are written in batches, each synced to a double-write file before its pages
+ * are written in place.  After a crash, DoubleWriteBuffer::repair() rewrites
+ * torn pages from that copy; run it before opening the files and before
+ * Recovery::run():
+ * @code
+ *   badgerdb::DoubleWriteBuffer::repair("db.dwb");
+ *   badgerdb::Recovery::run("db.wal");
+ *   ...
+ *   badgerdb::DoubleWriteBuffer dwb("db.dwb");
+ *   bufMgr->setDoubleWrite(&dwb);
+ * @endcode
+ * <code>bench/double_write_bench</code> compares write-back throughput with
+ * and without it for several batch sizes.
+ *
+ * Long scans need not block updates, or see them half done.  A scan reads
+ * through a snapshot from BufMgr::beginSnapshot(), and updates go through
+ * BufMgr::updatePage(), which changes a private copy of the page and
+ * installs it when the handle is released.  Readers of an older snapshot
+ * keep the image they read until they unpin it, and superseded images are
+ * freed once no snapshot from before the update is left:
+ * @code
+ *   badgerdb::Snapshot snapshot = bufMgr->beginSnapshot();
+ *   badgerdb::PageHandle old_image = bufMgr->readPage(&file, page_no, snapshot);
+ *   ...
+ *   badgerdb::PageHandle update = bufMgr->updatePage(&file, page_no);
+ *   update->updateRecord(rid, "new value");
+ *   update.markDirty();
+ * @endcode
+ * <code>bench/mvcc_bench</code> compares scan and update throughput against
+ * scans that lock updates out.
+ *
+ * Lookups on hot pages can skip the latch and the pin altogether with
+ * BufMgr::readOptimistic().  It checks a version counter of the frame before
+ * and after calling the reader, and calls it again if the frame changed, so
+ * the reader must only read the page and keep its result in variables it
+ * overwrites.  A page pinned through readPage() or allocPage() may be changed
+ * in place, so while it is, its frame is read under the latch instead.  A
+ * frame hint per page saves finding the page on later reads:
+ * @code
+ *   badgerdb::FrameId hint = 0;
+ *   std::string value;
+ *   bufMgr->readOptimistic(&file, page_no, hint,
+ *       [&](const badgerdb::Page& page) { value = page.getRecord(rid); });
+ * @endcode
+ * <code>bench/optimistic_bench</code> compares pinned and optimistic lookups
+ * from 1 to 64 threads.
+ *
+ * Optimistic readers run inside an epoch of the pool's EpochManager, so the
+ * pages, hash table entries and frame tables they may still be reading are
+ * retired rather than freed when a frame is evicted, updated or resized, and
+ * are reused only once every reader has left the epoch it was in.  Other code
+ * that reads shared structures without a lock can use an EpochManager and
+ * EpochGuard the same way.
+ *
+ * On a machine with several NUMA nodes, BufMgr::setNumaTopology() splits the
+ * frames into one partition per node, with each node's pages allocated on
+ * it, so that misses load pages into memory local to the thread that missed:
+ * @code
+ *   badgerdb::NumaTopology topology;
+ *   bufMgr->setNumaTopology(&topology);
+ * @endcode
+ * BufStats::localAccesses and BufStats::remoteAccesses count the accesses
+ * that stayed on and crossed nodes.  <code>bench/numa_bench</code> compares a
+ * partitioned pool with an unpartitioned one, on simulated nodes
+ * (NumaTopology::simulated()) if the machine has only one.
+ *
+ * To size a pool without rerunning a workload, record a page access trace
+ * with BufMgr::startTrace() (or <code>bufmgr_bench --trace=FILE</code>) and
+ * replay it with <code>bench/trace_replay</code>, which prints the miss ratio
+ * of LRU, clock, FIFO and optimal replacement at a range of pool sizes.
+ *
+ * BufMgr::getBufStats() returns hit, miss, eviction and clock sweep counters
+ * and latency histograms of readPage, allocPage, unPinPage and flushFile.
+ * They are always on: each thread records into its own shard and the shards
+ * are summed when read.  BufStats::files and BufMgr::getFileBufStats() break
+ * residency, hits, misses and writes down by file, to show which file is
+ * crowding the pool.  BufStats::heat counts resident frames by how often
+ * they were hit, and BufMgr::estimateWorkingSet() estimates, in fixed memory,
+ * how many distinct pages recent requests touched, which is the pool size the
+ * workload needs.  BufStats::dump() writes them as JSON
+ * (<code>bufmgr_bench --stats=FILE</code>).
+ *
  * @subsection documentation_sec Rebuilding the documentation
  *
  * Documentation is generated by using Doxygen.  If you have updated the
@@ -88,6 +261,16 @@
  *
  * Record data is represented using std::strings of arbitrary characters.
  *
+ * Page, File and BufMgr use the default 8 KB page size.  Each is a typedef of
+ * a template taking the page size (BasicPage, BasicFile, BasicBufMgr), so a
+ * file of 4 KB index pages and a file of 64 KB scan pages can be used side by
+ * side.  The sizes available are listed in BADGERDB_FOR_EACH_PAGE_SIZE:
+ * @code
+ *  badgerdb::BasicFile<4096> index_file =
+ *      badgerdb::BasicFile<4096>::create("index.db");
+ *  badgerdb::BasicBufMgr<4096> index_pool(256);
+ * @endcode
+ *
  * @subsubsection file_management_sec Creating, opening, and deleting files
  *
  * Files must first be created before they can be used:
@@ -157,6 +340,40 @@
  *   }
  * @endcode
  *
+ * Every page written is stamped with a CRC32C checksum of its contents, and
+ * File::readPage throws ChecksumMismatchException if a page was corrupted on
+ * disk.  Verification can be deferred until the page's records are first
+ * accessed, or turned off, per File object:
+ * @code
+ *   db_file.setChecksumMode(badgerdb::CHECKSUM_VERIFY_LAZILY);
+ * @endcode
+ *
+ * Files of compressible data can be created in the compressed format.  Page
+ * data is compressed on write into variable-length slots and decompressed on
+ * read, so callers and the buffer manager still see full-size pages.  An
+ * in-memory cache of compressed pages can be enabled to serve buffer pool
+ * misses without going to disk:
+ * @code
+ *   badgerdb::File text_file = badgerdb::File::create(
+ *       "text.db", badgerdb::FILE_FORMAT_COMPRESSED);
+ *   text_file.setCompressedCacheSize(64 * 1024 * 1024);
+ * @endcode
+ *
+ * Files that are read far more than they are written can be created in the
+ * shadow format instead.  Changed pages are written copy-on-write to new
+ * locations and commit() publishes all of them, with the file header, by
+ * swapping in a new root record, so a crash leaves the file as of its last
+ * commit without needing a log.  A snapshot reads the last committed state
+ * for as long as it is held, unaffected by later commits:
+ * @code
+ *   badgerdb::File catalog = badgerdb::File::create(
+ *       "catalog.db", badgerdb::FILE_FORMAT_SHADOW);
+ *   ...
+ *   buffer_manager.flushFile(&catalog);
+ *   catalog.commit();
+ *   badgerdb::File as_of_now = catalog.snapshot();
+ * @endcode
+ *
  * @subsubsection page_sec Reading and writing data in a page
  *
  * Pages hold variable-length records containing arbitrary data.
@@ -205,6 +422,41 @@
  * better to use something like Google's protocol buffers or Boost
  * serialization.
  *
+ * Tables with small rows of a known width can use FixedRecordPage instead of
+ * the slot array.  It formats a Page as a presence bitmap plus a dense record
+ * array, so RecordIds work as usual but no space is spent on slots:
+ * @code
+ *   #include "fixed_record_page.h"
+ *
+ *   ...
+ *
+ *   badgerdb::Page new_page;
+ *   badgerdb::FixedRecordPage<16> fixed =
+ *       badgerdb::FixedRecordPage<16>::format(&new_page);
+ *   const badgerdb::RecordId& rid = fixed.insertRecord("sixteen bytes!!!");
+ * @endcode
+ *
+ * For analytical scans over wide rows, PaxPage stores each column of a page's
+ * rows together in a minipage, described by a PaxSchema.  scanColumns() walks
+ * a file of PAX pages and hands back only the requested columns:
+ * @code
+ *   #include "pax_page.h"
+ *
+ *   ...
+ *
+ *   badgerdb::PaxSchema schema;
+ *   schema.addColumn<std::int32_t>();   // column 0
+ *   schema.addColumn<double>();         // column 1
+ *   badgerdb::Page new_page = db_file.allocatePage();
+ *   badgerdb::PaxPage<> pax = badgerdb::PaxPage<>::format(&new_page, schema);
+ *   ...
+ *   double total = 0;
+ *   badgerdb::scanColumns(db_file, schema, std::vector<std::size_t>(1, 1),
+ *       [&total](const badgerdb::RecordId&, const char* const* values) {
+ *         total += *reinterpret_cast<const double*>(values[0]);
+ *       });
+ * @endcode
+ *
  * You can also iterate through all records in the Page:
  * @code
  *   #include "page_iterator.h"
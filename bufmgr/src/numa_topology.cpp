@@ -0,0 +1,134 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "numa_topology.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sched.h>
+
+namespace badgerdb {
+
+namespace {
+
+// Parses a kernel CPU or node list such as "0-3,8-11".
+std::vector<int> parseList(const std::string& list) {
+  std::vector<int> values;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    int first, last;
+    const int n = sscanf(range.c_str(), "%d-%d", &first, &last);
+    if (n < 1) {
+      continue;
+    }
+    if (n == 1) {
+      last = first;
+    }
+    for (int value = first; value <= last; ++value) {
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+std::string readLine(const std::string& path) {
+  std::ifstream in(path.c_str());
+  std::string line;
+  std::getline(in, line);
+  return line;
+}
+
+void setAffinity(const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (std::size_t i = 0; i < cpus.size(); ++i) {
+    if (cpus[i] < CPU_SETSIZE) {
+      CPU_SET(cpus[i], &set);
+    }
+  }
+  // Failing to pin only costs locality, so errors are ignored.
+  sched_setaffinity(0, sizeof(set), &set);
+}
+
+}
+
+thread_local int NumaTopology::bound_node_ = -1;
+
+NumaTopology::NumaTopology()
+    : num_nodes_(1),
+      simulated_(false) {
+  const std::vector<int> nodes =
+      parseList(readLine("/sys/devices/system/node/online"));
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    std::ostringstream path;
+    path << "/sys/devices/system/node/node" << nodes[i] << "/cpulist";
+    const std::vector<int> cpus = parseList(readLine(path.str()));
+    // Nodes without CPUs hold only memory; no thread can be local to them.
+    if (cpus.empty()) {
+      continue;
+    }
+    for (std::size_t j = 0; j < cpus.size(); ++j) {
+      if (cpus[j] >= static_cast<int>(cpu_nodes_.size())) {
+        cpu_nodes_.resize(cpus[j] + 1, -1);
+      }
+      cpu_nodes_[cpus[j]] = node_cpus_.size();
+    }
+    node_cpus_.push_back(cpus);
+  }
+  if (!node_cpus_.empty()) {
+    num_nodes_ = node_cpus_.size();
+  }
+}
+
+NumaTopology::NumaTopology(const std::uint32_t nodes, const bool simulated)
+    : num_nodes_(nodes > 0 ? nodes : 1),
+      simulated_(simulated) {
+}
+
+NumaTopology NumaTopology::simulated(const std::uint32_t nodes) {
+  return NumaTopology(nodes, true);
+}
+
+int NumaTopology::currentNode() const {
+  if (bound_node_ >= 0 && bound_node_ < static_cast<int>(num_nodes_)) {
+    return bound_node_;
+  }
+  if (simulated_) {
+    return -1;
+  }
+  if (num_nodes_ == 1) {
+    return 0;
+  }
+  const int cpu = sched_getcpu();
+  if (cpu < 0 || cpu >= static_cast<int>(cpu_nodes_.size())) {
+    return -1;
+  }
+  return cpu_nodes_[cpu];
+}
+
+void NumaTopology::bindThread(const std::uint32_t node) const {
+  bound_node_ = node;
+  if (!simulated_ && node < node_cpus_.size()) {
+    setAffinity(node_cpus_[node]);
+  }
+}
+
+void NumaTopology::unbindThread() const {
+  bound_node_ = -1;
+  if (!simulated_ && !node_cpus_.empty()) {
+    std::vector<int> cpus;
+    for (std::size_t i = 0; i < node_cpus_.size(); ++i) {
+      cpus.insert(cpus.end(), node_cpus_[i].begin(), node_cpus_[i].end());
+    }
+    setAffinity(cpus);
+  }
+}
+
+}
@@ -0,0 +1,106 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace badgerdb {
+
+/**
+ * @brief The NUMA nodes of the machine and the node each thread runs on.
+ *
+ * The nodes and their CPUs are read from /sys/devices/system/node, so no
+ * NUMA library is needed; a machine without that directory has one node.
+ * A thread's node is the node of the CPU it is running on, unless the thread
+ * was bound to a node with bindThread().  Binding a thread also restricts it
+ * to the CPUs of the node, so memory it touches first is placed there by the
+ * kernel's default first-touch policy.
+ *
+ * A simulated topology has as many nodes as asked for on any machine.  Only
+ * bound threads have a node, and binding a thread does not move it, so it
+ * shows where pages would be placed and which accesses would cross nodes on
+ * a machine that has the nodes, without placing any memory.
+ *
+ * All members are threadsafe; the topology never changes once constructed.
+ */
+class NumaTopology {
+ public:
+  /**
+   * Detects the nodes of this machine.
+   */
+  NumaTopology();
+
+  /**
+   * Returns a topology of the given number of nodes for a machine that may
+   * have fewer.
+   *
+   * @param nodes   Number of nodes, at least 1.
+   */
+  static NumaTopology simulated(const std::uint32_t nodes);
+
+  /**
+   * Returns the number of nodes.
+   */
+  std::uint32_t numNodes() const { return num_nodes_; }
+
+  /**
+   * Returns true if the topology is simulated.
+   */
+  bool isSimulated() const { return simulated_; }
+
+  /**
+   * Returns the node the calling thread runs on: the node it was bound to,
+   * else the node of its CPU, or -1 if that is not known (in a simulated
+   * topology, the thread was not bound).
+   */
+  int currentNode() const;
+
+  /**
+   * Binds the calling thread to a node.  Unless the topology is simulated,
+   * the thread is also restricted to the CPUs of the node.
+   *
+   * @param node    Node to run on, below numNodes().
+   */
+  void bindThread(const std::uint32_t node) const;
+
+  /**
+   * Removes the binding of the calling thread, letting it run on any CPU.
+   */
+  void unbindThread() const;
+
+ private:
+  NumaTopology(const std::uint32_t nodes, const bool simulated);
+
+  /**
+   * Number of nodes.
+   */
+  std::uint32_t num_nodes_;
+
+  /**
+   * True if the nodes are not those of the machine.
+   */
+  bool simulated_;
+
+  /**
+   * Node of each CPU, or -1 for a CPU of no known node.
+   */
+  std::vector<int> cpu_nodes_;
+
+  /**
+   * CPUs of each node.
+   */
+  std::vector<std::vector<int> > node_cpus_;
+
+  /**
+   * Node the calling thread was bound to, or -1.
+   */
+  static thread_local int bound_node_;
+};
+
+}
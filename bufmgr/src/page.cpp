@@ -7,6 +7,8 @@
 
 #include <cassert>
 
+#include "checksum.h"
+#include "exceptions/checksum_mismatch_exception.h"
 #include "exceptions/insufficient_space_exception.h"
 #include "exceptions/invalid_record_exception.h"
 #include "exceptions/invalid_slot_exception.h"
@@ -16,21 +18,66 @@
 
 namespace badgerdb {
 
-Page::Page() {
+template <std::size_t PageSize>
+BasicPage<PageSize>::BasicPage() {
   initialize();
 }
 
-void Page::initialize() {
+template <std::size_t PageSize>
+BasicPage<PageSize>::BasicPage(const BasicPage& other)
+    : header_(other.header_),
+      data_(other.data_),
+      checksum_pending_(other.checksum_pending_.load(std::memory_order_relaxed)),
+      checksum_file_(other.checksum_file_) {
+}
+
+template <std::size_t PageSize>
+BasicPage<PageSize>::BasicPage(BasicPage&& other)
+    : header_(other.header_),
+      data_(std::move(other.data_)),
+      checksum_pending_(other.checksum_pending_.load(std::memory_order_relaxed)),
+      checksum_file_(other.checksum_file_) {
+}
+
+template <std::size_t PageSize>
+BasicPage<PageSize>& BasicPage<PageSize>::operator=(const BasicPage& other) {
+  header_ = other.header_;
+  data_ = other.data_;
+  checksum_pending_.store(other.checksum_pending_.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+  checksum_file_ = other.checksum_file_;
+  return *this;
+}
+
+template <std::size_t PageSize>
+BasicPage<PageSize>& BasicPage<PageSize>::operator=(BasicPage&& other) {
+  header_ = other.header_;
+  data_ = std::move(other.data_);
+  checksum_pending_.store(other.checksum_pending_.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+  checksum_file_ = other.checksum_file_;
+  return *this;
+}
+
+template <std::size_t PageSize>
+void BasicPage<PageSize>::initialize() {
   header_.free_space_lower_bound = 0;
   header_.free_space_upper_bound = DATA_SIZE;
   header_.num_slots = 0;
   header_.num_free_slots = 0;
   header_.current_page_number = INVALID_NUMBER;
   header_.next_page_number = INVALID_NUMBER;
+  header_.checksum = 0;
+  header_.reserved = 0;
+  header_.page_lsn = 0;
   data_.assign(DATA_SIZE, char());
+  checksum_pending_.store(false, std::memory_order_relaxed);
+  checksum_file_ = NULL;
 }
 
-RecordId Page::insertRecord(const std::string& record_data) {
+template <std::size_t PageSize>
+RecordId BasicPage<PageSize>::insertRecord(const std::string& record_data) {
+  verifyIfPending();
   if (!hasSpaceForRecord(record_data)) {
     throw InsufficientSpaceException(
         page_number(), record_data.length(), getFreeSpace());
@@ -40,14 +87,18 @@ RecordId Page::insertRecord(const std::string& record_data) {
   return {page_number(), slot_number};
 }
 
-std::string Page::getRecord(const RecordId& record_id) const {
+template <std::size_t PageSize>
+std::string BasicPage<PageSize>::getRecord(const RecordId& record_id) const {
+  verifyIfPending();
   validateRecordId(record_id);
   const PageSlot& slot = getSlot(record_id.slot_number);
   return data_.substr(slot.item_offset, slot.item_length);
 }
 
-void Page::updateRecord(const RecordId& record_id,
-                        const std::string& record_data) {
+template <std::size_t PageSize>
+void BasicPage<PageSize>::updateRecord(const RecordId& record_id,
+                                       const std::string& record_data) {
+  verifyIfPending();
   validateRecordId(record_id);
   const PageSlot* slot = getSlot(record_id.slot_number);
   const std::size_t free_space_after_delete =
@@ -63,12 +114,15 @@ void Page::updateRecord(const RecordId& record_id,
   insertRecordInSlot(record_id.slot_number, record_data);
 }
 
-void Page::deleteRecord(const RecordId& record_id) {
+template <std::size_t PageSize>
+void BasicPage<PageSize>::deleteRecord(const RecordId& record_id) {
+  verifyIfPending();
   deleteRecord(record_id, true /* allow_slot_compaction */);
 }
 
-void Page::deleteRecord(const RecordId& record_id,
-                        const bool allow_slot_compaction) {
+template <std::size_t PageSize>
+void BasicPage<PageSize>::deleteRecord(const RecordId& record_id,
+                                       const bool allow_slot_compaction) {
   validateRecordId(record_id);
   PageSlot* slot = getSlot(record_id.slot_number);
   data_.replace(slot->item_offset, slot->item_length, slot->item_length, '\0');
@@ -122,7 +176,10 @@ void Page::deleteRecord(const RecordId& record_id,
   }
 }
 
-bool Page::hasSpaceForRecord(const std::string& record_data) const {
+template <std::size_t PageSize>
+bool BasicPage<PageSize>::hasSpaceForRecord(
+    const std::string& record_data) const {
+  verifyIfPending();
   std::size_t record_size = record_data.length();
   if (header_.num_free_slots == 0) {
     record_size += sizeof(PageSlot);
@@ -130,17 +187,20 @@ bool Page::hasSpaceForRecord(const std::string& record_data) const {
   return record_size <= getFreeSpace();
 }
 
-PageSlot* Page::getSlot(const SlotId slot_number) {
+template <std::size_t PageSize>
+PageSlot* BasicPage<PageSize>::getSlot(const SlotId slot_number) {
   return reinterpret_cast<PageSlot*>(
       &data_[(slot_number - 1) * sizeof(PageSlot)]);
 }
 
-const PageSlot& Page::getSlot(const SlotId slot_number) const {
+template <std::size_t PageSize>
+const PageSlot& BasicPage<PageSize>::getSlot(const SlotId slot_number) const {
   return *reinterpret_cast<const PageSlot*>(
       &data_[(slot_number - 1) * sizeof(PageSlot)]);
 }
 
-SlotId Page::getAvailableSlot() {
+template <std::size_t PageSize>
+SlotId BasicPage<PageSize>::getAvailableSlot() {
   SlotId slot_number = INVALID_SLOT;
   if (header_.num_free_slots > 0) {
     // Have an allocated but unused slot that we can reuse.
@@ -164,8 +224,9 @@ SlotId Page::getAvailableSlot() {
   return static_cast<SlotId>(slot_number);
 }
 
-void Page::insertRecordInSlot(const SlotId slot_number,
-                              const std::string& record_data) {
+template <std::size_t PageSize>
+void BasicPage<PageSize>::insertRecordInSlot(const SlotId slot_number,
+                                             const std::string& record_data) {
   if (slot_number > header_.num_slots ||
       slot_number == INVALID_SLOT) {
     throw InvalidSlotException(page_number(), slot_number);
@@ -183,7 +244,8 @@ void Page::insertRecordInSlot(const SlotId slot_number,
   data_.replace(slot->item_offset, slot->item_length, record_data);
 }
 
-void Page::validateRecordId(const RecordId& record_id) const {
+template <std::size_t PageSize>
+void BasicPage<PageSize>::validateRecordId(const RecordId& record_id) const {
   if (record_id.page_number != page_number()) {
     throw InvalidRecordException(record_id, page_number());
   }
@@ -193,13 +255,39 @@ void Page::validateRecordId(const RecordId& record_id) const {
   }
 }
 
-PageIterator Page::begin() {
-  return PageIterator(this);
+template <std::size_t PageSize>
+BasicPageIterator<PageSize> BasicPage<PageSize>::begin() {
+  verifyIfPending();
+  return BasicPageIterator<PageSize>(this);
+}
+
+template <std::size_t PageSize>
+BasicPageIterator<PageSize> BasicPage<PageSize>::end() {
+  const RecordId& end_record_id = {page_number(), INVALID_SLOT};
+  return BasicPageIterator<PageSize>(this, end_record_id);
 }
 
-PageIterator Page::end() {
-  const RecordId& end_record_id = {page_number(), Page::INVALID_SLOT};
-  return PageIterator(this, end_record_id);
+template <std::size_t PageSize>
+void BasicPage<PageSize>::verifyChecksum() const {
+  const std::uint32_t actual = computeChecksum(header_, data_);
+  if (actual != header_.checksum) {
+    throw ChecksumMismatchException(checksum_file_ ? *checksum_file_ : "",
+                                    page_number(), header_.checksum, actual);
+  }
+  checksum_pending_.store(false, std::memory_order_relaxed);
 }
 
+template <std::size_t PageSize>
+std::uint32_t BasicPage<PageSize>::computeChecksum(const PageHeader& header,
+                                                   const std::string& data) {
+  PageHeader unstamped = header;
+  unstamped.checksum = 0;
+  return crc32c(data.data(), DATA_SIZE,
+                crc32c(&unstamped, sizeof(unstamped)));
+}
+
+#define BADGERDB_INSTANTIATE_PAGE(size) template class BasicPage<size>;
+BADGERDB_FOR_EACH_PAGE_SIZE(BADGERDB_INSTANTIATE_PAGE)
+#undef BADGERDB_INSTANTIATE_PAGE
+
 }
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <stdint.h>
 #include <memory>
@@ -57,6 +58,24 @@ struct PageHeader {
    */
   PageId next_page_number;
 
+  /**
+   * CRC32C of the page header (with this field set to zero) followed by the
+   * page data.  Stamped by File when the page is written.
+   */
+  std::uint32_t checksum;
+
+  /**
+   * Reserved; zero.  Keeps page_lsn aligned.
+   */
+  std::uint32_t reserved;
+
+  /**
+   * LSN of the write-ahead log record holding the latest change to the page,
+   * or 0 if the page was never logged.  Stamped by BufMgr when a page is
+   * unpinned dirty with a log attached.
+   */
+  Lsn page_lsn;
+
   /**
    * Returns true if this page header is equal to the other.
    *
@@ -92,7 +111,26 @@ struct PageSlot {
   std::uint16_t item_length;
 };
 
-class PageIterator;
+/**
+ * Page size in bytes used by the Page, File and BufMgr typedefs.  Files
+ * created with one page size are unreadable with another.
+ */
+static const std::size_t DEFAULT_PAGE_SIZE = 8192;
+
+/**
+ * Invokes X(size) for every page size the page, file and buffer manager
+ * templates are instantiated for.  Code using a size not in this list will
+ * fail to link.
+ */
+#define BADGERDB_FOR_EACH_PAGE_SIZE(X) \
+  X(4096) X(8192) X(16384) X(32768) X(65536)
+
+static_assert(sizeof(PageHeader) == 32,
+              "Page header layout must not contain padding.");
+static_assert(sizeof(PageSlot) == 6,
+              "Slot layout must match the on-disk slot array.");
+
+template <std::size_t PageSize> class BasicPageIterator;
 
 /**
  * @brief Class which represents a fixed-size database page containing records.
@@ -102,15 +140,20 @@ class PageIterator;
  * slots and identified by a RecordId.  Although a record's actual contents may
  * be moved on the page, accessing a record by its slot is consistent.
  *
+ * The page size is a template parameter so that files with small pages (for
+ * point lookups) and large pages (for scans) can coexist without paying for a
+ * runtime size.  Use the Page typedef for the default size.
+ *
  * @warning This class is not threadsafe.
  */
-class Page {
+template <std::size_t PageSize>
+class BasicPage {
  public:
   /**
-   * Page size in bytes.  If this is changed, database files created with a
-   * different page size value will be unreadable by the resulting binaries.
+   * Page size in bytes.  Database files created with a different page size
+   * value cannot be read with this page type.
    */
-  static const std::size_t SIZE = 8192;
+  static const std::size_t SIZE = PageSize;
 
   /**
    * Size of page free space area in bytes.
@@ -130,7 +173,28 @@ class Page {
   /**
    * Constructs a new, uninitialized page.
    */
-  Page();
+  BasicPage();
+
+  /**
+   * Constructs a copy of a page, including whether its checksum is still to
+   * be verified.
+   */
+  BasicPage(const BasicPage& other);
+
+  /**
+   * Constructs a page from another, taking over its data.
+   */
+  BasicPage(BasicPage&& other);
+
+  /**
+   * Replaces this page with a copy of another.
+   */
+  BasicPage& operator=(const BasicPage& other);
+
+  /**
+   * Replaces this page with another, taking over its data.
+   */
+  BasicPage& operator=(BasicPage&& other);
 
   /**
    * Inserts a new record into the page.
@@ -199,12 +263,18 @@ class Page {
    */
   PageId next_page_number() const { return header_.next_page_number; }
 
+  /**
+   * Returns the LSN of the log record holding the latest change to this page,
+   * or 0 if the page has never been logged.
+   */
+  Lsn lsn() const { return header_.page_lsn; }
+
   /**
    * Returns an iterator at the first record in the page.
    *
    * @return  Iterator at first record of page.
    */
-  PageIterator begin();
+  BasicPageIterator<PageSize> begin();
 
   /**
    * Returns an iterator representing the record after the last record in the
@@ -212,7 +282,7 @@ class Page {
    *
    * @return  Iterator representing record after the last record in the page.
    */
-  PageIterator end();
+  BasicPageIterator<PageSize> end();
 
  private:
   /**
@@ -238,6 +308,15 @@ class Page {
     header_.next_page_number = new_next_page_number;
   }
 
+  /**
+   * Sets the LSN of the log record holding the latest change to this page.
+   *
+   * @param lsn   LSN of the record.
+   */
+  void set_lsn(const Lsn lsn) {
+    header_.page_lsn = lsn;
+  }
+
   /**
    * Deletes the record with the given ID.  Page is compacted upon delete to
    * ensure that data of all records is contiguous.  Slot array is compacted if
@@ -313,6 +392,38 @@ class Page {
    */
   void validateRecordId(const RecordId& record_id) const;
 
+  /**
+   * Checks the page data against the checksum in the header if the page was
+   * read from disk with lazy verification and has not been checked yet.
+   *
+   * @throws  ChecksumMismatchException If the page data does not match its
+   *                                    checksum.
+   */
+  void verifyIfPending() const {
+    if (checksum_pending_.load(std::memory_order_relaxed)) {
+      verifyChecksum();
+    }
+  }
+
+  /**
+   * Checks the page data against the checksum in the header.
+   *
+   * @throws  ChecksumMismatchException If the page data does not match its
+   *                                    checksum.
+   */
+  void verifyChecksum() const;
+
+  /**
+   * Computes the checksum of a page with the given header and data.  The
+   * header's checksum field is treated as zero.
+   *
+   * @param header  Header of the page.
+   * @param data    Data area of the page; DATA_SIZE bytes.
+   * @return  Checksum to store in the header.
+   */
+  static std::uint32_t computeChecksum(const PageHeader& header,
+                                       const std::string& data);
+
   /**
    * Returns whether the page is in use or is a free page.
    *
@@ -332,15 +443,57 @@ class Page {
 
   std::string data_;
 
-  friend class File;
-  friend class PageIterator;
+  /**
+   * True if the page was read with lazy checksum verification and has not
+   * been verified yet.  Atomic because every reader of a shared page, pinned
+   * or optimistic, may be the first to verify it; each only loads it after
+   * that.
+   */
+  mutable std::atomic<bool> checksum_pending_;
+
+  /**
+   * Name of the file the page was read from while its checksum is pending, so
+   * a failed verification names it; NULL otherwise.  Points into a set of
+   * names kept for the life of the process, so it outlives the file.
+   */
+  const std::string* checksum_file_;
+
+  template <std::size_t> friend class BasicFile;
+  template <std::size_t> friend class BasicBufMgr;
+  template <std::size_t> friend class BasicRecovery;
+  template <std::size_t> friend class BasicDoubleWriteBuffer;
+  template <std::size_t> friend class BasicPageIterator;
+  template <std::size_t, std::size_t> friend class FixedRecordPage;
+  template <std::size_t> friend class PaxPage;
   friend class PageTest;
   friend class BufferTest;
+
+  static_assert(SIZE > sizeof(PageHeader),
+                "Page size must be large enough to hold header and data.");
+  static_assert(DATA_SIZE > 0,
+                "Page must have some space to hold data.");
+  static_assert((SIZE & (SIZE - 1)) == 0,
+                "Page size must be a power of two.");
+  static_assert(DATA_SIZE <= UINT16_MAX,
+                "Slot offsets and lengths must be able to address the whole "
+                "data area.");
 };
 
-static_assert(Page::SIZE > sizeof(PageHeader),
-              "Page size must be large enough to hold header and data.");
-static_assert(Page::DATA_SIZE > 0,
-              "Page must have some space to hold data.");
+template <std::size_t PageSize>
+const std::size_t BasicPage<PageSize>::SIZE;
+
+template <std::size_t PageSize>
+const std::size_t BasicPage<PageSize>::DATA_SIZE;
+
+template <std::size_t PageSize>
+const PageId BasicPage<PageSize>::INVALID_NUMBER;
+
+template <std::size_t PageSize>
+const SlotId BasicPage<PageSize>::INVALID_SLOT;
+
+/**
+ * @brief Page with the default page size.
+ */
+typedef BasicPage<DEFAULT_PAGE_SIZE> Page;
 
 }
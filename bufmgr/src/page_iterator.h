@@ -20,12 +20,18 @@ namespace badgerdb {
  * This class provides a forward-only iterator that iterates over all the
  * records stored in a Page.
  */
-class PageIterator {
+template <std::size_t PageSize>
+class BasicPageIterator {
  public:
+  /**
+   * Type of page this iterator walks over.
+   */
+  typedef BasicPage<PageSize> Page;
+
   /**
    * Constructs an empty iterator.
    */
-  PageIterator()
+  BasicPageIterator()
       : page_(NULL) {
     current_record_ = {Page::INVALID_NUMBER, Page::INVALID_SLOT};
   }
@@ -36,7 +42,7 @@ class PageIterator {
    *
    * @param page  Page to iterate over.
    */
-  PageIterator(Page* page)
+  BasicPageIterator(Page* page)
       : page_(page)  {
     assert(page_ != NULL);
     const SlotId used_slot = getNextUsedSlot(Page::INVALID_SLOT /* start */);
@@ -50,7 +56,7 @@ class PageIterator {
    * @param page        Page to iterate over.
    * @param record_id   ID of record to start iterator at.
    */
-  PageIterator(Page* page, const RecordId& record_id)
+  BasicPageIterator(Page* page, const RecordId& record_id)
       : page_(page),
         current_record_(record_id) {
   }
@@ -58,7 +64,7 @@ class PageIterator {
   /**
    * Advances the iterator to the next record in the page.
    */
-	inline PageIterator& operator++() {
+	inline BasicPageIterator& operator++() {
     assert(page_ != NULL);
     const SlotId used_slot = getNextUsedSlot(current_record_.slot_number);
     current_record_ = {page_->page_number(), used_slot};
@@ -66,8 +72,8 @@ class PageIterator {
 		return *this;
   }
 
-	inline PageIterator operator++(int) {
-		PageIterator tmp = *this;   // copy ourselves
+	inline BasicPageIterator operator++(int) {
+		BasicPageIterator tmp = *this;   // copy ourselves
 
     assert(page_ != NULL);
     const SlotId used_slot = getNextUsedSlot(current_record_.slot_number);
@@ -81,12 +87,12 @@ class PageIterator {
    * @param rhs   Iterator to compare against.
    * @return    True if other iterator is equal to this one.
    */
-	inline bool operator==(const PageIterator& rhs) const {
+	inline bool operator==(const BasicPageIterator& rhs) const {
     return page_->page_number() == rhs.page_->page_number() &&
         current_record_ == rhs.current_record_;
   }
 
-	inline bool operator!=(const PageIterator& rhs) const {
+	inline bool operator!=(const BasicPageIterator& rhs) const {
     return (page_->page_number() != rhs.page_->page_number()) || 
         (current_record_ != rhs.current_record_);
   }
@@ -133,4 +139,9 @@ class PageIterator {
 
 };
 
+/**
+ * @brief Iterator over the records of a page with the default page size.
+ */
+typedef BasicPageIterator<DEFAULT_PAGE_SIZE> PageIterator;
+
 }
@@ -0,0 +1,89 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "page_trace.h"
+
+#include <cstring>
+
+#include "exceptions/trace_file_exception.h"
+
+namespace badgerdb {
+
+const char PageTraceReader::MAGIC[8] = {'B', 'D', 'B', 'T', 'R', 'C', '0', '1'};
+
+PageTraceWriter::PageTraceWriter(const std::string& filename,
+                                 const std::uint32_t page_size)
+    : filename_(filename),
+      stream_(filename.c_str(), std::ofstream::binary | std::ofstream::trunc),
+      num_records_(0) {
+  if (!stream_) {
+    throw TraceFileException(filename_, "cannot be created");
+  }
+  const std::uint32_t reserved = 0;
+  stream_.write(PageTraceReader::MAGIC, sizeof(PageTraceReader::MAGIC));
+  stream_.write(reinterpret_cast<const char*>(&page_size), sizeof(page_size));
+  stream_.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+}
+
+void PageTraceWriter::record(const PageTraceOp op, const std::string& file,
+                             const PageId page_number, const bool dirty) {
+  std::map<std::string, std::uint16_t>::iterator id = file_ids_.find(file);
+  if (id == file_ids_.end()) {
+    const PageTraceRecord name = {
+        TRACE_FILE, 0, static_cast<std::uint16_t>(file_ids_.size()),
+        static_cast<PageId>(file.size())};
+    stream_.write(reinterpret_cast<const char*>(&name), sizeof(name));
+    stream_.write(file.data(), file.size());
+    id = file_ids_.insert(std::make_pair(file, name.file_id)).first;
+  }
+  const PageTraceRecord entry = {static_cast<std::uint8_t>(op),
+                                 static_cast<std::uint8_t>(dirty),
+                                 id->second, page_number};
+  stream_.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+  ++num_records_;
+}
+
+PageTraceReader::PageTraceReader(const std::string& filename)
+    : filename_(filename),
+      stream_(filename.c_str(), std::ifstream::binary),
+      page_size_(0) {
+  if (!stream_) {
+    throw TraceFileException(filename_, "cannot be opened");
+  }
+  char magic[sizeof(MAGIC)];
+  std::uint32_t reserved;
+  stream_.read(magic, sizeof(magic));
+  stream_.read(reinterpret_cast<char*>(&page_size_), sizeof(page_size_));
+  stream_.read(reinterpret_cast<char*>(&reserved), sizeof(reserved));
+  if (!stream_ || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+    throw TraceFileException(filename_, "is not a page access trace");
+  }
+}
+
+bool PageTraceReader::next(PageTraceRecord& record) {
+  while (stream_.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    if (record.op != TRACE_FILE) {
+      if (record.op < TRACE_READ || record.op > TRACE_DISPOSE ||
+          record.file_id >= filenames_.size()) {
+        throw TraceFileException(filename_, "contains a malformed record");
+      }
+      return true;
+    }
+    std::string name(record.page_number, '\0');
+    if (!stream_.read(&name[0], name.size()) ||
+        record.file_id != filenames_.size()) {
+      throw TraceFileException(filename_, "contains a malformed file record");
+    }
+    filenames_.push_back(name);
+  }
+  if (stream_.gcount() != 0) {
+    throw TraceFileException(filename_, "is truncated");
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,207 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Buffer manager operation recorded in a page access trace.
+ */
+enum PageTraceOp {
+  /**
+   * A page was read (pinned) through BufMgr::readPage.
+   */
+  TRACE_READ = 1,
+
+  /**
+   * A page was allocated through BufMgr::allocPage.
+   */
+  TRACE_ALLOC = 2,
+
+  /**
+   * A page was unpinned; the record's dirty flag is the one passed in.
+   */
+  TRACE_UNPIN = 3,
+
+  /**
+   * A page was deleted through BufMgr::disposePage.
+   */
+  TRACE_DISPOSE = 4,
+
+  /**
+   * Declares a file id.  Followed in the trace by page_number bytes of file
+   * name.  Never returned by PageTraceReader::next().
+   */
+  TRACE_FILE = 5
+};
+
+/**
+ * @brief One record of a page access trace.
+ */
+struct PageTraceRecord {
+  /**
+   * Operation; a PageTraceOp value.
+   */
+  std::uint8_t op;
+
+  /**
+   * Whether an unpinned page was dirtied.
+   */
+  std::uint8_t dirty;
+
+  /**
+   * Small id of the file, assigned in order of first appearance.
+   */
+  std::uint16_t file_id;
+
+  /**
+   * Page number within the file.
+   */
+  PageId page_number;
+};
+
+static_assert(sizeof(PageTraceRecord) == 8,
+              "Trace record layout must match the trace file format.");
+
+/**
+ * @brief Writes a compact binary trace of buffer manager operations.
+ *
+ * A trace starts with an 8-byte magic string and the page size, followed by
+ * 8-byte records.  Files are named once, the first time they appear, and
+ * referred to by a 16-bit id afterwards.
+ *
+ * @warning This class is not threadsafe.
+ */
+class PageTraceWriter {
+ public:
+  /**
+   * Creates a trace file, replacing any existing file of the same name.
+   *
+   * @param filename  Name of the trace file.
+   * @param page_size Page size of the traced buffer pool.
+   * @throws  TraceFileException  If the file cannot be created.
+   */
+  PageTraceWriter(const std::string& filename, const std::uint32_t page_size);
+
+  /**
+   * Appends a record to the trace.
+   *
+   * @param op          Operation performed.
+   * @param file        Name of the file the page belongs to.
+   * @param page_number Number of the page.
+   * @param dirty       Whether an unpinned page was dirtied.
+   */
+  void record(const PageTraceOp op, const std::string& file,
+              const PageId page_number, const bool dirty);
+
+  /**
+   * Writes buffered records to the trace file.
+   */
+  void flush() { stream_.flush(); }
+
+  /**
+   * Returns the number of operations recorded so far.
+   */
+  std::uint64_t numRecords() const { return num_records_; }
+
+ private:
+  /**
+   * Name of the trace file.
+   */
+  std::string filename_;
+
+  /**
+   * Stream for the trace file.
+   */
+  std::ofstream stream_;
+
+  /**
+   * Ids of the files named so far.
+   */
+  std::map<std::string, std::uint16_t> file_ids_;
+
+  /**
+   * Number of operations recorded.
+   */
+  std::uint64_t num_records_;
+};
+
+/**
+ * @brief Reads a trace written by PageTraceWriter.
+ */
+class PageTraceReader {
+ public:
+  /**
+   * Magic string at the start of every trace file.
+   */
+  static const char MAGIC[8];
+
+  /**
+   * Opens a trace file.
+   *
+   * @param filename  Name of the trace file.
+   * @throws  TraceFileException  If the file cannot be opened or is not a
+   *                              page access trace.
+   */
+  explicit PageTraceReader(const std::string& filename);
+
+  /**
+   * Reads the next operation record.
+   *
+   * @param record  Receives the record.
+   * @return  False at the end of the trace.
+   * @throws  TraceFileException  If the trace is truncated or malformed.
+   */
+  bool next(PageTraceRecord& record);
+
+  /**
+   * Returns the page size recorded in the trace header.
+   */
+  std::uint32_t page_size() const { return page_size_; }
+
+  /**
+   * Returns the name of the file with the given id.  Only files already
+   * seen by next() are known.
+   *
+   * @param file_id   Id from a trace record.
+   */
+  const std::string& filename(const std::uint16_t file_id) const {
+    return filenames_[file_id];
+  }
+
+ private:
+  /**
+   * Name of the trace file.
+   */
+  std::string filename_;
+
+  /**
+   * Stream for the trace file.
+   */
+  std::ifstream stream_;
+
+  /**
+   * Page size from the trace header.
+   */
+  std::uint32_t page_size_;
+
+  /**
+   * File names indexed by file id.
+   */
+  std::vector<std::string> filenames_;
+};
+
+}
@@ -0,0 +1,559 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "checksum.h"
+#include "file.h"
+#include "file_iterator.h"
+#include "page.h"
+#include "types.h"
+#include "exceptions/column_width_mismatch_exception.h"
+#include "exceptions/insufficient_space_exception.h"
+#include "exceptions/invalid_page_format_exception.h"
+#include "exceptions/invalid_record_exception.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Describes the fixed-width columns of rows stored on PAX pages.
+ *
+ * A row is the concatenation of its column values in column order.
+ */
+class PaxSchema {
+ public:
+  /**
+   * Constructs a schema with no columns.
+   */
+  PaxSchema() : row_width_(0) {}
+
+  /**
+   * Constructs a schema with columns of the given widths.
+   *
+   * @param widths  Width in bytes of each column, in column order.
+   */
+  explicit PaxSchema(const std::vector<std::size_t>& widths)
+      : row_width_(0) {
+    for (std::size_t i = 0; i < widths.size(); ++i) {
+      addColumn(widths[i]);
+    }
+  }
+
+  /**
+   * Appends a column to the schema.
+   *
+   * @param width   Width of the column's values in bytes.
+   * @return  Index of the new column.
+   */
+  std::size_t addColumn(const std::size_t width) {
+    assert(width > 0);
+    offsets_.push_back(row_width_);
+    widths_.push_back(width);
+    row_width_ += width;
+    return widths_.size() - 1;
+  }
+
+  /**
+   * Appends a column holding values of type T.
+   *
+   * @return  Index of the new column.
+   */
+  template <typename T>
+  std::size_t addColumn() { return addColumn(sizeof(T)); }
+
+  /**
+   * Returns the number of columns.
+   */
+  std::size_t num_columns() const { return widths_.size(); }
+
+  /**
+   * Returns the width in bytes of the given column.
+   */
+  std::size_t width(const std::size_t column) const { return widths_[column]; }
+
+  /**
+   * Returns the offset of the given column within a row.
+   */
+  std::size_t offset(const std::size_t column) const {
+    return offsets_[column];
+  }
+
+  /**
+   * Returns the width in bytes of a whole row.
+   */
+  std::size_t row_width() const { return row_width_; }
+
+ private:
+  /**
+   * Width of each column.
+   */
+  std::vector<std::size_t> widths_;
+
+  /**
+   * Offset of each column within a row.
+   */
+  std::vector<std::size_t> offsets_;
+
+  /**
+   * Sum of all column widths.
+   */
+  std::size_t row_width_;
+};
+
+/**
+ * @brief Metadata at the start of the data area of a PAX page.
+ */
+struct PaxPageHeader {
+  /**
+   * Number of columns the page was formatted for.
+   */
+  std::uint16_t num_columns;
+
+  /**
+   * Row width the page was formatted for.
+   */
+  std::uint16_t row_width;
+
+  /**
+   * Number of rows that fit on the page.
+   */
+  std::uint16_t capacity;
+
+  /**
+   * Number of rows currently stored on the page.
+   */
+  std::uint16_t num_records;
+
+  /**
+   * CRC32C of the column widths in column order.  Schemas with the same
+   * columns in another order have the same row width but not the same
+   * layout, so the widths themselves identify the schema of the page.
+   */
+  std::uint32_t widths_checksum;
+};
+
+/**
+ * @brief Partition Attributes Across (PAX) layout for analytical scans.
+ *
+ * A PAX page stores the same rows as a slotted page would, but groups the
+ * values of each column together in a minipage.  A scan that reads one column
+ * then only pulls that column's minipage through the cache instead of every
+ * byte of every row.  Row presence is tracked in a bitmap and rows are
+ * addressed by slot number, so RecordIds keep their meaning.
+ *
+ * A PaxPage is a view over a Page and keeps a pointer to the schema; both
+ * must outlive it.  The page header's slot fields are left empty so the
+ * slotted-page API sees a full page with no records.
+ *
+ * @warning This class is not threadsafe.
+ */
+template <std::size_t PageSize = DEFAULT_PAGE_SIZE>
+class PaxPage {
+ public:
+  /**
+   * Type of the page this layout is applied to.
+   */
+  typedef BasicPage<PageSize> Page;
+
+  /**
+   * Formats the given page as an empty PAX page for the given schema,
+   * discarding its records.  The page number and next page pointer are kept.
+   *
+   * @param page    Page to format.
+   * @param schema  Schema of the rows the page will hold.
+   * @return  View over the formatted page.
+   */
+  static PaxPage format(Page* page, const PaxSchema& schema) {
+    assert(schema.num_columns() > 0);
+    assert(capacityFor(schema) > 0);
+    page->header_.free_space_lower_bound = Page::DATA_SIZE;
+    page->header_.free_space_upper_bound = Page::DATA_SIZE;
+    page->header_.num_slots = 0;
+    page->header_.num_free_slots = 0;
+    page->data_.assign(Page::DATA_SIZE, char());
+    page->checksum_pending_.store(false, std::memory_order_relaxed);
+    PaxPageHeader* header = reinterpret_cast<PaxPageHeader*>(&page->data_[0]);
+    header->num_columns = schema.num_columns();
+    header->row_width = schema.row_width();
+    header->capacity = capacityFor(schema);
+    header->num_records = 0;
+    header->widths_checksum = widthsChecksum(schema);
+    return PaxPage(page, schema);
+  }
+
+  /**
+   * Constructs a view over a page previously formatted with format().
+   *
+   * @param page    Page to access.
+   * @param schema  Schema the page was formatted with.
+   * @throws  InvalidPageFormatException  If the page was not formatted as a
+   *                                      PAX page for this schema.
+   */
+  PaxPage(Page* page, const PaxSchema& schema)
+      : page_(page),
+        schema_(&schema),
+        minipage_offsets_(schema.num_columns()) {
+    page_->verifyIfPending();
+    const PaxPageHeader* header = this->header();
+    if (page_->header_.num_slots != 0 ||
+        header->num_columns != schema.num_columns() ||
+        header->row_width != schema.row_width() ||
+        header->capacity != capacityFor(schema) ||
+        header->widths_checksum != widthsChecksum(schema)) {
+      throw InvalidPageFormatException(page_->page_number(),
+                                       "a PAX page for this schema");
+    }
+    std::size_t offset = minipagesOffset(header->capacity);
+    for (std::size_t i = 0; i < schema.num_columns(); ++i) {
+      minipage_offsets_[i] = offset;
+      offset = align(offset + header->capacity * schema.width(i));
+    }
+  }
+
+  /**
+   * Inserts a row into the first free slot, splitting it into its columns.
+   *
+   * @param row_data  Row bytes laid out as described by the schema.
+   * @return  ID of the newly inserted row.
+   * @throws  InsufficientSpaceException  If the page is full or the row does
+   *                                      not match the schema's row width.
+   */
+  RecordId insertRecord(const std::string& row_data) {
+    if (row_data.length() != schema_->row_width() || isFull()) {
+      throw InsufficientSpaceException(
+          page_->page_number(), row_data.length(),
+          isFull() ? 0 : schema_->row_width());
+    }
+    const SlotId slot_number = firstFreeSlot();
+    for (std::size_t i = 0; i < schema_->num_columns(); ++i) {
+      std::memcpy(valueAt(slot_number, i), row_data.data() + schema_->offset(i),
+                  schema_->width(i));
+    }
+    setUsed(slot_number, true);
+    ++header()->num_records;
+    return {page_->page_number(), slot_number};
+  }
+
+  /**
+   * Returns a copy of the row with the given ID, reassembled from its columns.
+   *
+   * @param record_id  ID of the row to return.
+   * @return  The row bytes.
+   */
+  std::string getRecord(const RecordId& record_id) const {
+    validateRecordId(record_id);
+    std::string row(schema_->row_width(), char());
+    for (std::size_t i = 0; i < schema_->num_columns(); ++i) {
+      std::memcpy(&row[schema_->offset(i)],
+                  valueAt(record_id.slot_number, i), schema_->width(i));
+    }
+    return row;
+  }
+
+  /**
+   * Deletes the row with the given ID.  Other rows do not move.
+   *
+   * @param record_id   ID of the row to delete.
+   */
+  void deleteRecord(const RecordId& record_id) {
+    validateRecordId(record_id);
+    setUsed(record_id.slot_number, false);
+    --header()->num_records;
+  }
+
+  /**
+   * Returns the value of one column of a row.
+   *
+   * @param record_id   ID of the row.
+   * @param column      Index of the column; its width must be sizeof(T).
+   * @return  The column value.
+   * @throws  ColumnWidthMismatchException  If the column is not sizeof(T)
+   *                                        bytes wide.
+   */
+  template <typename T>
+  T getValue(const RecordId& record_id, const std::size_t column) const {
+    validateWidth(column, sizeof(T));
+    validateRecordId(record_id);
+    T value;
+    std::memcpy(&value, valueAt(record_id.slot_number, column), sizeof(T));
+    return value;
+  }
+
+  /**
+   * Replaces the value of one column of a row.
+   *
+   * @param record_id   ID of the row.
+   * @param column      Index of the column; its width must be sizeof(T).
+   * @param value       New column value.
+   * @throws  ColumnWidthMismatchException  If the column is not sizeof(T)
+   *                                        bytes wide.
+   */
+  template <typename T>
+  void setValue(const RecordId& record_id, const std::size_t column,
+                const T& value) {
+    validateWidth(column, sizeof(T));
+    validateRecordId(record_id);
+    std::memcpy(valueAt(record_id.slot_number, column), &value, sizeof(T));
+  }
+
+  /**
+   * Returns the minipage of the given column: the values of slots 1 to
+   * capacity() stored contiguously, schema.width(column) bytes apart.
+   * Values of unused slots are meaningless.
+   *
+   * @param column  Index of the column.
+   * @return  Pointer to the first value of the column.
+   */
+  const char* getColumnData(const std::size_t column) const {
+    return page_->data_.data() + minipage_offsets_[column];
+  }
+
+  /**
+   * Returns true if the given slot holds a row.
+   *
+   * @param slot_number   Slot to check.
+   */
+  bool isUsed(const SlotId slot_number) const {
+    const std::size_t bit = slot_number - 1;
+    return (bitmap()[bit / 8] >> (bit % 8)) & 1;
+  }
+
+  /**
+   * Returns the next used slot after the given slot or Page::INVALID_SLOT if
+   * no slots are used after it.  Pass Page::INVALID_SLOT to find the first.
+   *
+   * @param start   Slot to start search after.
+   * @return  Next used slot after given slot or Page::INVALID_SLOT.
+   */
+  SlotId getNextUsedSlot(const SlotId start) const {
+    for (std::size_t bit = start; bit < capacity(); ++bit) {
+      const unsigned char byte = bitmap()[bit / 8] >> (bit % 8);
+      if (byte == 0) {
+        // Rest of this bitmap byte is empty; skip to the next one.
+        bit |= 7;
+        continue;
+      }
+      if (byte & 1) {
+        return static_cast<SlotId>(bit + 1);
+      }
+    }
+    return Page::INVALID_SLOT;
+  }
+
+  /**
+   * Returns the number of rows that fit on the page.
+   */
+  std::uint16_t capacity() const { return header()->capacity; }
+
+  /**
+   * Returns the number of rows stored on the page.
+   */
+  std::uint16_t numRecords() const { return header()->num_records; }
+
+  /**
+   * Returns true if no more rows fit on the page.
+   */
+  bool isFull() const { return header()->num_records == capacity(); }
+
+  /**
+   * Returns the number of the underlying page in its file.
+   */
+  PageId page_number() const { return page_->page_number(); }
+
+  /**
+   * Returns the number of rows of the given schema that fit on one page.
+   *
+   * @param schema  Schema of the rows.
+   */
+  static std::uint16_t capacityFor(const PaxSchema& schema) {
+    // Each row costs its width plus one bitmap bit; each minipage may lose up
+    // to 7 bytes to alignment.
+    if (sizeof(PaxPageHeader) + 8 * (schema.num_columns() + 1) +
+        schema.row_width() > Page::DATA_SIZE) {
+      return 0;
+    }
+    const std::size_t usable = Page::DATA_SIZE - sizeof(PaxPageHeader) -
+        8 * (schema.num_columns() + 1);
+    std::size_t capacity = 8 * usable / (8 * schema.row_width() + 1);
+    while (capacity > 0 && spaceFor(schema, capacity) > Page::DATA_SIZE) {
+      --capacity;
+    }
+    return capacity > UINT16_MAX ? UINT16_MAX : capacity;
+  }
+
+ private:
+  static std::size_t align(const std::size_t offset) {
+    return (offset + 7) & ~std::size_t(7);
+  }
+
+  static std::uint32_t widthsChecksum(const PaxSchema& schema) {
+    std::uint32_t crc = 0;
+    for (std::size_t i = 0; i < schema.num_columns(); ++i) {
+      // Fixed-width values so the checksum does not depend on sizeof(size_t).
+      const std::uint32_t width = schema.width(i);
+      crc = crc32c(&width, sizeof(width), crc);
+    }
+    return crc;
+  }
+
+  static std::size_t minipagesOffset(const std::size_t capacity) {
+    return align(sizeof(PaxPageHeader) + (capacity + 7) / 8);
+  }
+
+  /**
+   * Returns the bytes needed to hold <capacity> rows of the given schema.
+   */
+  static std::size_t spaceFor(const PaxSchema& schema,
+                              const std::size_t capacity) {
+    std::size_t offset = minipagesOffset(capacity);
+    for (std::size_t i = 0; i < schema.num_columns(); ++i) {
+      offset = align(offset + capacity * schema.width(i));
+    }
+    return offset;
+  }
+
+  PaxPageHeader* header() {
+    return reinterpret_cast<PaxPageHeader*>(&page_->data_[0]);
+  }
+
+  const PaxPageHeader* header() const {
+    return reinterpret_cast<const PaxPageHeader*>(page_->data_.data());
+  }
+
+  unsigned char* bitmap() {
+    return reinterpret_cast<unsigned char*>(
+        &page_->data_[sizeof(PaxPageHeader)]);
+  }
+
+  const unsigned char* bitmap() const {
+    return reinterpret_cast<const unsigned char*>(
+        page_->data_.data() + sizeof(PaxPageHeader));
+  }
+
+  char* valueAt(const SlotId slot_number, const std::size_t column) {
+    return &page_->data_[minipage_offsets_[column] +
+                         (slot_number - 1) * schema_->width(column)];
+  }
+
+  const char* valueAt(const SlotId slot_number,
+                      const std::size_t column) const {
+    return getColumnData(column) + (slot_number - 1) * schema_->width(column);
+  }
+
+  void setUsed(const SlotId slot_number, const bool used) {
+    const std::size_t bit = slot_number - 1;
+    if (used) {
+      bitmap()[bit / 8] |= 1 << (bit % 8);
+    } else {
+      bitmap()[bit / 8] &= ~(1 << (bit % 8));
+    }
+  }
+
+  /**
+   * Returns the lowest numbered unused slot.  The page must not be full.
+   */
+  SlotId firstFreeSlot() const {
+    std::size_t byte = 0;
+    while (bitmap()[byte] == 0xFF) {
+      ++byte;
+    }
+    return static_cast<SlotId>(byte * 8 + __builtin_ctz(~bitmap()[byte]) + 1);
+  }
+
+  /**
+   * Throws an exception if a value of the given size does not fit the given
+   * column exactly.
+   *
+   * @param column  Index of the column.
+   * @param size    Size of the value in bytes.
+   * @throws  ColumnWidthMismatchException  Thrown if the sizes differ.
+   */
+  void validateWidth(const std::size_t column, const std::size_t size) const {
+    assert(column < schema_->num_columns());
+    if (schema_->width(column) != size) {
+      throw ColumnWidthMismatchException(page_->page_number(), column,
+                                         schema_->width(column), size);
+    }
+  }
+
+  /**
+   * Throws an exception if the given record ID does not name a used slot on
+   * this page.
+   *
+   * @param record_id   Record ID to validate.
+   * @throws  InvalidRecordException  Thrown if the ID has a bad page or slot
+   *                                  number.
+   */
+  void validateRecordId(const RecordId& record_id) const {
+    if (record_id.page_number != page_->page_number() ||
+        record_id.slot_number == Page::INVALID_SLOT ||
+        record_id.slot_number > capacity() ||
+        !isUsed(record_id.slot_number)) {
+      throw InvalidRecordException(record_id, page_->page_number());
+    }
+  }
+
+  /**
+   * Page whose data area holds the rows.
+   */
+  Page* page_;
+
+  /**
+   * Schema of the rows on the page.
+   */
+  const PaxSchema* schema_;
+
+  /**
+   * Offset of each column's minipage in the page's data area.
+   */
+  std::vector<std::size_t> minipage_offsets_;
+};
+
+/**
+ * Scans the requested columns of every row in a file of PAX pages.  Only the
+ * minipages of the requested columns are touched on each page.
+ *
+ * The callback is invoked as callback(record_id, values), where values[i]
+ * points to the value of columns[i] for that row.  The pointers are only valid
+ * during the call.
+ *
+ * @param file      File whose used pages are all PAX pages for <schema>.
+ * @param schema    Schema of the rows in the file.
+ * @param columns   Indexes of the columns to read.
+ * @param callback  Function called once per row.
+ */
+template <std::size_t PageSize, typename Callback>
+void scanColumns(BasicFile<PageSize>& file, const PaxSchema& schema,
+                 const std::vector<std::size_t>& columns, Callback callback) {
+  std::vector<const char*> values(columns.size());
+  for (BasicFileIterator<PageSize> iter = file.begin(); iter != file.end();
+       ++iter) {
+    BasicPage<PageSize> page = *iter;
+    PaxPage<PageSize> pax(&page, schema);
+    std::vector<const char*> minipages(columns.size());
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+      minipages[i] = pax.getColumnData(columns[i]);
+    }
+    for (SlotId slot = pax.getNextUsedSlot(BasicPage<PageSize>::INVALID_SLOT);
+         slot != BasicPage<PageSize>::INVALID_SLOT;
+         slot = pax.getNextUsedSlot(slot)) {
+      for (std::size_t i = 0; i < columns.size(); ++i) {
+        values[i] = minipages[i] + (slot - 1) * schema.width(columns[i]);
+      }
+      const RecordId record_id = {page.page_number(), slot};
+      callback(record_id, values.data());
+    }
+  }
+}
+
+}
@@ -0,0 +1,57 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <unistd.h>
+
+namespace badgerdb {
+
+/**
+ * Reads exactly <length> bytes at <offset>.  Returns false on a short read.
+ */
+inline bool readAt(const int fd, void* data, const std::size_t length,
+                   const std::uint64_t offset) {
+  std::size_t done = 0;
+  while (done < length) {
+    const ssize_t n = ::pread(fd, static_cast<char*>(data) + done,
+                              length - done, offset + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    done += n;
+  }
+  return true;
+}
+
+/**
+ * Writes exactly <length> bytes at <offset>.  Returns false on an error.
+ */
+inline bool writeAt(const int fd, const void* data, const std::size_t length,
+                    const std::uint64_t offset) {
+  std::size_t done = 0;
+  while (done < length) {
+    const ssize_t n = ::pwrite(fd, static_cast<const char*>(data) + done,
+                               length - done, offset + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    done += n;
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,296 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "recovery.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
+#include <vector>
+
+#include "file.h"
+#include "posix_io.h"
+#include "write_ahead_log.h"
+#include "exceptions/page_size_mismatch_exception.h"
+#include "exceptions/recovery_exception.h"
+
+namespace badgerdb {
+
+namespace {
+
+/**
+ * One page or file header write to replay.
+ */
+struct RedoRecord {
+  /**
+   * Index of the file in the list of files the log covers.
+   */
+  std::uint32_t file;
+
+  /**
+   * Record type; a LogRecordType value.
+   */
+  std::uint32_t type;
+
+  /**
+   * Number of the page; 0 for a file header.
+   */
+  PageId page_number;
+
+  /**
+   * LSN of the record.
+   */
+  Lsn lsn;
+
+  /**
+   * Contents, as described for PageImageRecord::image.
+   */
+  std::string image;
+};
+
+/**
+ * Closes the data files when recovery ends, however it ends.
+ */
+struct DataFiles {
+  std::vector<std::string> names;
+  std::vector<int> fds;
+
+  ~DataFiles() {
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+      if (fds[i] >= 0) {
+        ::close(fds[i]);
+      }
+    }
+  }
+};
+
+/**
+ * Returns the thread replaying the records of a page.
+ */
+std::uint32_t partitionOf(const std::uint32_t file, const PageId page_number,
+                          const std::uint32_t threads) {
+  const std::uint64_t key = (static_cast<std::uint64_t>(file) << 32) |
+                            page_number;
+  return static_cast<std::uint32_t>(
+      ((key * 0x9E3779B97F4A7C15ULL) >> 32) % threads);
+}
+
+/**
+ * Reads the log from <start> to its end, setting the redo LSN from the last
+ * checkpoint record and the end LSN.  Returns false if <start> is not the
+ * offset of a checkpoint record.
+ */
+bool scanCheckpoints(const std::string& log_filename, const Lsn start,
+                     RecoveryStats& stats) {
+  LogReader reader(log_filename, start);
+  LogRecord record;
+  bool first = true;
+  while (reader.next(record)) {
+    Lsn redo_lsn;
+    if (WriteAheadLog::decodeCheckpoint(record, redo_lsn)) {
+      stats.redo_lsn = redo_lsn;
+    } else if (first && start != WriteAheadLog::HEADER_SIZE) {
+      return false;
+    }
+    first = false;
+  }
+  if (first && start != WriteAheadLog::HEADER_SIZE) {
+    return false;
+  }
+  stats.end_lsn = reader.position();
+  return true;
+}
+
+}
+
+template <std::size_t PageSize>
+RecoveryStats BasicRecovery<PageSize>::run(const std::string& log_filename,
+                                           std::uint32_t threads) {
+  typedef BasicPage<PageSize> Page;
+  typedef BasicFile<PageSize> File;
+
+  RecoveryStats stats = RecoveryStats();
+  if (threads == 0) {
+    threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  stats.threads = threads;
+
+  // Replay starts where the last checkpoint says.  The log file header points
+  // at a recent checkpoint, so only the log after it is searched for later
+  // ones; without a usable pointer the whole log is.
+  stats.redo_lsn = WriteAheadLog::HEADER_SIZE;
+  const Lsn marked = LogReader(log_filename).checkpoint();
+  if (marked < WriteAheadLog::HEADER_SIZE ||
+      !scanCheckpoints(log_filename, marked, stats)) {
+    scanCheckpoints(log_filename, WriteAheadLog::HEADER_SIZE, stats);
+  }
+
+  // Split the records by page, keeping each page's records in log order.
+  DataFiles files;
+  std::map<std::string, std::uint32_t> file_numbers;
+  std::vector<std::vector<RedoRecord> > partitions(threads);
+  std::unordered_set<std::uint64_t> pages;
+  {
+    LogReader reader(log_filename, stats.redo_lsn);
+    LogRecord record;
+    PageImageRecord page;
+    while (reader.position() < stats.end_lsn && reader.next(record)) {
+      ++stats.records;
+      if (record.type == LOG_CHECKPOINT) {
+        continue;
+      }
+      std::size_t size = 0;
+      if (record.type == LOG_PAGE_IMAGE || record.type == LOG_FILE_PAGE) {
+        size = Page::SIZE;
+      } else if (record.type == LOG_PAGE_LINK) {
+        size = sizeof(PageId);
+      } else if (record.type == LOG_FILE_HEADER) {
+        size = sizeof(FileHeader);
+      }
+      if (!WriteAheadLog::decodePageImage(record, page) ||
+          page.image.size() != size) {
+        throw RecoveryException(log_filename, "holds a malformed record");
+      }
+      const std::map<std::string, std::uint32_t>::const_iterator it =
+          file_numbers.find(page.filename);
+      std::uint32_t file;
+      if (it != file_numbers.end()) {
+        file = it->second;
+      } else {
+        file = static_cast<std::uint32_t>(files.names.size());
+        file_numbers[page.filename] = file;
+        files.names.push_back(page.filename);
+      }
+      pages.insert((static_cast<std::uint64_t>(file) << 32) |
+                   page.page_number);
+
+      RedoRecord redo;
+      redo.file = file;
+      redo.type = record.type;
+      redo.page_number = page.page_number;
+      redo.lsn = record.lsn;
+      redo.image.swap(page.image);
+      partitions[partitionOf(file, page.page_number, threads)].push_back(
+          std::move(redo));
+    }
+  }
+  stats.pages = pages.size();
+  stats.files = files.names.size();
+
+  // Records of a file that was removed after they were logged are ignored.
+  for (std::size_t i = 0; i < files.names.size(); ++i) {
+    const int fd = ::open(files.names[i].c_str(), O_RDWR);
+    files.fds.push_back(fd);
+    if (fd < 0) {
+      if (errno == ENOENT) {
+        continue;
+      }
+      throw RecoveryException(files.names[i], "cannot be opened");
+    }
+    FileHeader header;
+    if (!readAt(fd, &header, sizeof(header), 0)) {
+      throw RecoveryException(files.names[i], "has no file header");
+    }
+    if (header.page_size != PageSize) {
+      throw PageSizeMismatchException(files.names[i], header.page_size,
+                                      PageSize);
+    }
+    if (header.format != FILE_FORMAT_PLAIN) {
+      throw RecoveryException(files.names[i],
+                              "is not in the plain format and cannot be recovered");
+    }
+  }
+
+  std::atomic<std::uint64_t> redone(0);
+  std::atomic<std::uint64_t> skipped(0);
+  std::mutex failure_mutex;
+  std::string failed_file;
+  std::vector<std::thread> workers;
+  for (std::uint32_t t = 0; t < threads; ++t) {
+    workers.push_back(std::thread([&, t]() {
+      Page page;
+      for (std::size_t i = 0; i < partitions[t].size(); ++i) {
+        const RedoRecord& redo = partitions[t][i];
+        const int fd = files.fds[redo.file];
+        if (fd < 0) {
+          continue;
+        }
+        bool written;
+        if (redo.type == LOG_FILE_HEADER) {
+          written = writeAt(fd, redo.image.data(), redo.image.size(), 0);
+        } else {
+          const std::uint64_t position =
+              static_cast<std::uint64_t>(File::pagePosition(redo.page_number));
+          // A page past the end of the file reads as zeros.
+          PageHeader on_disk = PageHeader();
+          page.header_ = PageHeader();
+          page.data_.assign(Page::DATA_SIZE, '\0');
+          if (redo.type == LOG_PAGE_LINK) {
+            readAt(fd, &page.header_, sizeof(page.header_), position);
+            readAt(fd, &page.data_[0], Page::DATA_SIZE,
+                   position + sizeof(PageHeader));
+            std::memcpy(&page.header_.next_page_number, redo.image.data(),
+                        sizeof(PageId));
+          } else {
+            std::memcpy(&page.header_, redo.image.data(), sizeof(PageHeader));
+            page.data_.assign(redo.image, sizeof(PageHeader),
+                              Page::DATA_SIZE);
+            if (redo.type == LOG_PAGE_IMAGE) {
+              if (readAt(fd, &on_disk, sizeof(on_disk), position)) {
+                if (on_disk.page_lsn >= redo.lsn) {
+                  ++skipped;
+                  continue;
+                }
+                page.header_.next_page_number = on_disk.next_page_number;
+              }
+              page.header_.page_lsn = redo.lsn;
+            }
+          }
+          page.header_.checksum =
+              Page::computeChecksum(page.header_, page.data_);
+          written = writeAt(fd, &page.header_, sizeof(page.header_),
+                            position) &&
+                    writeAt(fd, page.data_.data(), Page::DATA_SIZE,
+                            position + sizeof(PageHeader));
+        }
+        if (!written) {
+          std::lock_guard<std::mutex> lock(failure_mutex);
+          failed_file = files.names[redo.file];
+          return;
+        }
+        ++redone;
+      }
+    }));
+  }
+  for (std::size_t t = 0; t < workers.size(); ++t) {
+    workers[t].join();
+  }
+  if (!failed_file.empty()) {
+    throw RecoveryException(failed_file, "cannot be written");
+  }
+  for (std::size_t i = 0; i < files.fds.size(); ++i) {
+    if (files.fds[i] >= 0 && ::fdatasync(files.fds[i]) != 0) {
+      throw RecoveryException(files.names[i], "cannot be synced");
+    }
+  }
+  stats.redone = redone.load();
+  stats.skipped = skipped.load();
+  return stats;
+}
+
+#define BADGERDB_INSTANTIATE_RECOVERY(size) template class BasicRecovery<size>;
+BADGERDB_FOR_EACH_PAGE_SIZE(BADGERDB_INSTANTIATE_RECOVERY)
+#undef BADGERDB_INSTANTIATE_RECOVERY
+
+}
@@ -0,0 +1,119 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "page.h"
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief What a recovery pass read and replayed.
+ */
+struct RecoveryStats {
+  /**
+   * Log offset replay started from: the redo LSN of the last checkpoint, or
+   * the start of the log if there is none.
+   */
+  Lsn redo_lsn;
+
+  /**
+   * Log offset just past the last valid record.
+   */
+  Lsn end_lsn;
+
+  /**
+   * Number of records read from redo_lsn on.
+   */
+  std::uint64_t records;
+
+  /**
+   * Number of page and file header writes replayed.
+   */
+  std::uint64_t redone;
+
+  /**
+   * Number of page images not replayed because the page on disk already had
+   * the change: its page LSN was at least the record's.
+   */
+  std::uint64_t skipped;
+
+  /**
+   * Number of distinct pages and file headers the replayed records touch.
+   */
+  std::uint64_t pages;
+
+  /**
+   * Number of files the replayed records touch, including files that no
+   * longer exist, whose records are ignored.
+   */
+  std::uint64_t files;
+
+  /**
+   * Number of threads the records were replayed on.
+   */
+  std::uint32_t threads;
+};
+
+/**
+ * @brief Redo recovery of the files covered by a write-ahead log.
+ *
+ * After a crash, run() replays the log onto the files named in it before the
+ * files are opened.  Replay starts at the redo LSN of the last LOG_CHECKPOINT
+ * record, which the log file header points at, so its cost depends on how
+ * much was logged since the checkpoint, not on the size of the files or of
+ * the log before it.  Each record changes one page or one file
+ * header, so the records are split by page across threads, each replaying
+ * the records of its pages in log order.
+ *
+ * Page images logged by BufMgr restore the page contents; the next page
+ * number is left as it is on disk, as File::writePage() does.  A page image
+ * whose page already carries the record's LSN or a later one is skipped.
+ * Records logged by File while allocating and deleting pages restore the
+ * used and free page lists and the file header, so an allocatePage() or
+ * deletePage() cut short between its writes is finished.
+ *
+ * Replay relies on every change from the redo LSN on being logged, so the
+ * files must have had the log attached to both the BufMgr and the File
+ * objects.  Data files are synced once replay is done.  Replayed pages are
+ * written as File writes them in the plain format; files in the compressed
+ * format cannot be recovered, and files in the shadow format need no log.
+ */
+template <std::size_t PageSize>
+class BasicRecovery {
+ public:
+  /**
+   * Replays a write-ahead log onto the files it covers.  None of the files
+   * may be open.  Records of files that no longer exist are ignored.
+   *
+   * @param log_filename  Name of the log file.
+   * @param threads       Number of threads to replay on, or 0 for one per
+   *                      hardware thread.
+   * @return  What was read and replayed.
+   * @throws  LogFileException  If the log cannot be opened or read.
+   * @throws  PageSizeMismatchException If a file has another page size.
+   * @throws  RecoveryException If the log holds a malformed record, or a file
+   *                            is not in the plain format or cannot be
+   *                            written or synced.
+   */
+  static RecoveryStats run(const std::string& log_filename,
+                           const std::uint32_t threads = 0);
+
+ private:
+  BasicRecovery();
+};
+
+/**
+ * @brief Recovery of files of the default page size
+ */
+typedef BasicRecovery<DEFAULT_PAGE_SIZE> Recovery;
+
+}
@@ -0,0 +1,367 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "shadow_page_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "checksum.h"
+#include "exceptions/shadow_file_exception.h"
+
+namespace badgerdb {
+
+const char ShadowPageStore::MAGIC[8] = {'B', 'D', 'B', 'S',
+                                        'H', 'D', 'W', '1'};
+const std::uint32_t ShadowPageStore::NO_SLOT;
+const std::size_t ShadowPageStore::ROOT_SIZE;
+const std::size_t ShadowPageStore::MAX_METADATA;
+
+namespace {
+
+/**
+ * Checksums a root record, with its checksum field taken as zero, followed by
+ * the metadata.
+ */
+std::uint32_t rootChecksum(const ShadowRoot& root,
+                           const std::string& metadata) {
+  ShadowRoot unstamped = root;
+  unstamped.checksum = 0;
+  const std::uint32_t crc = crc32c(&unstamped, sizeof(unstamped));
+  return crc32c(metadata.data(), metadata.size(), crc);
+}
+
+/**
+ * Returns the number of slots holding a mapping table of <entries> entries.
+ */
+std::uint32_t tableSlots(const std::size_t entries,
+                         const std::size_t page_size) {
+  return static_cast<std::uint32_t>(
+      (entries * sizeof(std::uint32_t) + page_size - 1) / page_size);
+}
+
+}
+
+ShadowPageStore::ShadowPageStore(std::fstream& stream,
+                                 const std::string& filename,
+                                 const std::uint64_t first_root,
+                                 const std::size_t page_size,
+                                 const std::string& metadata,
+                                 const bool create_new)
+    : filename_(filename),
+      fd_(::open(filename.c_str(), O_RDWR)),
+      first_root_(first_root),
+      first_slot_((first_root + 2 * ROOT_SIZE + page_size - 1) / page_size *
+                  page_size),
+      page_size_(page_size),
+      committed_table_(NO_SLOT, 0),
+      changed_(false),
+      end_slot_(0) {
+  if (fd_ < 0) {
+    throw ShadowFileException(filename_, "cannot be opened");
+  }
+  pending_.generation = 0;
+  pending_.metadata = metadata.substr(0, MAX_METADATA);
+  if (create_new) {
+    // Generation 0 has no pages; the other root area is left empty.
+    writeRoot(stream);
+    committed_.reset(new ShadowVersion(pending_));
+  } else {
+    load(stream);
+  }
+}
+
+ShadowPageStore::~ShadowPageStore() {
+  ::close(fd_);
+}
+
+void ShadowPageStore::readPage(std::fstream& stream,
+                               const ShadowVersion* version,
+                               const PageId page_number, char* header,
+                               const std::size_t header_size,
+                               char* data) const {
+  const std::vector<std::uint32_t>& slots =
+      version ? version->slots : pending_.slots;
+  stream.seekg(slotPosition(slots[page_number]), std::ios::beg);
+  stream.read(header, header_size);
+  if (data != NULL) {
+    stream.read(data, page_size_ - header_size);
+  }
+}
+
+void ShadowPageStore::writePage(std::fstream& stream,
+                                const PageId page_number, const char* header,
+                                const std::size_t header_size,
+                                const char* data) {
+  if (page_number >= pending_.slots.size()) {
+    pending_.slots.resize(page_number + 1, NO_SLOT);
+  }
+  // A slot of the committed state is never overwritten; the first write of a
+  // page after a commit moves it to a slot of its own.
+  std::uint32_t& slot = pending_.slots[page_number];
+  if (slot == NO_SLOT || fresh_slots_.find(slot) == fresh_slots_.end()) {
+    slot = allocate(1);
+    fresh_slots_.insert(slot);
+  }
+  stream.seekp(slotPosition(slot), std::ios::beg);
+  stream.write(header, header_size);
+  stream.write(data, page_size_ - header_size);
+  stream.flush();
+  changed_ = true;
+}
+
+void ShadowPageStore::setMetadata(const std::string& metadata) {
+  pending_.metadata.assign(metadata, 0, pending_.metadata.size());
+  changed_ = true;
+}
+
+void ShadowPageStore::commit(std::fstream& stream) {
+  if (!changed_) {
+    return;
+  }
+  pending_.generation = committed_->generation + 1;
+  const std::uint32_t table_slot = writeRoot(stream);
+
+  // The new state is durable; slots only the previous one used are retired
+  // until no snapshot of it is left.
+  const std::uint64_t retired = committed_->generation;
+  for (std::size_t page_number = 0; page_number < committed_->slots.size();
+       ++page_number) {
+    const std::uint32_t slot = committed_->slots[page_number];
+    if (slot != NO_SLOT && slot != pending_.slots[page_number]) {
+      retired_slots_.push_back(std::make_pair(retired, slot));
+    }
+  }
+  for (std::uint32_t i = 0; i < committed_table_.second; ++i) {
+    retired_slots_.push_back(
+        std::make_pair(retired, committed_table_.first + i));
+  }
+  committed_table_ = std::make_pair(
+      table_slot, tableSlots(pending_.slots.size(), page_size_));
+  for (std::set<std::uint32_t>::const_iterator it = fresh_slots_.begin();
+       it != fresh_slots_.end(); ++it) {
+    slot_births_[*it] = pending_.generation;
+  }
+  for (std::uint32_t i = 0; i < committed_table_.second; ++i) {
+    slot_births_[committed_table_.first + i] = pending_.generation;
+  }
+  committed_.reset(new ShadowVersion(pending_));
+  fresh_slots_.clear();
+  changed_ = false;
+  reclaim();
+}
+
+std::shared_ptr<const ShadowVersion> ShadowPageStore::snapshot() {
+  if (snapshots_.empty() || snapshots_.back().lock() != committed_) {
+    snapshots_.push_back(committed_);
+  }
+  return committed_;
+}
+
+void ShadowPageStore::load(std::fstream& stream) {
+  stream.clear();
+  stream.seekg(0, std::ios::end);
+  const std::uint64_t size = static_cast<std::uint64_t>(stream.tellg());
+  end_slot_ = size > first_slot_
+      ? static_cast<std::uint32_t>((size - first_slot_ + page_size_ - 1) /
+                                   page_size_)
+      : 0;
+
+  ShadowVersion versions[2];
+  ShadowRoot roots[2];
+  bool valid[2];
+  for (int area = 0; area < 2; ++area) {
+    versions[area].metadata = pending_.metadata;
+    valid[area] = loadRoot(stream, area, versions[area], roots[area]);
+  }
+  if (!valid[0] && !valid[1]) {
+    throw ShadowFileException(filename_, "has no valid root record");
+  }
+  const int current =
+      !valid[1] || (valid[0] && roots[0].generation > roots[1].generation)
+          ? 0 : 1;
+  pending_ = versions[current];
+  committed_.reset(new ShadowVersion(pending_));
+  committed_table_ = std::make_pair(
+      roots[current].table_slot,
+      tableSlots(roots[current].table_entries, page_size_));
+
+  // Slots the current state does not use, including those of writes a crash
+  // left uncommitted, are free.  No snapshot is older than the current state,
+  // so it can stand for when the used ones were first used.
+  slot_births_.assign(end_slot_, pending_.generation);
+  std::vector<bool> used(end_slot_, false);
+  for (std::size_t i = 0; i < pending_.slots.size(); ++i) {
+    if (pending_.slots[i] != NO_SLOT) {
+      used[pending_.slots[i]] = true;
+    }
+  }
+  for (std::uint32_t i = 0; i < committed_table_.second; ++i) {
+    used[committed_table_.first + i] = true;
+  }
+  for (std::uint32_t slot = 0; slot < end_slot_; ++slot) {
+    if (!used[slot]) {
+      free_slots_.insert(free_slots_.end(), slot);
+    }
+  }
+}
+
+bool ShadowPageStore::loadRoot(std::fstream& stream, const int area,
+                               ShadowVersion& version, ShadowRoot& root) {
+  std::string metadata(version.metadata.size(), char());
+  stream.clear();
+  stream.seekg(first_root_ + area * ROOT_SIZE, std::ios::beg);
+  stream.read(reinterpret_cast<char*>(&root), sizeof(root));
+  if (!metadata.empty()) {
+    stream.read(&metadata[0], metadata.size());
+  }
+  if (!stream || std::memcmp(root.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      rootChecksum(root, metadata) != root.checksum) {
+    stream.clear();
+    return false;
+  }
+
+  // Every slot the state refers to has to lie within the file.
+  const std::uint32_t table_slots = tableSlots(root.table_entries, page_size_);
+  if (table_slots > 0 && (root.table_slot >= end_slot_ ||
+                          end_slot_ - root.table_slot < table_slots)) {
+    return false;
+  }
+  std::vector<std::uint32_t> slots(root.table_entries);
+  if (!slots.empty()) {
+    stream.seekg(slotPosition(root.table_slot), std::ios::beg);
+    stream.read(reinterpret_cast<char*>(&slots[0]),
+                slots.size() * sizeof(std::uint32_t));
+  }
+  if (!stream ||
+      crc32c(slots.data(), slots.size() * sizeof(std::uint32_t)) !=
+          root.table_checksum) {
+    stream.clear();
+    return false;
+  }
+  for (std::size_t i = 0; i < slots.size(); ++i) {
+    if (slots[i] != NO_SLOT && slots[i] >= end_slot_) {
+      return false;
+    }
+  }
+  version.generation = root.generation;
+  version.metadata = metadata;
+  version.slots.swap(slots);
+  return true;
+}
+
+std::uint32_t ShadowPageStore::writeRoot(std::fstream& stream) {
+  ShadowRoot root;
+  std::memcpy(root.magic, MAGIC, sizeof(MAGIC));
+  root.generation = pending_.generation;
+  root.table_entries = static_cast<std::uint32_t>(pending_.slots.size());
+  root.table_slot = NO_SLOT;
+  root.table_checksum =
+      crc32c(pending_.slots.data(),
+             pending_.slots.size() * sizeof(std::uint32_t));
+
+  // The table goes to slots of its own and is durable before the root that
+  // points to it.
+  const std::uint32_t table_slots =
+      tableSlots(pending_.slots.size(), page_size_);
+  if (table_slots > 0) {
+    root.table_slot = allocate(table_slots);
+    buffer_.assign(static_cast<std::size_t>(table_slots) * page_size_, char());
+    std::memcpy(&buffer_[0], pending_.slots.data(),
+                pending_.slots.size() * sizeof(std::uint32_t));
+    stream.seekp(slotPosition(root.table_slot), std::ios::beg);
+    stream.write(buffer_.data(), buffer_.size());
+    sync(stream);
+  }
+
+  // Publish the state in the area holding the older of the two roots.
+  root.checksum = rootChecksum(root, pending_.metadata);
+  buffer_.assign(ROOT_SIZE, char());
+  std::memcpy(&buffer_[0], &root, sizeof(root));
+  std::memcpy(&buffer_[sizeof(root)], pending_.metadata.data(),
+              pending_.metadata.size());
+  stream.seekp(first_root_ + (root.generation % 2) * ROOT_SIZE,
+               std::ios::beg);
+  stream.write(buffer_.data(), buffer_.size());
+  sync(stream);
+  return root.table_slot;
+}
+
+std::uint32_t ShadowPageStore::allocate(const std::uint32_t count) {
+  if (free_slots_.size() < count) {
+    reclaim();
+  }
+  // Look for <count> consecutive free slots.
+  std::set<std::uint32_t>::iterator run = free_slots_.begin();
+  std::uint32_t length = 0;
+  for (std::set<std::uint32_t>::iterator it = free_slots_.begin();
+       it != free_slots_.end() && length < count; ++it) {
+    if (length > 0 && *it == *run + length) {
+      ++length;
+    } else {
+      run = it;
+      length = 1;
+    }
+  }
+  if (length == count) {
+    const std::uint32_t slot = *run;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      free_slots_.erase(run++);
+    }
+    return slot;
+  }
+  const std::uint32_t slot = end_slot_;
+  end_slot_ += count;
+  slot_births_.resize(end_slot_);
+  return slot;
+}
+
+void ShadowPageStore::reclaim() {
+  std::vector<std::uint64_t> generations;
+  std::vector<std::weak_ptr<const ShadowVersion> >::iterator live =
+      snapshots_.begin();
+  for (std::vector<std::weak_ptr<const ShadowVersion> >::iterator it =
+           snapshots_.begin();
+       it != snapshots_.end(); ++it) {
+    const std::shared_ptr<const ShadowVersion> version = it->lock();
+    if (version) {
+      generations.push_back(version->generation);
+      *live++ = *it;
+    }
+  }
+  snapshots_.erase(live, snapshots_.end());
+  std::sort(generations.begin(), generations.end());
+
+  // A slot is still needed if a snapshot is of a state between the first and
+  // the last one that used it.
+
+  std::vector<std::pair<std::uint64_t, std::uint32_t> >::iterator kept =
+      retired_slots_.begin();
+  for (std::vector<std::pair<std::uint64_t, std::uint32_t> >::iterator it =
+           retired_slots_.begin();
+       it != retired_slots_.end(); ++it) {
+    const std::vector<std::uint64_t>::const_iterator needed = std::lower_bound(
+        generations.begin(), generations.end(), slot_births_[it->second]);
+    if (needed == generations.end() || *needed > it->first) {
+      free_slots_.insert(it->second);
+    } else {
+      *kept++ = *it;
+    }
+  }
+  retired_slots_.erase(kept, retired_slots_.end());
+}
+
+void ShadowPageStore::sync(std::fstream& stream) {
+  stream.flush();
+  if (!stream || ::fdatasync(fd_) != 0) {
+    throw ShadowFileException(filename_, "cannot be synced");
+  }
+}
+
+}
@@ -0,0 +1,374 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief One committed state of a file in the shadow format.
+ */
+struct ShadowVersion {
+  /**
+   * Number of the commit that made this state; increases by one per commit.
+   */
+  std::uint64_t generation;
+
+  /**
+   * Metadata committed with the pages; for File, the file header.
+   */
+  std::string metadata;
+
+  /**
+   * Slot of each page by page number, or ShadowPageStore::NO_SLOT if the page
+   * has never been written.
+   */
+  std::vector<std::uint32_t> slots;
+};
+
+/**
+ * @brief Root record of a file in the shadow format.  Two copies are kept;
+ * the valid one with the higher generation is current.
+ */
+struct ShadowRoot {
+  /**
+   * ShadowPageStore::MAGIC.
+   */
+  char magic[8];
+
+  /**
+   * Generation of the committed state.
+   */
+  std::uint64_t generation;
+
+  /**
+   * First of the consecutive slots holding the mapping table.
+   */
+  std::uint32_t table_slot;
+
+  /**
+   * Number of entries in the mapping table.
+   */
+  std::uint32_t table_entries;
+
+  /**
+   * CRC32C of the mapping table.
+   */
+  std::uint32_t table_checksum;
+
+  /**
+   * CRC32C of the root record and metadata with this field set to zero.
+   */
+  std::uint32_t checksum;
+};
+
+static_assert(sizeof(ShadowRoot) == 32,
+              "Root record layout must match the on-disk format.");
+
+/**
+ * @brief Copy-on-write page storage used by files in the shadow format.
+ *
+ * Pages are stored in page-sized slots located through a mapping table
+ * indexed by page number.  A write never touches a slot of the last
+ * committed state: the first write of a page after a commit goes to a free
+ * slot, and later writes before the next commit overwrite that slot.
+ * commit() writes the new mapping table to free slots, syncs the file, and
+ * then publishes the new state by writing a root record into whichever of
+ * the two root areas holds the older state, and syncs again.  A crash at any
+ * point leaves the file in its last committed state, so a change spanning
+ * several pages (and the metadata) becomes durable all at once or not at
+ * all, without a log.  Root records are checksummed; a torn root is ignored
+ * in favour of the other one.
+ *
+ * snapshot() hands out a committed state for reading.  Slots that a later
+ * commit no longer uses are reused only once no snapshot of a state using
+ * them remains, so a snapshot costs nothing until pages are rewritten, and
+ * then holds on to just the slots of its own state.
+ *
+ * The mapping table is rewritten in full by each commit, which suits files
+ * that are read far more often than they are changed.
+ *
+ * The store does not own the stream; callers pass the file's stream to every
+ * operation.
+ *
+ * @warning This class is not threadsafe.
+ */
+class ShadowPageStore {
+ public:
+  /**
+   * Magic string at the start of every root record.
+   */
+  static const char MAGIC[8];
+
+  /**
+   * Slot of a page that has never been written.
+   */
+  static const std::uint32_t NO_SLOT = 0xFFFFFFFFU;
+
+  /**
+   * Size in bytes of each of the two root areas.
+   */
+  static const std::size_t ROOT_SIZE = 512;
+
+  /**
+   * Largest number of metadata bytes a root can hold.
+   */
+  static const std::size_t MAX_METADATA = ROOT_SIZE - sizeof(ShadowRoot);
+
+  /**
+   * Constructs the store for a file, committing an empty state with the given
+   * metadata into a new file or reading the current state of an existing one.
+   *
+   * @param stream      Stream of the file.
+   * @param filename    Name of the file; used to sync it.
+   * @param first_root  Position of the first root area; the second follows
+   *                    it, and slots start after the second.
+   * @param page_size   Size in bytes of a page.
+   * @param metadata    Metadata of a new file, at most MAX_METADATA bytes; for
+   *                    an existing file, any bytes of the committed length.
+   * @param create_new  Whether the file is new.
+   * @throws  ShadowFileException   If no root record of an existing file is
+   *                                valid, or the file cannot be synced.
+   */
+  ShadowPageStore(std::fstream& stream, const std::string& filename,
+                  const std::uint64_t first_root, const std::size_t page_size,
+                  const std::string& metadata, const bool create_new);
+
+  /**
+   * Closes the descriptor used to sync the file.
+   */
+  ~ShadowPageStore();
+
+  /**
+   * Returns true if the page has been written in the given state.
+   *
+   * @param version     State to look in; NULL for the uncommitted state.
+   * @param page_number Number of page.
+   */
+  bool contains(const ShadowVersion* version, const PageId page_number) const {
+    const std::vector<std::uint32_t>& slots =
+        version ? version->slots : pending_.slots;
+    return page_number < slots.size() && slots[page_number] != NO_SLOT;
+  }
+
+  /**
+   * Reads a page.  The page must have been written in the given state.
+   *
+   * @param stream      Stream of the file.
+   * @param version     State to read from; NULL for the uncommitted state.
+   * @param page_number Number of page to read.
+   * @param header      Receives the page header.
+   * @param header_size Number of bytes in the page header.
+   * @param data        Receives the rest of the page, or NULL to read only
+   *                    the header.
+   */
+  void readPage(std::fstream& stream, const ShadowVersion* version,
+                const PageId page_number, char* header,
+                const std::size_t header_size, char* data) const;
+
+  /**
+   * Writes a page into the uncommitted state, in a slot no committed state
+   * uses.
+   *
+   * @param stream      Stream of the file.
+   * @param page_number Number of page to write.
+   * @param header      Page header.
+   * @param header_size Number of bytes in the page header.
+   * @param data        The rest of the page.
+   */
+  void writePage(std::fstream& stream, const PageId page_number,
+                 const char* header, const std::size_t header_size,
+                 const char* data);
+
+  /**
+   * Returns the metadata of the uncommitted state.
+   */
+  const std::string& metadata() const { return pending_.metadata; }
+
+  /**
+   * Replaces the metadata of the uncommitted state.
+   *
+   * @param metadata  New metadata; as many bytes as the current metadata.
+   */
+  void setMetadata(const std::string& metadata);
+
+  /**
+   * Makes the uncommitted state durable and current.  Does nothing if there
+   * have been no writes since the last commit.
+   *
+   * @param stream  Stream of the file.
+   * @throws  ShadowFileException   If the file cannot be synced.
+   */
+  void commit(std::fstream& stream);
+
+  /**
+   * Returns true if there have been writes since the last commit.
+   */
+  bool hasChanges() const { return changed_; }
+
+  /**
+   * Returns the last committed state.  Its slots stay in place while the
+   * returned pointer, or a copy of it, is held.
+   */
+  std::shared_ptr<const ShadowVersion> snapshot();
+
+  /**
+   * Returns the generation of the last committed state.
+   */
+  std::uint64_t generation() const { return committed_->generation; }
+
+  /**
+   * Returns the number of slots in the file, used or free.
+   */
+  std::uint32_t numSlots() const { return end_slot_; }
+
+  /**
+   * Returns the number of slots that can be reused now.
+   */
+  std::size_t numFreeSlots() const { return free_slots_.size(); }
+
+ private:
+  ShadowPageStore(const ShadowPageStore&);
+  ShadowPageStore& operator=(const ShadowPageStore&);
+
+  /**
+   * Returns the position of a slot in the file.
+   */
+  std::uint64_t slotPosition(const std::uint32_t slot) const {
+    return first_slot_ + static_cast<std::uint64_t>(slot) * page_size_;
+  }
+
+  /**
+   * Reads the root records and mapping table of the current state and
+   * rebuilds the free slot list.
+   */
+  void load(std::fstream& stream);
+
+  /**
+   * Reads the root record in root area <area> and its mapping table into
+   * <version>.  Returns false if either is not valid.
+   */
+  bool loadRoot(std::fstream& stream, const int area, ShadowVersion& version,
+                ShadowRoot& root);
+
+  /**
+   * Writes the mapping table and a root record for the uncommitted state.
+   * Returns the first slot of the table, or NO_SLOT if it is empty.
+   */
+  std::uint32_t writeRoot(std::fstream& stream);
+
+  /**
+   * Returns a free slot, or the first of <count> consecutive free slots.
+   */
+  std::uint32_t allocate(const std::uint32_t count);
+
+  /**
+   * Makes retired slots that no snapshot uses any more free.
+   */
+  void reclaim();
+
+  /**
+   * Writes the stream's buffered data and syncs the file.
+   */
+  void sync(std::fstream& stream);
+
+  /**
+   * Name of the file.
+   */
+  const std::string filename_;
+
+  /**
+   * Descriptor used to sync the file.
+   */
+  int fd_;
+
+  /**
+   * Position of the first root area.
+   */
+  const std::uint64_t first_root_;
+
+  /**
+   * Position of slot 0.
+   */
+  const std::uint64_t first_slot_;
+
+  /**
+   * Size in bytes of a page and of a slot.
+   */
+  const std::size_t page_size_;
+
+  /**
+   * Last committed state.
+   */
+  std::shared_ptr<const ShadowVersion> committed_;
+
+  /**
+   * Consecutive slots holding the committed mapping table, as first slot and
+   * count.
+   */
+  std::pair<std::uint32_t, std::uint32_t> committed_table_;
+
+  /**
+   * Uncommitted state: the committed state plus writes since.
+   */
+  ShadowVersion pending_;
+
+  /**
+   * True if there have been writes since the last commit.
+   */
+  bool changed_;
+
+  /**
+   * Slots written since the last commit, which can be written again in
+   * place.
+   */
+  std::set<std::uint32_t> fresh_slots_;
+
+  /**
+   * Slots no state uses.
+   */
+  std::set<std::uint32_t> free_slots_;
+
+  /**
+   * Slots no longer used by the committed state, with the generation of the
+   * last state that used them.
+   */
+  std::vector<std::pair<std::uint64_t, std::uint32_t> > retired_slots_;
+
+  /**
+   * Generation of the first state that used each slot.
+   */
+  std::vector<std::uint64_t> slot_births_;
+
+  /**
+   * States handed out by snapshot().
+   */
+  std::vector<std::weak_ptr<const ShadowVersion> > snapshots_;
+
+  /**
+   * Number of slots in the file.
+   */
+  std::uint32_t end_slot_;
+
+  /**
+   * Scratch buffer holding a page or the mapping table being written.
+   */
+  std::string buffer_;
+};
+
+}
@@ -0,0 +1,61 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "working_set_estimator.h"
+
+#include <limits>
+
+namespace badgerdb {
+
+const std::size_t WorkingSetEstimator::DEFAULT_MAX_SAMPLES;
+
+WorkingSetEstimator::WorkingSetEstimator(const std::size_t max_samples)
+    : max_samples_(max_samples > 0 ? max_samples : 1) {
+  clear();
+}
+
+void WorkingSetEstimator::recordSampled(const std::uint64_t hash) {
+  samples_[hash] = now_;
+  if (samples_.size() > max_samples_) {
+    std::map<std::uint64_t, std::uint64_t>::iterator largest = samples_.end();
+    --largest;
+    threshold_ = largest->first;
+    samples_.erase(largest);
+  }
+}
+
+double WorkingSetEstimator::estimate(const std::uint64_t window) const {
+  std::size_t recent = 0;
+  if (window >= now_) {
+    recent = samples_.size();
+  } else {
+    const std::uint64_t start = now_ - window;
+    for (std::map<std::uint64_t, std::uint64_t>::const_iterator it =
+             samples_.begin();
+         it != samples_.end(); ++it) {
+      if (it->second > start) {
+        ++recent;
+      }
+    }
+  }
+  return recent / sampleRate();
+}
+
+double WorkingSetEstimator::sampleRate() const {
+  if (threshold_ == std::numeric_limits<std::uint64_t>::max()) {
+    return 1.0;
+  }
+  return threshold_ / 18446744073709551616.0;
+}
+
+void WorkingSetEstimator::clear() {
+  threshold_ = std::numeric_limits<std::uint64_t>::max();
+  now_ = 0;
+  samples_.clear();
+}
+
+}
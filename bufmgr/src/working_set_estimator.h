@@ -0,0 +1,137 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Estimates the number of distinct pages referenced in a window of
+ * recent accesses, in bounded memory.
+ *
+ * Pages are sampled by a hash of their identity (as in SHARDS, Waldspurger et
+ * al., FAST '15): a page is tracked if its hash is below a threshold, so every
+ * reference to a sampled page is seen and the sample is an unbiased subset of
+ * the distinct pages.  Once more than the maximum number of pages are sampled,
+ * the page with the largest hash is dropped and the threshold lowered to it,
+ * so memory stays fixed while the sampling rate adapts to the footprint.
+ *
+ * The working set over a window of W accesses (Denning's W(t, W)) is then the
+ * number of sampled pages last referenced within the window divided by the
+ * sampling rate.  Working sets no larger than the maximum sample are exact.
+ *
+ * @warning This class is not threadsafe.
+ */
+class WorkingSetEstimator {
+ public:
+  /**
+   * Default maximum number of pages tracked.
+   */
+  static const std::size_t DEFAULT_MAX_SAMPLES = 4096;
+
+  /**
+   * Constructs an estimator that has seen no accesses.
+   *
+   * @param max_samples   Maximum number of pages tracked.
+   */
+  explicit WorkingSetEstimator(
+      const std::size_t max_samples = DEFAULT_MAX_SAMPLES);
+
+  /**
+   * Records one access.
+   *
+   * @param file          Identity of the file, e.g. the address of its File
+   *                      object.
+   * @param page_number   Number of the page accessed.
+   */
+  void record(const void* file, const PageId page_number) {
+    ++now_;
+    const std::uint64_t hash = hashPage(file, page_number);
+    if (hash < threshold_) {
+      recordSampled(hash);
+    }
+  }
+
+  /**
+   * Returns the estimated number of distinct pages referenced in the most
+   * recent accesses.
+   *
+   * @param window  Number of most recent accesses to consider; a window at
+   *                least as long as accesses() covers everything recorded.
+   * @return  Estimated number of distinct pages.
+   */
+  double estimate(const std::uint64_t window) const;
+
+  /**
+   * Returns the number of accesses recorded.
+   */
+  std::uint64_t accesses() const { return now_; }
+
+  /**
+   * Returns the fraction of pages currently sampled.
+   */
+  double sampleRate() const;
+
+  /**
+   * Returns the number of pages currently sampled.
+   */
+  std::size_t numSamples() const { return samples_.size(); }
+
+  /**
+   * Forgets all accesses and resets the sampling rate to 1.
+   */
+  void clear();
+
+ private:
+  /**
+   * Hashes a page identity to a uniformly distributed 64-bit value.
+   */
+  static std::uint64_t hashPage(const void* file, const PageId page_number) {
+    std::uint64_t x = reinterpret_cast<std::uintptr_t>(file) *
+        0x9E3779B97F4A7C15ULL ^ page_number;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  /**
+   * Updates the last access time of a sampled page and shrinks the sample if
+   * it has grown too large.
+   */
+  void recordSampled(const std::uint64_t hash);
+
+  /**
+   * Maximum number of pages tracked.
+   */
+  std::size_t max_samples_;
+
+  /**
+   * Pages with a hash below this are sampled.
+   */
+  std::uint64_t threshold_;
+
+  /**
+   * Number of accesses recorded; the time of the latest access.
+   */
+  std::uint64_t now_;
+
+  /**
+   * Time of the latest access to each sampled page, by page hash.
+   */
+  std::map<std::uint64_t, std::uint64_t> samples_;
+};
+
+}
@@ -0,0 +1,326 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#include "write_ahead_log.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#include "checksum.h"
+#include "posix_io.h"
+#include "exceptions/log_file_exception.h"
+
+namespace badgerdb {
+
+const char WriteAheadLog::MAGIC[8] = {'B', 'D', 'B', 'W', 'A', 'L', '0', '1'};
+const Lsn WriteAheadLog::HEADER_SIZE;
+
+namespace {
+
+/**
+ * Returns the size of an open file.
+ */
+std::uint64_t fileSize(const int fd) {
+  struct stat st;
+  return ::fstat(fd, &st) == 0 ? st.st_size : 0;
+}
+
+/**
+ * Offset in the log file header of the marked checkpoint's log offset.
+ */
+const std::uint64_t CHECKPOINT_OFFSET = sizeof(WriteAheadLog::MAGIC);
+
+/**
+ * Throws unless the file starts with a log file header.  Returns the offset
+ * of the marked checkpoint record.
+ */
+Lsn checkHeader(const int fd, const std::string& filename) {
+  char header[WriteAheadLog::HEADER_SIZE];
+  if (!readAt(fd, header, sizeof(header), 0) ||
+      std::memcmp(header, WriteAheadLog::MAGIC,
+                  sizeof(WriteAheadLog::MAGIC)) != 0) {
+    ::close(fd);
+    throw LogFileException(filename, "is not a write-ahead log");
+  }
+  Lsn checkpoint;
+  std::memcpy(&checkpoint, header + CHECKPOINT_OFFSET, sizeof(checkpoint));
+  return checkpoint;
+}
+
+/**
+ * Checksums a record header (with its checksum field zero) and payload.
+ */
+std::uint32_t recordChecksum(const LogRecordHeader& header,
+                             const char* payload) {
+  LogRecordHeader zeroed = header;
+  zeroed.checksum = 0;
+  return crc32c(payload, header.length,
+                crc32c(&zeroed, sizeof(zeroed)));
+}
+
+/**
+ * Reads the record at <position> of a log file of <size> bytes.  Returns
+ * false if there is no complete, valid record there.
+ */
+bool readRecord(const int fd, const std::uint64_t size, const Lsn position,
+                LogRecord& record) {
+  LogRecordHeader header;
+  if (position + sizeof(header) > size ||
+      !readAt(fd, &header, sizeof(header), position) ||
+      position + sizeof(header) + header.length > size) {
+    return false;
+  }
+  record.payload.resize(header.length);
+  if (!readAt(fd, &record.payload[0], header.length,
+              position + sizeof(header)) ||
+      recordChecksum(header, record.payload.data()) != header.checksum) {
+    return false;
+  }
+  record.type = header.type;
+  record.lsn = position + sizeof(header) + header.length;
+  return true;
+}
+
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& filename)
+    : filename_(filename),
+      fd_(::open(filename.c_str(), O_RDWR | O_CREAT, 0644)),
+      buffer_start_(HEADER_SIZE),
+      flushing_(false),
+      group_commit_delay_(0),
+      checkpoint_start_(0),
+      end_lsn_(HEADER_SIZE),
+      durable_lsn_(HEADER_SIZE),
+      num_records_(0),
+      num_syncs_(0),
+      num_flushes_(0) {
+  if (fd_ < 0) {
+    throw LogFileException(filename_, "cannot be opened");
+  }
+  const std::uint64_t size = fileSize(fd_);
+  if (size == 0) {
+    char header[HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    if (!writeAt(fd_, header, sizeof(header), 0) || ::fdatasync(fd_) != 0) {
+      ::close(fd_);
+      throw LogFileException(filename_, "cannot be created");
+    }
+    return;
+  }
+
+  checkpoint_start_ = checkHeader(fd_, filename_);
+  Lsn end = HEADER_SIZE;
+  LogRecord record;
+  while (readRecord(fd_, size, end, record)) {
+    end = record.lsn;
+  }
+  // Cut off a record torn by a crash so new records follow the last good one.
+  if (end < size && ::ftruncate(fd_, end) != 0) {
+    ::close(fd_);
+    throw LogFileException(filename_, "cannot be truncated");
+  }
+  buffer_start_ = end;
+  end_lsn_ = end;
+  durable_lsn_ = end;
+}
+
+WriteAheadLog::~WriteAheadLog() {
+  try {
+    flush();
+  } catch (LogFileException&) {
+  }
+  ::close(fd_);
+}
+
+Lsn WriteAheadLog::append(const LogRecordType type,
+                          const std::string& payload) {
+  LogRecordHeader header;
+  header.type = type;
+  header.length = static_cast<std::uint32_t>(payload.size());
+  header.reserved = 0;
+  header.checksum = recordChecksum(header, payload.data());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffer_.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  buffer_.append(payload);
+  ++num_records_;
+  const Lsn lsn = end_lsn_.load() + sizeof(header) + payload.size();
+  end_lsn_ = lsn;
+  return lsn;
+}
+
+Lsn WriteAheadLog::appendPageImage(const std::string& filename,
+                                   const PageId page_number,
+                                   const void* image, const std::size_t size) {
+  return appendPageRecord(LOG_PAGE_IMAGE, filename, page_number, image, size);
+}
+
+Lsn WriteAheadLog::appendPageRecord(const LogRecordType type,
+                                    const std::string& filename,
+                                    const PageId page_number,
+                                    const void* image, const std::size_t size) {
+  const std::uint32_t name_length = static_cast<std::uint32_t>(filename.size());
+  std::string payload;
+  payload.reserve(sizeof(page_number) + sizeof(name_length) + filename.size() +
+                  size);
+  payload.append(reinterpret_cast<const char*>(&page_number),
+                 sizeof(page_number));
+  payload.append(reinterpret_cast<const char*>(&name_length),
+                 sizeof(name_length));
+  payload.append(filename);
+  payload.append(static_cast<const char*>(image), size);
+  return append(type, payload);
+}
+
+Lsn WriteAheadLog::appendCheckpoint(const Lsn redo_lsn) {
+  return append(LOG_CHECKPOINT,
+                std::string(reinterpret_cast<const char*>(&redo_lsn),
+                            sizeof(redo_lsn)));
+}
+
+void WriteAheadLog::markCheckpoint(const Lsn lsn) {
+  flush(lsn);
+  const Lsn start = lsn - sizeof(LogRecordHeader) - sizeof(Lsn);
+  std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+  if (start <= checkpoint_start_) {
+    return;
+  }
+  if (!writeAt(fd_, &start, sizeof(start), CHECKPOINT_OFFSET)) {
+    throw LogFileException(filename_, "cannot be written");
+  }
+  if (::fdatasync(fd_) != 0) {
+    throw LogFileException(filename_, "cannot be synced");
+  }
+  checkpoint_start_ = start;
+}
+
+void WriteAheadLog::flush(const Lsn lsn) {
+  if (durable_lsn_.load() >= lsn) {
+    return;
+  }
+  std::unique_lock<std::mutex> flush_lock(flush_mutex_);
+  ++num_flushes_;
+  // Wait while another thread leads a sync; it may cover this flush too.  A
+  // covered flush returns even if the next leader has already started.
+  while (flushing_ && durable_lsn_.load() < lsn) {
+    flushed_.wait(flush_lock);
+  }
+  if (durable_lsn_.load() >= lsn) {
+    return;
+  }
+  flushing_ = true;
+  const std::chrono::microseconds delay = group_commit_delay_;
+  flush_lock.unlock();
+
+  if (delay.count() > 0) {
+    std::this_thread::sleep_for(delay);
+  }
+  std::string pending;
+  Lsn start;
+  Lsn target;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending.swap(buffer_);
+    start = buffer_start_;
+    target = end_lsn_.load();
+    buffer_start_ = target;
+  }
+  const bool written = writeAt(fd_, pending.data(), pending.size(), start);
+  const bool synced = written && ::fdatasync(fd_) == 0;
+  if (!synced) {
+    // Put the records back so a later flush can retry them.
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_.insert(0, pending);
+    buffer_start_ = start;
+  }
+
+  flush_lock.lock();
+  if (synced) {
+    ++num_syncs_;
+    durable_lsn_ = target;
+  }
+  flushing_ = false;
+  flushed_.notify_all();
+  if (!written) {
+    throw LogFileException(filename_, "cannot be written");
+  }
+  if (!synced) {
+    throw LogFileException(filename_, "cannot be synced");
+  }
+}
+
+void WriteAheadLog::setGroupCommitDelay(
+    const std::chrono::microseconds delay) {
+  std::lock_guard<std::mutex> lock(flush_mutex_);
+  group_commit_delay_ = delay;
+}
+
+std::chrono::microseconds WriteAheadLog::groupCommitDelay() const {
+  std::lock_guard<std::mutex> lock(flush_mutex_);
+  return group_commit_delay_;
+}
+
+bool WriteAheadLog::decodePageImage(const LogRecord& record,
+                                    PageImageRecord& page) {
+  std::uint32_t name_length;
+  const std::size_t fixed = sizeof(page.page_number) + sizeof(name_length);
+  if ((record.type != LOG_PAGE_IMAGE && record.type != LOG_FILE_PAGE &&
+       record.type != LOG_PAGE_LINK && record.type != LOG_FILE_HEADER) ||
+      record.payload.size() < fixed) {
+    return false;
+  }
+  std::memcpy(&page.page_number, record.payload.data(),
+              sizeof(page.page_number));
+  std::memcpy(&name_length, record.payload.data() + sizeof(page.page_number),
+              sizeof(name_length));
+  if (record.payload.size() - fixed < name_length) {
+    return false;
+  }
+  page.filename.assign(record.payload, fixed, name_length);
+  page.image.assign(record.payload, fixed + name_length, std::string::npos);
+  return true;
+}
+
+bool WriteAheadLog::decodeCheckpoint(const LogRecord& record, Lsn& redo_lsn) {
+  if (record.type != LOG_CHECKPOINT ||
+      record.payload.size() != sizeof(redo_lsn)) {
+    return false;
+  }
+  std::memcpy(&redo_lsn, record.payload.data(), sizeof(redo_lsn));
+  return true;
+}
+
+LogReader::LogReader(const std::string& filename, const Lsn start)
+    : filename_(filename),
+      fd_(::open(filename.c_str(), O_RDONLY)),
+      size_(0),
+      position_(start),
+      checkpoint_(0) {
+  if (fd_ < 0) {
+    throw LogFileException(filename_, "cannot be opened");
+  }
+  checkpoint_ = checkHeader(fd_, filename_);
+  size_ = fileSize(fd_);
+}
+
+LogReader::~LogReader() {
+  ::close(fd_);
+}
+
+bool LogReader::next(LogRecord& record) {
+  if (!readRecord(fd_, size_, position_, record)) {
+    return false;
+  }
+  position_ = record.lsn;
+  return true;
+}
+
+}
@@ -0,0 +1,482 @@
+/**
+ * @author See Contributors.txt for code contributors and overview of BadgerDB.
+ *
+ * @section LICENSE
+ * Copyright (c) 2012 Database Group, Computer Sciences Department, University of Wisconsin-Madison.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "types.h"
+
+namespace badgerdb {
+
+/**
+ * @brief Kind of change a write-ahead log record describes.
+ */
+enum LogRecordType {
+  /**
+   * The full contents of a page after a change: file name, page number and
+   * the page as File writes it.  Redoing the record writes the image back.
+   */
+  LOG_PAGE_IMAGE = 1,
+
+  /**
+   * End of a fuzzy checkpoint: the LSN redo has to start from.  Every change
+   * logged before it is on disk, apart from pages still dirty when the
+   * checkpoint ended, whose first change is logged at or after it.
+   */
+  LOG_CHECKPOINT = 2,
+
+  /**
+   * A page as File writes it when allocating or deleting a page, including
+   * its next page number.  Redoing the record writes the image back as is.
+   */
+  LOG_FILE_PAGE = 3,
+
+  /**
+   * A change to the next page number of a page, made by File when it links a
+   * page into or out of the used list.  Redoing the record sets the number
+   * and keeps the rest of the page as it is on disk.
+   */
+  LOG_PAGE_LINK = 4,
+
+  /**
+   * A file header as File writes it.  Redoing the record writes it back.
+   */
+  LOG_FILE_HEADER = 5
+};
+
+/**
+ * @brief Header in front of every record in a write-ahead log.
+ */
+struct LogRecordHeader {
+  /**
+   * CRC32C of the rest of the header (with this field set to zero) followed
+   * by the payload.  A record whose checksum does not match ends the log.
+   */
+  std::uint32_t checksum;
+
+  /**
+   * Record type; a LogRecordType value.
+   */
+  std::uint32_t type;
+
+  /**
+   * Number of payload bytes following the header.
+   */
+  std::uint32_t length;
+
+  /**
+   * Reserved; zero.
+   */
+  std::uint32_t reserved;
+};
+
+static_assert(sizeof(LogRecordHeader) == 16,
+              "Log record header layout must match the log file format.");
+
+/**
+ * @brief One record read back from a write-ahead log.
+ */
+struct LogRecord {
+  /**
+   * LSN of the record: the log offset just past its end.
+   */
+  Lsn lsn;
+
+  /**
+   * Record type; a LogRecordType value.
+   */
+  std::uint32_t type;
+
+  /**
+   * Record payload.
+   */
+  std::string payload;
+};
+
+/**
+ * @brief Contents of a record about one page or file header: LOG_PAGE_IMAGE,
+ * LOG_FILE_PAGE, LOG_PAGE_LINK or LOG_FILE_HEADER.
+ */
+struct PageImageRecord {
+  /**
+   * Name of the file the page belongs to.
+   */
+  std::string filename;
+
+  /**
+   * Number of the page in the file; 0 for LOG_FILE_HEADER.
+   */
+  PageId page_number;
+
+  /**
+   * Page header followed by page data, as the page was when it was logged;
+   * for LOG_PAGE_LINK the new next page number and for LOG_FILE_HEADER the
+   * file header.
+   */
+  std::string image;
+};
+
+/**
+ * @brief Append-only log of changes, made durable ahead of the pages they
+ * change.
+ *
+ * Records are appended to an in-memory buffer and become durable when flush()
+ * writes the buffer to the log file and syncs it with fdatasync.  The LSN
+ * returned by append() is the log offset just past the record, so a record is
+ * durable once durableLsn() has reached its LSN.  The buffer manager uses
+ * this to hold back a dirty page until the log record of its latest change is
+ * durable; a committing caller only has to flush the log, not the pages.
+ *
+ * Flushes are committed in groups.  One flushing thread, the leader, writes
+ * and syncs everything appended so far while threads that ask for a flush in
+ * the meantime wait; the next leader then covers all of them with one sync.
+ * The leader can also wait a short, configurable delay before writing so that
+ * more records join its sync.  With many threads committing at once, the
+ * number of syncs per second stays near the device's sync rate while commits
+ * per second grow with the number of threads.
+ *
+ * The log file starts with a header holding a magic string and the log offset
+ * of the last checkpoint record marked with markCheckpoint(), so recovery can
+ * start reading there instead of at the beginning of the log.
+ *
+ * A crash can leave a partly written record at the end of the log.  Opening
+ * the log finds the last record with a valid checksum and cuts the file off
+ * after it, so appends continue from a clean end.
+ *
+ * All methods are threadsafe.
+ */
+class WriteAheadLog {
+ public:
+  /**
+   * Magic string at the start of every log file.
+   */
+  static const char MAGIC[8];
+
+  /**
+   * Size of the log file header; the log offset of the first record.
+   */
+  static const Lsn HEADER_SIZE = 16;
+
+  /**
+   * Opens a log file, creating it if it does not exist.  A partly written
+   * record at the end of an existing log is removed.
+   *
+   * @param filename  Name of the log file.
+   * @throws  LogFileException  If the file cannot be opened or created or is
+   *                            not a write-ahead log.
+   */
+  explicit WriteAheadLog(const std::string& filename);
+
+  /**
+   * Flushes the log and closes the log file.
+   */
+  ~WriteAheadLog();
+
+  /**
+   * Appends a record.  The record is durable only after a flush() covering
+   * its LSN.
+   *
+   * @param type    Record type.
+   * @param payload Record payload.
+   * @return  LSN of the record.
+   */
+  Lsn append(const LogRecordType type, const std::string& payload);
+
+  /**
+   * Appends a LOG_PAGE_IMAGE record.
+   *
+   * @param filename    Name of the file the page belongs to.
+   * @param page_number Number of the page in the file.
+   * @param image       Page header followed by page data.
+   * @param size        Number of bytes in the image.
+   * @return  LSN of the record.
+   */
+  Lsn appendPageImage(const std::string& filename, const PageId page_number,
+                      const void* image, const std::size_t size);
+
+  /**
+   * Appends a record about one page or file header.
+   *
+   * @param type        LOG_PAGE_IMAGE, LOG_FILE_PAGE, LOG_PAGE_LINK or
+   *                    LOG_FILE_HEADER.
+   * @param filename    Name of the file the page belongs to.
+   * @param page_number Number of the page in the file; 0 for a file header.
+   * @param image       Contents, as described for PageImageRecord::image.
+   * @param size        Number of bytes in the image.
+   * @return  LSN of the record.
+   */
+  Lsn appendPageRecord(const LogRecordType type, const std::string& filename,
+                       const PageId page_number, const void* image,
+                       const std::size_t size);
+
+  /**
+   * Appends a LOG_CHECKPOINT record.
+   *
+   * @param redo_lsn  Log offset redo has to start from.
+   * @return  LSN of the record.
+   */
+  Lsn appendCheckpoint(const Lsn redo_lsn);
+
+  /**
+   * Flushes the log up to a LOG_CHECKPOINT record and records its offset in
+   * the log file header.  A checkpoint older than the one already marked is
+   * only flushed.
+   *
+   * @param lsn   LSN of the checkpoint record.
+   * @throws  LogFileException  If the log cannot be written or synced.
+   */
+  void markCheckpoint(const Lsn lsn);
+
+  /**
+   * Makes every record up to and including the one with the given LSN
+   * durable.  Returns at once if they already are.
+   *
+   * @param lsn   LSN of the last record that must be durable.
+   * @throws  LogFileException  If the log cannot be written or synced.
+   */
+  void flush(const Lsn lsn);
+
+  /**
+   * Makes every record appended so far durable.
+   *
+   * @throws  LogFileException  If the log cannot be written or synced.
+   */
+  void flush() { flush(endLsn()); }
+
+  /**
+   * Sets how long a flush waits before writing the log, so that records
+   * appended meanwhile are synced along with it.  0, the default, writes at
+   * once; flushes requested while a write is in progress are still grouped.
+   *
+   * @param delay   Longest time a flush waits for others to join.
+   */
+  void setGroupCommitDelay(const std::chrono::microseconds delay);
+
+  /**
+   * Returns the group commit delay.
+   */
+  std::chrono::microseconds groupCommitDelay() const;
+
+  /**
+   * Returns the LSN of the last record appended, or HEADER_SIZE if the log is
+   * empty.
+   */
+  Lsn endLsn() const { return end_lsn_.load(); }
+
+  /**
+   * Returns the LSN up to which the log is durable.
+   */
+  Lsn durableLsn() const { return durable_lsn_.load(); }
+
+  /**
+   * Returns the number of records appended since the log was opened.
+   */
+  std::uint64_t numRecords() const { return num_records_.load(); }
+
+  /**
+   * Returns the number of times the log file was synced since the log was
+   * opened.
+   */
+  std::uint64_t numSyncs() const { return num_syncs_.load(); }
+
+  /**
+   * Returns the number of flush() calls that found their records not yet
+   * durable and waited for a sync.  Divided by numSyncs(), this is the
+   * average size of a commit group.
+   */
+  std::uint64_t numFlushes() const { return num_flushes_.load(); }
+
+  /**
+   * Returns the name of the log file.
+   */
+  const std::string& filename() const { return filename_; }
+
+  /**
+   * Decodes the payload of a LOG_PAGE_IMAGE, LOG_FILE_PAGE, LOG_PAGE_LINK or
+   * LOG_FILE_HEADER record.
+   *
+   * @param record  Record to decode.
+   * @param page    Receives the file name, page number and image.
+   * @return  False if the record is not a well-formed record of these types.
+   */
+  static bool decodePageImage(const LogRecord& record, PageImageRecord& page);
+
+  /**
+   * Decodes the payload of a LOG_CHECKPOINT record.
+   *
+   * @param record    Record to decode.
+   * @param redo_lsn  Receives the log offset redo has to start from.
+   * @return  False if the record is not a well-formed checkpoint.
+   */
+  static bool decodeCheckpoint(const LogRecord& record, Lsn& redo_lsn);
+
+ private:
+  WriteAheadLog(const WriteAheadLog&);
+  WriteAheadLog& operator=(const WriteAheadLog&);
+
+  /**
+   * Name of the log file.
+   */
+  std::string filename_;
+
+  /**
+   * Descriptor of the log file.
+   */
+  int fd_;
+
+  /**
+   * Protects buffer_, buffer_start_ and end_lsn_ updates.  Not held while the
+   * log file is written, so appends carry on during a sync.
+   */
+  std::mutex mutex_;
+
+  /**
+   * Records appended but not yet handed to a flush.
+   */
+  std::string buffer_;
+
+  /**
+   * Log offset of the first byte of buffer_.
+   */
+  Lsn buffer_start_;
+
+  /**
+   * Protects flushing_ and group_commit_delay_; waiting flushes sleep on
+   * flushed_ until the leader's sync completes.
+   */
+  mutable std::mutex flush_mutex_;
+  std::condition_variable flushed_;
+
+  /**
+   * True while a leader is writing and syncing the log.
+   */
+  bool flushing_;
+
+  /**
+   * How long a leader waits before writing.
+   */
+  std::chrono::microseconds group_commit_delay_;
+
+  /**
+   * Serializes markCheckpoint() calls.
+   */
+  std::mutex checkpoint_mutex_;
+
+  /**
+   * Log offset of the checkpoint record marked in the log file header, or 0.
+   */
+  Lsn checkpoint_start_;
+
+  /**
+   * LSN of the last record appended.
+   */
+  std::atomic<Lsn> end_lsn_;
+
+  /**
+   * LSN up to which the log file is written and synced.
+   */
+  std::atomic<Lsn> durable_lsn_;
+
+  /**
+   * Number of records appended.
+   */
+  std::atomic<std::uint64_t> num_records_;
+
+  /**
+   * Number of syncs of the log file.
+   */
+  std::atomic<std::uint64_t> num_syncs_;
+
+  /**
+   * Number of flushes that waited for a sync.
+   */
+  std::atomic<std::uint64_t> num_flushes_;
+};
+
+/**
+ * @brief Reads the records of a write-ahead log in order.
+ *
+ * Reading stops at the end of the log file or at the first record that is
+ * truncated or fails its checksum, which is where a crash cut the log off.
+ */
+class LogReader {
+ public:
+  /**
+   * Opens a log file for reading.
+   *
+   * @param filename  Name of the log file.
+   * @param start     Log offset of the first record to read; the LSN of the
+   *                  record before it, or WriteAheadLog::HEADER_SIZE.
+   * @throws  LogFileException  If the file cannot be opened or is not a
+   *                            write-ahead log.
+   */
+  explicit LogReader(const std::string& filename,
+                     const Lsn start = WriteAheadLog::HEADER_SIZE);
+
+  /**
+   * Closes the log file.
+   */
+  ~LogReader();
+
+  /**
+   * Reads the next record.
+   *
+   * @param record  Receives the record.
+   * @return  False at the end of the log.
+   */
+  bool next(LogRecord& record);
+
+  /**
+   * Returns the log offset just past the last record read: the LSN of that
+   * record, or the start offset if none was read.
+   */
+  Lsn position() const { return position_; }
+
+  /**
+   * Returns the log offset of the checkpoint record marked in the log file
+   * header, or 0 if no checkpoint was marked.
+   */
+  Lsn checkpoint() const { return checkpoint_; }
+
+ private:
+  LogReader(const LogReader&);
+  LogReader& operator=(const LogReader&);
+
+  /**
+   * Name of the log file.
+   */
+  std::string filename_;
+
+  /**
+   * Descriptor of the log file.
+   */
+  int fd_;
+
+  /**
+   * Size of the log file when it was opened.
+   */
+  std::uint64_t size_;
+
+  /**
+   * Log offset of the next record.
+   */
+  Lsn position_;
+
+  /**
+   * Offset of the marked checkpoint record.
+   */
+  Lsn checkpoint_;
+};
+
+}